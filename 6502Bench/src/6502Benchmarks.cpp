@@ -0,0 +1,158 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+#include "m6502.h"
+#include "m6502_harness.h"
+#include "m6502_loader.h"
+
+using namespace m6502;
+
+namespace
+{
+    /* A group of instructions that is repeated to fill the loop */
+    struct Workload {
+        std::vector<Byte> Group;
+    };
+
+    constexpr Word LOOP_START = 0x1000;
+    constexpr u32 GROUPS_PER_LOOP = 32;
+
+    /*
+    * = $1000
+        <Group> x GROUPS_PER_LOOP
+        jmp $1000
+    * = $3000
+        rts             ; for jsr $3000
+
+    With A = 1, X = 2, Y = 2 and the flags clear. The zero page pointers
+    ($82) and ($84) point at $2000 for the (zp,x) and (zp),y modes */
+    void Prepare( const Workload& Load, CPU& cpu, Mem& memory )
+    {
+        cpu.Reset( LOOP_START, memory );
+        cpu.A = 1;
+        cpu.X = 2;
+        cpu.Y = 2;
+
+        Word At = LOOP_START;
+        for ( u32 i = 0; i < GROUPS_PER_LOOP; i++ )
+        {
+            memory.Load( Load.Group.data(), (u32)Load.Group.size(), At );
+            At += (Word)Load.Group.size();
+        }
+        const Byte Jump[] = { CPU::INS_JMP_ABS, LOOP_START & 0xFF, LOOP_START >> 8 };
+        memory.Load( Jump, sizeof(Jump), At );
+
+        memory[0x3000] = CPU::INS_RTS;
+        memory[0x82] = 0x00;
+        memory[0x83] = 0x20;
+        memory[0x84] = 0x00;
+        memory[0x85] = 0x20;
+    }
+
+    /* Benchmark CPU::Execute on the loop, reporting emulated instructions
+    *  and cycles per second */
+    void RunWorkload( benchmark::State& State, Workload Load )
+    {
+        std::unique_ptr<Mem> memory = std::make_unique<Mem>();
+        CPU cpu;
+        Prepare( Load, cpu, *memory );
+
+        // One pass an instruction at a time to count what the loop costs
+        s32 LoopCycles = 0;
+        u32 LoopInstructions = 0;
+        do
+        {
+            LoopCycles += cpu.Execute( 1, *memory );
+            LoopInstructions++;
+        } while ( cpu.PC != LOOP_START );
+
+        const s32 Slice = LoopCycles * 64;
+        long long Cycles = 0;
+        for ( auto _ : State )
+        {
+            Cycles += cpu.Execute( Slice, *memory );
+        }
+
+        const double Instructions = (double)Cycles / LoopCycles * LoopInstructions;
+        State.counters["Instructions/s"] = benchmark::Counter( Instructions, benchmark::Counter::kIsRate );
+        State.counters["Cycles/s"] = benchmark::Counter( (double)Cycles, benchmark::Counter::kIsRate );
+    }
+}
+
+// Opcode families
+BENCHMARK_CAPTURE( RunWorkload, Loads, Workload{ {
+    CPU::INS_LDA_IM, 0x01, CPU::INS_LDX_IM, 0x02, CPU::INS_LDY_IM, 0x02 } } );
+BENCHMARK_CAPTURE( RunWorkload, Stores, Workload{ {
+    CPU::INS_STA_ZP, 0x40, CPU::INS_STX_ZP, 0x41, CPU::INS_STY_ZP, 0x42 } } );
+BENCHMARK_CAPTURE( RunWorkload, AdcSbc, Workload{ {
+    CPU::INS_CLC, CPU::INS_ADC_IM, 0x01, CPU::INS_SEC, CPU::INS_SBC_IM, 0x01 } } );
+BENCHMARK_CAPTURE( RunWorkload, Shifts, Workload{ {
+    CPU::INS_ASL, CPU::INS_LSR, CPU::INS_ROL_ZP, 0x40, CPU::INS_ROR_ZP, 0x40 } } );
+BENCHMARK_CAPTURE( RunWorkload, BranchTaken, Workload{ {
+    CPU::INS_BNE, 0x00 } } );
+BENCHMARK_CAPTURE( RunWorkload, BranchNotTaken, Workload{ {
+    CPU::INS_BEQ, 0x00 } } );
+BENCHMARK_CAPTURE( RunWorkload, JsrRts, Workload{ {
+    CPU::INS_JSR, 0x00, 0x30 } } );
+BENCHMARK_CAPTURE( RunWorkload, Stack, Workload{ {
+    CPU::INS_PHA, CPU::INS_PLA, CPU::INS_PHP, CPU::INS_PLP } } );
+
+// Addressing modes, named after the CPU::Address* function each one runs
+BENCHMARK_CAPTURE( RunWorkload, AddressZeroPage, Workload{ {
+    CPU::INS_LDA_ZP, 0x40 } } );
+BENCHMARK_CAPTURE( RunWorkload, AddressZeroPageX, Workload{ {
+    CPU::INS_LDA_ZPX, 0x40 } } );
+BENCHMARK_CAPTURE( RunWorkload, AddressZeroPageY, Workload{ {
+    CPU::INS_LDX_ZPY, 0x40 } } );
+BENCHMARK_CAPTURE( RunWorkload, AddressAbsolute, Workload{ {
+    CPU::INS_LDA_ABS, 0x00, 0x20 } } );
+BENCHMARK_CAPTURE( RunWorkload, AddressAbsoluteX, Workload{ {
+    CPU::INS_LDA_ABSX, 0x00, 0x20 } } );
+BENCHMARK_CAPTURE( RunWorkload, AddressAbsoluteX_PageCross, Workload{ {
+    CPU::INS_LDA_ABSX, 0xFF, 0x20 } } );
+BENCHMARK_CAPTURE( RunWorkload, AddressAbsoluteX_5, Workload{ {
+    CPU::INS_STA_ABSX, 0x00, 0x20 } } );
+BENCHMARK_CAPTURE( RunWorkload, AddressAbsoluteY, Workload{ {
+    CPU::INS_LDA_ABSY, 0x00, 0x20 } } );
+BENCHMARK_CAPTURE( RunWorkload, AddressAbsoluteY_5, Workload{ {
+    CPU::INS_STA_ABSY, 0x00, 0x20 } } );
+BENCHMARK_CAPTURE( RunWorkload, AddressIndirectX, Workload{ {
+    CPU::INS_LDA_INDX, 0x80 } } );
+BENCHMARK_CAPTURE( RunWorkload, AddressIndirectY, Workload{ {
+    CPU::INS_LDA_INDY, 0x84 } } );
+BENCHMARK_CAPTURE( RunWorkload, AddressIndirectY_5, Workload{ {
+    CPU::INS_STA_INDY, 0x84 } } );
+
+/* The whole CPU: Klaus Dormann's functional test from the start to its
+*  success trap, each iteration on a fresh copy of the image */
+static void FunctionalTest( benchmark::State& State )
+{
+    MappedFile TestBin( M6502_FUNCTIONAL_TEST_DIR "6502_functional_test.bin" );
+    const Word SuccessAddress = TrapHarness::FindSuccessAddress( M6502_FUNCTIONAL_TEST_DIR "6502_functional_test.lst" );
+    if ( !TestBin.IsOpen() || !SuccessAddress )
+    {
+        State.SkipWithError( "6502_functional_test.bin / .lst not found" );
+        return;
+    }
+
+    std::unique_ptr<Mem> memory = std::make_unique<Mem>();
+    CPU cpu;
+    unsigned long long Cycles = 0;
+    for ( auto _ : State )
+    {
+        State.PauseTiming();
+        cpu.Reset( 0x400, *memory );
+        TestBin.LoadBin( 0x000A, *memory );
+        State.ResumeTiming();
+
+        const TrapHarness::Result Run = TrapHarness::Run( cpu, *memory, SuccessAddress, 200000000ull );
+        if ( Run.Status != TrapHarness::Outcome::Passed )
+        {
+            State.SkipWithError( "the functional test failed" );
+            return;
+        }
+        Cycles += Run.Cycles;
+    }
+    State.counters["Cycles/s"] = benchmark::Counter( (double)Cycles, benchmark::Counter::kIsRate );
+}
+BENCHMARK( FunctionalTest )->Unit( benchmark::kMillisecond );
@@ -1,1118 +1,351 @@
 #include "m6502.h"
 
-#define ASSERT( Condition, Text ) { if ( !Condition ) { throw -1;}}
+#include "m6502_breakpoints.h"
+#include "m6502_instructions.h"
 
-m6502::s32 m6502::CPU::Execute(s32 Cycles, Mem &memory)
-{
+#if defined( M6502_JIT )
+#include "m6502_jit.h"
+#endif
 
-    /* Load a Register with the value from the memory address */
-    auto LoadRegister = 
-        [&Cycles, &memory, this]  
-        ( Word Address, Byte& Register ) 
-    {
-        Register = ReadByte( Cycles, Address, memory );
-        SetZeroAndNegativeFlags( Register );
-    };
+#if defined( M6502_TRACE )
+#include <exception>
+#include "m6502_trace.h"
+#endif
 
-    /* And the A Register with the value from the memory address */
-    auto And = 
-        [&Cycles, &memory, this]  
-        ( Word Address ) 
-    {
-        A &= ReadByte( Cycles, Address, memory );
-        SetZeroAndNegativeFlags( A );
-    };
-
-    /* Or the A Register with the value from the memory address */
-    auto Ora = 
-        [&Cycles, &memory, this]  
-        ( Word Address ) 
-    {
-        A |= ReadByte( Cycles, Address, memory );
-        SetZeroAndNegativeFlags( A );
-    };
+m6502::s32 m6502::CPU::Execute(s32 Cycles, Mem &memory)
+{
+#if defined( M6502_JIT )
+    thread_local Jit Engine( M6502_JIT_HOT_THRESHOLD, M6502_JIT_CODE_BUFFER_SIZE );
+    return Engine.Execute( Cycles, *this, memory );
+#else
+    return Interpret( Cycles, memory );
+#endif
+}
 
-    /* Eor the A Register with the value from the memory address */
-    auto Eor = 
-        [&Cycles, &memory, this]  
-        ( Word Address ) 
-    {
-        A ^= ReadByte( Cycles, Address, memory );
-        SetZeroAndNegativeFlags( A );
-    };
+m6502::s32 m6502::CPU::Interpret(s32 Cycles, Mem &memory)
+{
+    const s32 CyclesRequested = Cycles;
+    Halted = HaltReason::None;
+
+    // Lazy N/Z flags only live inside Execute, PS is up to date whenever
+    // we leave (including by exception)
+    struct MaterialiseOnExit {
+        CPU& cpu;
+        ~MaterialiseOnExit() { cpu.MaterialiseFlags(); }
+    } FlagsGuard{ *this };
+    DeferFlags();
+
+#if defined( M6502_TRACE )
+    // Records are stamped with the ring's cycle count, brought up to date
+    // (and dumped from if an exception is leaving) on the way out
+    struct TraceOnExit {
+        CPU& cpu;
+        const s32& Cycles;
+        const s32 CyclesRequested;
+        const int Exceptions;
+        ~TraceOnExit() {
+            if ( cpu.Trace )
+            {
+                cpu.Trace->AddCycles( CyclesRequested - Cycles );
+                if ( std::uncaught_exceptions() > Exceptions )
+                {
+                    cpu.Trace->DumpAfter( "exception" );
+                }
+            }
+        }
+    } TraceGuard{ *this, Cycles, CyclesRequested, std::uncaught_exceptions() };
+    const unsigned long long TraceBase = Trace ? Trace->Cycles() : 0;
+
+    // Traced where the opcode is dispatched from rather than in every
+    // handler, the copies in each case stopped GCC inlining the handlers
+    #define M6502_TRACE_INSTRUCTION( Opcode ) \
+        if ( Trace ) \
+        { \
+            Trace->Push( PC - 1, Opcode, A, X, Y, SP, CurrentPS(), TraceBase + (CyclesRequested - Cycles) ); \
+        }
+#else
+    #define M6502_TRACE_INSTRUCTION( Opcode )
+#endif
+
+    // Breakpoints cost one compare per instruction while PC stays on a
+    // page without any, StopAtBreakpoint looks at the rest
+    u32 SafePage = Mem::NUM_PAGES;
+    #define M6502_AT_BREAKPOINT() \
+        ( M6502_UNLIKELY( (u32)(PC >> 8) != SafePage ) && StopAtBreakpoint( SafePage ) )
+
+    #define M6502_EXECUTE( Opcode ) \
+        Cycles -= Instructions::Dispatch[Opcode].BaseCycles; \
+        Cycles -= Instructions::Dispatch[Opcode].Execute( *this, memory );
+    #define M6502_HAS_FOLLOWER( Opcode ) ( Instructions::Followers[Opcode] != Instructions::NO_FOLLOWER )
+    #define M6502_FOLLOWER( Opcode ) ( Instructions::Followers[Opcode] & 0xFF )
+
+    // GCC otherwise takes the follower for the unlikely way and stops
+    // inlining its handler
+#if defined( __GNUC__ )
+    #define M6502_UNLIKELY( Condition ) __builtin_expect( !!(Condition), 0 )
+#else
+    #define M6502_UNLIKELY( Condition ) (Condition)
+#endif
+
+#if defined( M6502_THREADED_DISPATCH )
+    // Threaded dispatch: every handler ends with its own indirect jump to the
+    // next opcode's label, so each opcode gets its own branch history.
+    // An opcode with a follower (superinstruction) checks for it first and
+    // runs it in place
+    #define M6502_LABEL_ADDRESS( Opcode ) &&Op_##Opcode,
+#if defined( M6502_TRACE )
+    // A traced opcode goes through the one TraceIns block on its way
+    #define M6502_DISPATCH_INS() \
+        if ( Trace ) goto TraceIns; \
+        goto *Labels[Ins];
+#else
+    #define M6502_DISPATCH_INS() \
+        goto *Labels[Ins];
+#endif
+    #define M6502_DISPATCH_NEXT() \
+        if ( Cycles <= 0 ) goto Done; \
+        if ( PendingEvents && !ServicePendingEvents( Cycles, memory ) ) goto Done; \
+        if ( M6502_AT_BREAKPOINT() ) goto Done; \
+        Ins = FetchByte( memory ); \
+        M6502_DISPATCH_INS()
+    #define M6502_DISPATCH_LABEL( Opcode ) \
+        Op_##Opcode: \
+            M6502_EXECUTE( Opcode ) \
+            if ( M6502_HAS_FOLLOWER( Opcode ) ) \
+            { \
+                if ( Cycles <= 0 ) goto Done; \
+                if ( PendingEvents && !ServicePendingEvents( Cycles, memory ) ) goto Done; \
+                if ( M6502_AT_BREAKPOINT() ) goto Done; \
+                Ins = FetchByte( memory ); \
+                if ( M6502_UNLIKELY( Ins != M6502_FOLLOWER( Opcode ) ) ) \
+                { \
+                    M6502_DISPATCH_INS() \
+                } \
+                M6502_TRACE_INSTRUCTION( M6502_FOLLOWER( Opcode ) ) \
+                M6502_EXECUTE( M6502_FOLLOWER( Opcode ) ) \
+            } \
+            M6502_DISPATCH_NEXT()
+
+    static void* const Labels[256] = { M6502_FOR_EACH_OPCODE( M6502_LABEL_ADDRESS ) };
+
+    Byte Ins;
+    M6502_DISPATCH_NEXT()
+    M6502_FOR_EACH_OPCODE( M6502_DISPATCH_LABEL )
+#if defined( M6502_TRACE )
+TraceIns:
+    M6502_TRACE_INSTRUCTION( Ins )
+    goto *Labels[Ins];
+#endif
+Done:
+
+    #undef M6502_LABEL_ADDRESS
+    #undef M6502_DISPATCH_INS
+    #undef M6502_DISPATCH_NEXT
+    #undef M6502_DISPATCH_LABEL
+#else
+    // Each case indexes the DispatchTable with a constant so the handler is
+    // inlined, calling through the table pointer measured ~30% slower.
+    // An opcode with a follower (superinstruction) fetches the next opcode
+    // itself and runs it in place if it is the follower, anything else goes
+    // back to the switch
+    #define M6502_DISPATCH_CASE( Opcode ) \
+        case Opcode: \
+            M6502_EXECUTE( Opcode ) \
+            if ( M6502_HAS_FOLLOWER( Opcode ) ) \
+            { \
+                if ( Cycles <= 0 || PendingEvents || (u32)(PC >> 8) != SafePage ) break; \
+                Ins = FetchByte( memory ); \
+                if ( M6502_UNLIKELY( Ins != M6502_FOLLOWER( Opcode ) ) ) goto Dispatch; \
+                M6502_TRACE_INSTRUCTION( M6502_FOLLOWER( Opcode ) ) \
+                M6502_EXECUTE( M6502_FOLLOWER( Opcode ) ) \
+            } \
+            break;
 
-    /* Conditional Branch */
-    auto BranchIf = [&Cycles, &memory, this] ( bool Test, bool Expected )
-    {
-        SByte Offset = FetchSByte( Cycles, memory );
-        if ( Test == Expected ) 
+    while (Cycles > 0) {
+        if ( PendingEvents && !ServicePendingEvents( Cycles, memory ) )
         {
-            const Word PCOld = PC;
-            PC += Offset;
-            Cycles--;
-
-            const bool PageChanged = ( PC >> 8) != (PCOld >> 8);
-            if ( PageChanged )
-            {
-                Cycles --;
-            }
+            break;
         }
-    };
+        if ( M6502_AT_BREAKPOINT() )
+        {
+            break;
+        }
+        Byte Ins = FetchByte( memory );
+    Dispatch:
+        M6502_TRACE_INSTRUCTION( Ins )
+        switch ( Ins ) {
+            M6502_FOR_EACH_OPCODE( M6502_DISPATCH_CASE )
+        }
+    }
+    #undef M6502_DISPATCH_CASE
+#endif
+    #undef M6502_EXECUTE
+    #undef M6502_TRACE_INSTRUCTION
+    #undef M6502_HAS_FOLLOWER
+    #undef M6502_FOLLOWER
+    #undef M6502_UNLIKELY
+    #undef M6502_AT_BREAKPOINT
 
-    /* Do add with carry given the operand */
-    auto ADC = [&Cycles, &memory, this] ( Byte Operand )
-    {
-        ASSERT( Flag.D == false, "havent handled decimal mode!" );
-        const bool AreSignBitsTheSame = !((A ^ Operand) & NegativeFlagBit);
-        Word Sum = A;
-        Sum += Operand;
-        Sum += Flag.C;
-        A = (Sum & 0xFF); 
-        SetZeroAndNegativeFlags( A );
-        Flag.C = Sum > 0xFF;
-        Flag.V = AreSignBitsTheSame && ((A ^ Operand) & NegativeFlagBit);
-    };
+    const s32 NumCyclesUsed = CyclesRequested - Cycles;
+    return NumCyclesUsed;
+}
 
-    /* Do subtract with carry given the operand */
-    auto SBC = [&ADC] ( Byte Operand )
+bool m6502::CPU::ServicePendingEvents( s32& Cycles, Mem& memory )
+{
+    if ( PendingEvents & PendingTrap )
     {
-        ADC( ~Operand );
-    };
-
-    /* Sets the processor status for a CMP/CPX/CPY instruction */
-    auto RegisterCompare = [&Cycles, &memory, this] ( Byte Operand, Byte RegisterValue )
+        PendingEvents &= ~PendingTrap;
+        Halted = HaltReason::Trap;
+#if defined( M6502_TRACE )
+        if ( Trace )
+        {
+            Trace->DumpAfter( "trap" );
+        }
+#endif
+        return false;
+    }
+    if ( PendingEvents & PendingStop )
     {
-        Byte Temp = RegisterValue - Operand;
-        Flag.N = (Temp & NegativeFlagBit) > 0;
-        Flag.Z = RegisterValue == Operand;
-        Flag.C = RegisterValue >= Operand;
-    };
+        PendingEvents &= ~PendingStop;
+        return false;
+    }
+    Cycles -= ServiceInterrupts( memory );
+    return Cycles > 0;
+}
 
-    /* Arithmetic Shift Left */
-    auto ASL = [&Cycles, &memory, this] ( Byte Operand ) -> Byte
+bool m6502::CPU::StopAtBreakpoint( u32& SafePage )
+{
+    const u32 Passed = BreakpointPassed;
+    BreakpointPassed = NO_BREAKPOINT;
+    if ( !Breaks || !Breaks->IsPageArmed( PC >> 8 ) )
     {
-        Flag.C = ( Operand & NegativeFlagBit ) > 0;
-        Byte Result = Operand << 1;
-        SetZeroAndNegativeFlags( Result );
-        Cycles--;
-        return Result;
-    };
+        SafePage = PC >> 8;
+        return false;
+    }
 
-    /* Logical Shift Right */
-    auto LSR = [&Cycles, &memory, this] ( Byte Operand ) -> Byte 
-    {
-        Flag.C = ( Operand & ZeroBit ) > 0;
-        Byte Result = Operand >> 1;
-        SetZeroAndNegativeFlags( Result );
-        Cycles--;
-        return Result;
-    };
-    
-    /* Rotate Left */
-    auto ROL = [&Cycles, &memory, this] ( Byte Operand ) -> Byte
+    // Every instruction on an armed page comes back here
+    SafePage = Mem::NUM_PAGES;
+    if ( !Breaks->IsSet( PC ) || PC == Passed )
     {
-        Byte NewBit0 = Flag.C ? ZeroBit : 0;
-        Flag.C = ( Operand & NegativeFlagBit ) > 0;
-        Operand = Operand << 1;
-        Operand |= NewBit0;
-        SetZeroAndNegativeFlags( Operand );
-        Cycles--;
-        return Operand;
-    };
+        return false;
+    }
+    Halted = HaltReason::Breakpoint;
+    BreakpointPassed = PC;
+    return true;
+}
 
-    /* Rotate Right*/
-    auto ROR = [&Cycles, &memory, this] ( Byte Operand ) -> Byte
+m6502::s32 m6502::CPU::ServiceInterrupts( Mem& memory )
+{
+    Word Vector;
+    if ( PendingEvents & PendingNmi )
     {
-        bool OldBit0 = (Operand & ZeroBit) > 0;
-        Operand = Operand >> 1;
-        if ( Flag.C ) 
-        {
-            Operand |= NegativeFlagBit;
-        }
-        Cycles--;
-        Flag.C = OldBit0;
-        SetZeroAndNegativeFlags( Operand );
-        return Operand;
-    };
-
-    /* Push Proccessor Status onto stack. Setting bits 4 & 5 on the stack*/
-    auto PushPSToStack =  [&Cycles, &memory, this] () 
+        PendingEvents &= ~PendingNmi;
+        Vector = 0xFFFA;
+    }
+    else if ( (PendingEvents & PendingIrq) && !Flag.I )
     {
-        Byte PSStack  = PS | BreakFlagBit | UnusedFlagBit;
-        PushByteOntoStack( Cycles, PSStack, memory );
-    };
-
-    /* Pop Processor Status from stack. Clearing bits 4 and 5 (Break and Unused) */
-    auto PopPSFromStack = [&Cycles, &memory, this] ()
+        Vector = 0xFFFE;
+    }
+    else
     {
-        PS = PopByteFromStack( Cycles, memory );
-        Flag.B = false;
-        Flag.Unused = false;
-    };
-
-    const s32 CyclesRequested = Cycles;
-    while (Cycles > 0) {
-        Byte Ins = FetchByte(Cycles, memory);
-        switch ( Ins ) {
-            case INS_AND_IM:
-            {
-                A &= FetchByte( Cycles, memory );
-                SetZeroAndNegativeFlags( A );
-            } break;
-            case INS_ORA_IM:
-            {
-                A |= FetchByte( Cycles, memory );
-                SetZeroAndNegativeFlags( A );
-            } break;
-            case INS_EOR_IM: 
-            {
-                A ^= FetchByte( Cycles, memory );
-                SetZeroAndNegativeFlags( A );  
-            } break;
-            case INS_AND_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                And( Address );
-            } break;
-            case INS_ORA_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                Ora( Address );
-            } break;
-            case INS_EOR_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                Eor( Address );
-            } break;
-            case INS_AND_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                And( Address );
-            } break;
-            case INS_ORA_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                Ora( Address );
-            } break;
-            case INS_EOR_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                Eor( Address );
-            } break;
-            case INS_AND_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                And( Address );
-            } break;
-            case INS_ORA_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                Ora( Address );
-            } break;
-            case INS_EOR_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                Eor( Address );
-            } break;
-            case INS_AND_ABSX:
-            {
-                Word Address = AddressAbsoluteX( Cycles, memory );
-                And( Address );
-            } break;
-            case INS_ORA_ABSX:
-            {
-                Word Address = AddressAbsoluteX( Cycles, memory );
-                Ora( Address );
-            } break;
-            case INS_EOR_ABSX:
-            {
-                Word Address = AddressAbsoluteX( Cycles, memory );
-                Eor( Address );
-            } break;
-            case INS_AND_ABSY:
-            {
-                Word Address = AddressAbsoluteY( Cycles, memory );
-                And( Address );
-            } break;
-            case INS_ORA_ABSY:
-            {
-                Word Address = AddressAbsoluteY( Cycles, memory );
-                Ora( Address );
-            } break;
-            case INS_EOR_ABSY:
-            {
-                Word Address = AddressAbsoluteY( Cycles, memory );
-                Eor( Address );
-            } break;
-            case INS_AND_INDX:
-            {
-                Word Address = AddressIndirectX( Cycles, memory );
-                And( Address );
-            } break;
-            case INS_ORA_INDX:
-            {
-                Word Address = AddressIndirectX( Cycles, memory );
-                Ora( Address );
-            } break;
-            case INS_EOR_INDX:
-            {
-                Word Address = AddressIndirectX( Cycles, memory );
-                Eor( Address );
-            } break;
-            case INS_AND_INDY:
-            {
-                Word Address = AddressIndirectY( Cycles, memory );
-                And( Address );
-            } break;
-            case INS_ORA_INDY:
-            {
-                Word Address = AddressIndirectY( Cycles, memory );
-                Ora( Address );
-            } break;
-            case INS_EOR_INDY:
-            {
-                Word Address = AddressIndirectY( Cycles, memory );
-                Eor( Address );
-            } break;
-            case INS_BIT_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                Byte Value =  ReadByte( Cycles, Address, memory );
-                Flag.Z = !(A & Value);
-                Flag.N = (Value & NegativeFlagBit) != 0;
-                Flag.V = (Value & OverflowFlagBit) != 0;
-            } break;
-            case INS_BIT_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                Byte Value =  ReadByte( Cycles, Address, memory );
-                Flag.Z = !(A & Value);
-                Flag.N = (Value & NegativeFlagBit) != 0;
-                Flag.V = (Value & OverflowFlagBit) != 0;
-            } break;
-            case INS_LDA_IM:
-            {
-                A = FetchByte(Cycles, memory);
-                SetZeroAndNegativeFlags( A );
-            } break;
-            case INS_LDX_IM:
-            {
-                X = FetchByte(Cycles, memory);
-                SetZeroAndNegativeFlags( X );
-            } break;
-            case INS_LDY_IM:
-            {
-                Y = FetchByte(Cycles, memory);
-                SetZeroAndNegativeFlags( Y );
-            } break;
-            case INS_LDA_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                LoadRegister( Address, A );
-            } break;
-            case INS_LDX_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                LoadRegister( Address, X );
-            } break;
-            case INS_LDY_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                LoadRegister( Address, Y );
-            } break;
-            case INS_LDA_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                LoadRegister( Address, A );
-            } break;
-            case INS_LDY_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                LoadRegister( Address, Y );
-            } break;
-            case INS_LDX_ZPY:
-            {
-                Word Address = AddressZeroPageY( Cycles, memory );
-                LoadRegister( Address, X );
-            } break;
-            case INS_LDA_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                LoadRegister( Address, A );
-            } break;
-            case INS_LDX_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                LoadRegister( Address, X );
-            } break;
-            case INS_LDY_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                LoadRegister( Address, Y );
-            } break;
-            case INS_LDA_ABSX:
-            {
-                Word Address = AddressAbsoluteX( Cycles, memory );
-                LoadRegister( Address, A );
-            } break;
-            case INS_LDY_ABSX:
-            {
-                Word Address = AddressAbsoluteX( Cycles, memory );
-                LoadRegister( Address, Y );
-            } break;
-            case INS_LDA_ABSY:
-            {
-                Word Address = AddressAbsoluteY( Cycles, memory );
-                LoadRegister( Address, A );
-            } break;
-            case INS_LDX_ABSY:
-            {
-                Word Address = AddressAbsoluteY( Cycles, memory );
-                LoadRegister( Address, X ); 
-            } break;
-            case INS_LDA_INDX:
-            {
-                Word Address = AddressIndirectX( Cycles, memory );
-                LoadRegister( Address, A );
-            } break;
-            case INS_LDA_INDY:
-            {
-                Word Address = AddressIndirectY( Cycles, memory );
-                LoadRegister( Address, A );
-            } break;
-            case INS_STA_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                WriteByte( A, Cycles, Address, memory );
-            } break;
-            case INS_STX_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                WriteByte( X, Cycles, Address, memory );
-            } break;
-            case INS_STY_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                WriteByte( Y, Cycles, Address, memory );
-            } break;
-            case INS_STA_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                WriteByte( A, Cycles, Address, memory );
-            } break;
-            case INS_STX_ZPY:
-            {
-                Word Address = AddressZeroPageY( Cycles, memory );
-                WriteByte( X, Cycles, Address, memory );
-            } break;
-            case INS_STY_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                WriteByte( Y, Cycles, Address, memory );
-            } break;
-            case INS_STA_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                WriteByte( A, Cycles, Address, memory );
-            } break;
-            case INS_STX_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                WriteByte( X, Cycles, Address, memory );
-            } break;
-            case INS_STY_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                WriteByte( Y, Cycles, Address, memory );
-            } break;
-            case INS_STA_ABSX:
-            {
-                Word Address = AddressAbsoluteX_5( Cycles, memory );
-                WriteByte( A, Cycles, Address, memory );
-            } break;
-            case INS_STA_ABSY:
-            {
-                Word Address = AddressAbsoluteY_5( Cycles, memory );
-                WriteByte( A, Cycles, Address, memory );
-            } break;
-            case INS_STA_INDX:
-            {
-                Word Address = AddressIndirectX( Cycles, memory );
-                WriteByte( A, Cycles, Address, memory );
-            } break;
-            case INS_STA_INDY:
-            {
-                Word Address = AddressIndirectY_5( Cycles, memory );
-                WriteByte( A, Cycles, Address, memory );
-            } break;
-            case INS_JSR:
-            {
-                Word SubAddress = FetchWord( Cycles, memory );
-                PushPCMinusOneToStack( Cycles, memory );
-                PC = SubAddress;
-                Cycles--;
-            } break;
-            case INS_RTS:
-            {
-                Word ReturnAddress = PopWordFromStack( Cycles, memory );
-                PC = ReturnAddress + 1;
-                Cycles -= 2;
-            } break;
-            //An original 6502 has does not correctly fetch the target 
-            //address if the indirect vector falls on a page boundary
-            //( e.g.$xxFF where xx is any value from $00 to $FF ).
-            //In this case fetches the LSB from $xxFF as expected but 
-            //takes the MSB from $xx00.This is fixed in some later chips 
-            //like the 65SC02 so for compatibility always ensure the 
-            //indirect vector is not at the end of the page.
-            case INS_JMP_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                PC = Address;
-            } break;
-            case INS_JMP_IND:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                Address = ReadWord( Cycles, Address, memory );
-                PC = Address;
-            } break;
-            case INS_TSX:
-            {
-                X = SP;
-                Cycles--;
-                SetZeroAndNegativeFlags( X );
-            } break;
-            case INS_TXS:
-            {
-                SP = X;
-                Cycles--;
-            } break;
-            case INS_PHA:
-            {
-                PushByteOntoStack( Cycles, A, memory );
-            } break;
-            case INS_PHP:
-            {
-			    PushPSToStack();
-            } break; 
-            case INS_PLA:
-            {
-                A = PopByteFromStack( Cycles, memory );       
-                SetZeroAndNegativeFlags( A );         
-                Cycles--;
-            } break;
-            case INS_PLP:
-            {
-                PopPSFromStack();
-                Cycles--;
-            } break;
-            case INS_TAX:
-            {
-                X = A;
-                Cycles--;
-                SetZeroAndNegativeFlags( X );
-            } break;
-            case INS_TAY:
-            {
-                Y = A;
-                Cycles--;
-                SetZeroAndNegativeFlags( Y );
-            } break;
-            case INS_TXA:
-            {
-                A = X;
-                Cycles--;
-                SetZeroAndNegativeFlags( A );
-            } break;
-            case INS_TYA:
-            {
-                A = Y;
-                Cycles--;
-                SetZeroAndNegativeFlags( A );
-            } break;
-            case INS_INX:
-            {
-                X++;
-                Cycles--;
-                SetZeroAndNegativeFlags( X );
-            } break;
-            case INS_INY:
-            {
-                Y++;
-                Cycles--;
-                SetZeroAndNegativeFlags( Y );
-            } break;
-            case INS_DEX:
-            {
-                X--;
-                Cycles--;
-                SetZeroAndNegativeFlags( X );
-            } break;
-            case INS_DEY: 
-            {
-                Y--;
-                Cycles--;
-                SetZeroAndNegativeFlags( Y );
-            } break;
-            case INS_DEC_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                Byte Value = ReadByte( Cycles, Address, memory );
-                Value--;
-                Cycles--;
-                WriteByte( Value, Cycles, Address, memory );
-                SetZeroAndNegativeFlags( Value );
-            } break;
-            case INS_DEC_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                Byte Value = ReadByte( Cycles, Address, memory );
-                Value--;
-                Cycles--;
-                WriteByte( Value, Cycles, Address, memory );
-                SetZeroAndNegativeFlags( Value );
-            } break;
-            case INS_DEC_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                Byte Value = ReadByte( Cycles, Address, memory );
-                Value--;
-                Cycles--;
-                WriteByte( Value, Cycles, Address, memory );
-                SetZeroAndNegativeFlags( Value );
-            } break;
-            case INS_DEC_ABSX: 
-            {
-                Word Address = AddressAbsoluteX_5( Cycles, memory );
-                Byte Value = ReadByte( Cycles, Address, memory );
-                Value--;
-                Cycles--;
-                WriteByte( Value, Cycles, Address, memory );
-                SetZeroAndNegativeFlags( Value );
-            } break;
-            case INS_INC_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                Byte Value = ReadByte( Cycles, Address, memory );
-                Value++;
-                Cycles--;
-                WriteByte( Value, Cycles, Address, memory );
-                SetZeroAndNegativeFlags( Value );
-            } break;
-            case INS_INC_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                Byte Value = ReadByte( Cycles, Address, memory );
-                Value++;
-                Cycles--;
-                WriteByte( Value, Cycles, Address, memory );
-                SetZeroAndNegativeFlags( Value );
-            } break;
-            case INS_INC_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                Byte Value = ReadByte( Cycles, Address, memory );
-                Value++;
-                Cycles--;
-                WriteByte( Value, Cycles, Address, memory );
-                SetZeroAndNegativeFlags( Value );
-            } break;
-            case INS_INC_ABSX: 
-            {
-                Word Address = AddressAbsoluteX_5( Cycles, memory );
-                Byte Value = ReadByte( Cycles, Address, memory );
-                Value++;
-                Cycles--;
-                WriteByte( Value, Cycles, Address, memory );
-                SetZeroAndNegativeFlags( Value );
-            } break;
-            case INS_BEQ: 
-            {
-                BranchIf( Flag.Z, true );
-            } break;
-            case INS_BNE: 
-            {
-                BranchIf( Flag.Z, false );
-            } break;
-            case INS_BCS:
-            {
-                BranchIf( Flag.C, true );
-            } break;
-            case INS_BCC:
-            {
-                BranchIf( Flag.C, false );
-            } break;
-            case INS_BMI:
-            {
-                BranchIf( Flag.N, true );
-            } break;
-            case INS_BPL:
-            {
-                BranchIf( Flag.N, false );
-            } break;
-            case INS_BVS:
-            {
-                BranchIf( Flag.V, true );
-            } break;
-            case INS_BVC:
-            {
-                BranchIf( Flag.V, false );
-            } break;
-            case INS_CLC: 
-            {
-                Flag.C = false;
-                Cycles--;
-            } break;
-            case INS_SEC:
-            {
-                Flag.C = true;
-                Cycles--;
-            } break;
-            case INS_CLD:
-            {
-                Flag.D = false;
-                Cycles--;
-            } break;
-            case INS_SED:
-            {
-                Flag.D = true;
-                Cycles--;
-            } break;
-            case INS_CLI:
-            {
-                Flag.I = false;
-                Cycles--;
-            } break;
-            case INS_SEI:
-            {
-                Flag.I = true;
-                Cycles--;
-            } break;
-            case INS_CLV: 
-            {
-                Flag.V = false;
-                Cycles--;
-            } break;
-            case INS_NOP:
-            {
-                Cycles--;
-            } break;
-            case INS_ADC_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                ADC( Operand );
-            } break;
-            case INS_ADC_IM:
-            {
-                Byte Operand = FetchByte( Cycles, memory );
-                ADC( Operand );
-            } break;
-            case INS_ADC_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                ADC( Operand );
-            } break;
-            case INS_ADC_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                ADC( Operand );
-            } break;
-            case INS_ADC_ABSX:
-            {
-                Word Address = AddressAbsoluteX( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                ADC( Operand );
-            } break;
-            case INS_ADC_ABSY:
-            {
-                Word Address = AddressAbsoluteY( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                ADC( Operand );
-            } break;
-            case INS_ADC_INDX:
-            {
-                Word Address = AddressIndirectX( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                ADC( Operand );
-            } break;
-            case INS_ADC_INDY:
-            {
-                Word Address = AddressIndirectY( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                ADC( Operand );
-            } break;
-            case INS_SBC_IM:
-            {
-                Byte Operand = FetchByte( Cycles, memory );
-                SBC( Operand );
-            } break;
-            case INS_SBC_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                SBC( Operand );
-            } break;
-            case INS_SBC_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                SBC( Operand );
-            } break;
-            case INS_SBC_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                SBC( Operand );
-            } break;
-            case INS_SBC_ABSX:
-            {
-                Word Address = AddressAbsoluteX( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                SBC( Operand );
-            } break;
-            case INS_SBC_ABSY:
-            {
-                Word Address = AddressAbsoluteY( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                SBC( Operand );
-            } break;
-            case INS_SBC_INDX:
-            {
-                Word Address = AddressIndirectX( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                SBC( Operand );
-            } break;
-            case INS_SBC_INDY:
-            {
-                Word Address = AddressIndirectY( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                SBC( Operand );
-            } break;
-            case INS_CMP_IM:
-            {
-                Byte Operand = FetchByte( Cycles, memory );
-                RegisterCompare( Operand, A );
-            } break;
-            case INS_CMP_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                RegisterCompare( Operand, A );
-            } break;
-            case INS_CMP_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                RegisterCompare( Operand, A );
-            } break;
-            case INS_CMP_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                RegisterCompare( Operand, A );
-            } break;
-            case INS_CMP_ABSX:
-            {
-                Word Address = AddressAbsoluteX( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                RegisterCompare( Operand, A );
-            } break;
-            case INS_CMP_ABSY:
-            {
-                Word Address = AddressAbsoluteY( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                RegisterCompare( Operand, A );
-            } break;
-            case INS_CMP_INDX:
-            {
-                Word Address = AddressIndirectX( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                RegisterCompare( Operand, A );
-            } break;
-            case INS_CMP_INDY:
-            {
-                Word Address = AddressIndirectY( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                RegisterCompare( Operand, A );
-		    } break;
-            case INS_CPX_IM:
-            {
-                Byte Operand = FetchByte( Cycles, memory );
-                RegisterCompare( Operand, X );
-            } break;
-            case INS_CPX_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                RegisterCompare( Operand, X );
-            } break;
-            case INS_CPX_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                RegisterCompare( Operand, X );
-            } break;
-            case INS_CPY_IM:
-            {
-                Byte Operand = FetchByte( Cycles, memory );
-                RegisterCompare( Operand, Y );
-            } break;
-            case INS_CPY_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                RegisterCompare( Operand, Y );
-            } break;
-            case INS_CPY_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                RegisterCompare( Operand, Y );
-            } break;
-            case INS_ASL:
-            {
-                A = ASL( A );
-            } break;
-            case INS_ASL_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = ASL( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_ASL_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = ASL( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_ASL_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = ASL( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_ASL_ABSX:
-            {
-                Word Address = AddressAbsoluteX_5( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = ASL( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_LSR:
-            {
-                A = LSR( A );
-            } break;
-            case INS_LSR_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = LSR( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_LSR_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = LSR( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_LSR_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = LSR( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_LSR_ABSX:
-            {
-                Word Address = AddressAbsoluteX_5( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = LSR( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_ROL:
-            {
-                A = ROL( A );
-            } break;
-            case INS_ROL_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = ROL( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_ROL_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = ROL( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_ROL_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = ROL( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_ROL_ABSX:
-            {
-                Word Address = AddressAbsoluteX_5( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = ROL( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_ROR:
-            {
-                A = ROR( A );
-            } break;
-            case INS_ROR_ZP:
-            {
-                Word Address = AddressZeroPage( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = ROR( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_ROR_ZPX:
-            {
-                Word Address = AddressZeroPageX( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = ROR( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_ROR_ABS:
-            {
-                Word Address = AddressAbsolute( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = ROR( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_ROR_ABSX:
-            {
-                Word Address = AddressAbsoluteX_5( Cycles, memory );
-                Byte Operand = ReadByte( Cycles, Address, memory );
-                Byte Result = ROR( Operand );
-                WriteByte( Result, Cycles, Address, memory );
-            } break;
-            case INS_BRK:
-            {   
-                PushPCPlusOneToStack( Cycles, memory );
-			    PushPSToStack();
-                constexpr Word InterruptVector = 0xFFFE;
-                PC = ReadWord( Cycles, InterruptVector, memory );
-                Flag.B = true;
-                Flag.I = true;
-            } break;
-            case INS_RTI:
-            {
-                PopPSFromStack();                
-                PC = PopWordFromStack( Cycles, memory );
-                 
-            } break;
-            default:
-            {
-                printf("Instruction %d not handled\n", Ins);
-                throw -1;
-            } break;
-        }
+        return 0;
     }
 
-    const s32 NumCyclesUsed = CyclesRequested - Cycles;
-    return NumCyclesUsed;
+    PushPCToStack( memory );
+    MaterialiseFlags();
+    PushByteOntoStack( (PS & ~BreakFlagBit) | UnusedFlagBit, memory );
+    Flag.I = true;
+    PC = ReadWord( Vector, memory );
+    constexpr s32 InterruptCycles = 7;
+    return InterruptCycles;
+}
+
+m6502::Word m6502::CPU::AddressImmediate( s32&, const Mem& ) {
+    Word ImmediateAddress = PC;
+    PC++;
+    return ImmediateAddress;
 }
 
-m6502::Word m6502::CPU::AddressZeroPage( s32& Cycles, const Mem& memory ) {
-    Byte ZeroPaggeAddress = FetchByte( Cycles, memory );
+m6502::Word m6502::CPU::AddressZeroPage( s32&, const Mem& memory ) {
+    Byte ZeroPaggeAddress = FetchByte( memory );
     return ZeroPaggeAddress;
 }
 
-m6502::Word m6502::CPU::AddressZeroPageX( s32& Cycles, const Mem& memory ) {
-    Byte ZeroPageAddress = FetchByte(Cycles, memory); 
+m6502::Word m6502::CPU::AddressZeroPageX( s32&, const Mem& memory ) {
+    Byte ZeroPageAddress = FetchByte( memory );
     ZeroPageAddress += X;
-    Cycles--;
     return ZeroPageAddress;
 }
 
-m6502::Word m6502::CPU::AddressZeroPageY( s32& Cycles, const Mem& memory ) {
-    Byte ZeroPageAddress = FetchByte(Cycles, memory); 
+m6502::Word m6502::CPU::AddressZeroPageY( s32&, const Mem& memory ) {
+    Byte ZeroPageAddress = FetchByte( memory );
     ZeroPageAddress += Y;
-    Cycles--;
     return ZeroPageAddress;
 }
 
-m6502::Word m6502::CPU::AddressAbsolute( s32& Cycles, const Mem& memory ) {
-    Word AbsAddress = FetchWord( Cycles, memory );
+m6502::Word m6502::CPU::AddressAbsolute( s32&, const Mem& memory ) {
+    Word AbsAddress = FetchWord( memory );
     return AbsAddress;
 }
-m6502::Word m6502::CPU::AddressAbsoluteX( s32& Cycles, const Mem& memory ) {
-    Word AbsAddress = FetchWord( Cycles, memory );
+m6502::Word m6502::CPU::AddressAbsoluteX( s32& ExtraCycles, const Mem& memory ) {
+    Word AbsAddress = FetchWord( memory );
     Word AbsAddressX = AbsAddress + X;
     const bool CrossedPageBoundary = (AbsAddress ^ AbsAddressX) >> 8;
     if ( CrossedPageBoundary ) 
     {
-        Cycles--;
+        ExtraCycles++;
     }
     return AbsAddressX;
 }
 
-m6502::Word m6502::CPU::AddressAbsoluteX_5( s32& Cycles, const Mem& memory ) {
-    Word AbsAddress = FetchWord( Cycles, memory );
+m6502::Word m6502::CPU::AddressAbsoluteX_5( s32&, const Mem& memory ) {
+    Word AbsAddress = FetchWord( memory );
     Word AbsAddressX = AbsAddress + X;
-    Cycles--;
     
     return AbsAddressX;
 }
 
-m6502::Word m6502::CPU::AddressAbsoluteY( s32& Cycles, const Mem& memory ) {
-    Word AbsAddress = FetchWord( Cycles, memory );
+m6502::Word m6502::CPU::AddressAbsoluteY( s32& ExtraCycles, const Mem& memory ) {
+    Word AbsAddress = FetchWord( memory );
     Word AbsAddressY = AbsAddress + Y;
     const bool CrossedPageBoundary = (AbsAddress ^ AbsAddressY) >> 8;
     if ( CrossedPageBoundary ) 
     {
-        Cycles--;
+        ExtraCycles++;
     }
     return AbsAddressY;
 }
 
-m6502::Word m6502::CPU::AddressAbsoluteY_5( s32& Cycles, const Mem& memory ) {
-    Word AbsAddress = FetchWord( Cycles, memory );
+m6502::Word m6502::CPU::AddressAbsoluteY_5( s32&, const Mem& memory ) {
+    Word AbsAddress = FetchWord( memory );
     Word AbsAddressY = AbsAddress + Y;
-    Cycles--;
 
     return AbsAddressY;
 }
 
-m6502::Word m6502::CPU::AddressIndirectX( s32& Cycles, const Mem& memory ) {
-    Byte ZPAdress = FetchByte( Cycles, memory );
+m6502::Word m6502::CPU::AddressIndirectX( s32&, const Mem& memory ) {
+    Byte ZPAdress = FetchByte( memory );
     ZPAdress += X;
-    Cycles--;
-    Word EffectiveAddress = ReadWord( Cycles, ZPAdress, memory );
+    Word EffectiveAddress = ReadWord( ZPAdress, memory );
     return EffectiveAddress;
 }
 
-m6502::Word m6502::CPU::AddressIndirectY( s32& Cycles, const Mem& memory ) {
-    Byte ZPAdress = FetchByte( Cycles, memory );
-    Word EffectiveAddress = ReadWord( Cycles, ZPAdress, memory );
+m6502::Word m6502::CPU::AddressIndirectY( s32& ExtraCycles, const Mem& memory ) {
+    Byte ZPAdress = FetchByte( memory );
+    Word EffectiveAddress = ReadWord( ZPAdress, memory );
     Word EffectiveAddressY = EffectiveAddress + Y;
     const bool CrossedPageBoundary = ( EffectiveAddress ^ EffectiveAddressY ) >> 8;
     if ( CrossedPageBoundary ) 
     {
-        Cycles--;
+        ExtraCycles++;
     }
     return EffectiveAddressY;
 }
 
-m6502::Word m6502::CPU::AddressIndirectY_5( s32& Cycles, const Mem& memory ) {
-    Byte ZPAdress = FetchByte( Cycles, memory );
-    Word EffectiveAddress = ReadWord( Cycles, ZPAdress, memory );
+m6502::Word m6502::CPU::AddressIndirectY_5( s32&, const Mem& memory ) {
+    Byte ZPAdress = FetchByte( memory );
+    Word EffectiveAddress = ReadWord( ZPAdress, memory );
     Word EffectiveAddressY = EffectiveAddress + Y;
-    Cycles--;
 
     return EffectiveAddressY;
 }
@@ -1121,15 +354,10 @@ m6502::Word m6502::CPU::LoadPrg( const Byte* Program, u32 NumBytes, Mem& memory
     Word LoadAddress = 0;
     if ( Program && NumBytes > 2 )
     {
-        u32 At = 0;
-        const Word Lo = Program[At++];
-        const Word Hi = Program[At++] << 8;
+        const Word Lo = Program[0];
+        const Word Hi = Program[1] << 8;
         LoadAddress = Lo | Hi;
-        for ( Word i = LoadAddress; i < LoadAddress+NumBytes-2; i++ )
-        {
-            // TODO : mem copy?
-            memory[i] = Program[At++];
-        }
+        memory.Load( Program + 2, NumBytes - 2, LoadAddress );
     }
 
     return LoadAddress;
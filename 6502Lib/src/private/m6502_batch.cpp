@@ -0,0 +1,205 @@
+#include "m6502_batch.h"
+
+#include <climits>
+
+namespace
+{
+    using Range = unsigned long long;
+
+    Range Pack( m6502::u32 Begin, m6502::u32 End )
+    {
+        return (Range)End << 32 | Begin;
+    }
+
+    m6502::u32 BeginOf( Range Packed )
+    {
+        return (m6502::u32)Packed;
+    }
+
+    m6502::u32 EndOf( Range Packed )
+    {
+        return (m6502::u32)(Packed >> 32);
+    }
+}
+
+m6502::BatchRunner::BatchRunner( u32 NumInstances, u32 NumThreads )
+{
+    if ( NumThreads == 0 )
+    {
+        NumThreads = std::thread::hardware_concurrency();
+    }
+    if ( NumThreads == 0 )
+    {
+        NumThreads = 1;
+    }
+
+    Instances.reserve( NumInstances );
+    for ( u32 i = 0; i < NumInstances; i++ )
+    {
+        Instances.push_back( std::make_unique<Instance>() );
+        Instances.back()->cpu.Reset( Instances.back()->memory );
+    }
+    Results.resize( NumInstances );
+
+    Queues = std::make_unique<Queue[]>( NumThreads );
+    Workers.reserve( NumThreads );
+    for ( u32 Worker = 0; Worker < NumThreads; Worker++ )
+    {
+        Workers.emplace_back( &BatchRunner::WorkerLoop, this, Worker );
+    }
+}
+
+m6502::BatchRunner::~BatchRunner()
+{
+    {
+        std::lock_guard<std::mutex> Guard( Lock );
+        ShuttingDown = true;
+    }
+    Started.notify_all();
+    for ( std::thread& Worker : Workers )
+    {
+        Worker.join();
+    }
+}
+
+const std::vector<m6502::BatchRunner::Result>& m6502::BatchRunner::Run( unsigned long long Budget, s32 Slice, HaltCheck Check, void* Context )
+{
+    CycleBudget = Budget;
+    SliceCycles = Slice > 0 ? Slice : INT_MAX;
+    Halt = Check;
+    HaltContext = Context;
+
+    // Even shares to start with, stealing evens out the rest
+    const u32 NumWorkers = NumThreads();
+    for ( u32 Worker = 0; Worker < NumWorkers; Worker++ )
+    {
+        const u32 Begin = (u32)((unsigned long long)NumInstances() * Worker / NumWorkers);
+        const u32 End = (u32)((unsigned long long)NumInstances() * (Worker + 1) / NumWorkers);
+        Queues[Worker].Range.store( Pack( Begin, End ), std::memory_order_relaxed );
+    }
+
+    std::unique_lock<std::mutex> Guard( Lock );
+    NumWorking = NumWorkers;
+    Generation++;
+    Started.notify_all();
+    Finished.wait( Guard, [this] { return NumWorking == 0; } );
+    return Results;
+}
+
+void m6502::BatchRunner::WorkerLoop( u32 Worker )
+{
+    u32 SeenGeneration = 0;
+    while ( true )
+    {
+        {
+            std::unique_lock<std::mutex> Guard( Lock );
+            Started.wait( Guard, [&] { return ShuttingDown || Generation != SeenGeneration; } );
+            if ( ShuttingDown )
+            {
+                return;
+            }
+            SeenGeneration = Generation;
+        }
+
+        RunShare( Worker );
+
+        std::lock_guard<std::mutex> Guard( Lock );
+        if ( --NumWorking == 0 )
+        {
+            Finished.notify_one();
+        }
+    }
+}
+
+void m6502::BatchRunner::RunShare( u32 Worker )
+{
+    std::atomic<Range>& Own = Queues[Worker].Range;
+    while ( true )
+    {
+        Range Current = Own.load( std::memory_order_acquire );
+        const u32 Begin = BeginOf( Current );
+        const u32 End = EndOf( Current );
+        if ( Begin >= End )
+        {
+            if ( !Steal( Worker ) )
+            {
+                return;
+            }
+            continue;
+        }
+        if ( Own.compare_exchange_weak( Current, Pack( Begin + 1, End ), std::memory_order_acq_rel ) )
+        {
+            RunInstance( Begin );
+        }
+    }
+}
+
+bool m6502::BatchRunner::Steal( u32 Worker )
+{
+    const u32 NumWorkers = NumThreads();
+    for ( u32 i = 1; i < NumWorkers; i++ )
+    {
+        std::atomic<Range>& Victim = Queues[(Worker + i) % NumWorkers].Range;
+        Range Current = Victim.load( std::memory_order_acquire );
+        while ( BeginOf( Current ) < EndOf( Current ) )
+        {
+            const u32 Begin = BeginOf( Current );
+            const u32 End = EndOf( Current );
+            const u32 Split = End - (End - Begin + 1) / 2;
+            if ( Victim.compare_exchange_weak( Current, Pack( Begin, Split ), std::memory_order_acq_rel ) )
+            {
+                // Our own range is empty so nobody can be taking from it
+                Queues[Worker].Range.store( Pack( Split, End ), std::memory_order_release );
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void m6502::BatchRunner::RunInstance( u32 Index )
+{
+    CPU& cpu = Instances[Index]->cpu;
+    Mem& memory = Instances[Index]->memory;
+    Result Out;
+
+    try
+    {
+        while ( Out.CyclesUsed < CycleBudget )
+        {
+            const unsigned long long Left = CycleBudget - Out.CyclesUsed;
+            Out.CyclesUsed += cpu.Execute( Left < (unsigned long long)SliceCycles ? (s32)Left : SliceCycles, memory );
+            if ( cpu.Halted == CPU::HaltReason::Trap )
+            {
+                Out.Reason = ExitReason::Trapped;
+                break;
+            }
+            if ( cpu.Halted == CPU::HaltReason::Breakpoint )
+            {
+                Out.Reason = ExitReason::Breakpoint;
+                break;
+            }
+            if ( Halt && Halt( cpu, memory, HaltContext ) )
+            {
+                Out.Reason = ExitReason::Halted;
+                break;
+            }
+        }
+    }
+    catch ( const IllegalOpcode& )
+    {
+        Out.Reason = ExitReason::IllegalOpcode;
+    }
+    catch ( ... )
+    {
+        Out.Reason = ExitReason::Error;
+    }
+
+    Out.PC = cpu.PC;
+    Out.A = cpu.A;
+    Out.X = cpu.X;
+    Out.Y = cpu.Y;
+    Out.SP = cpu.SP;
+    Out.PS = cpu.PS;
+    Results[Index] = Out;
+}
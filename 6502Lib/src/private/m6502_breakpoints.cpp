@@ -0,0 +1,39 @@
+#include "m6502_breakpoints.h"
+
+void m6502::Breakpoints::Set( Word Address )
+{
+    if ( !IsSet( Address ) )
+    {
+        const u32 Page = Address / Mem::PAGE_SIZE;
+        Addresses[Address / BITS] |= 1ull << (Address % BITS);
+        Pages[Page / BITS] |= 1ull << (Page % BITS);
+        NumSet++;
+    }
+}
+
+void m6502::Breakpoints::Clear( Word Address )
+{
+    if ( IsSet( Address ) )
+    {
+        Addresses[Address / BITS] &= ~(1ull << (Address % BITS));
+        NumSet--;
+
+        // The page stays flagged while it has any breakpoint left
+        const u32 Page = Address / Mem::PAGE_SIZE;
+        constexpr u32 WORDS_PER_PAGE = Mem::PAGE_SIZE / BITS;
+        unsigned long long Left = 0;
+        for ( u32 i = 0; i < WORDS_PER_PAGE; i++ )
+        {
+            Left |= Addresses[Page * WORDS_PER_PAGE + i];
+        }
+        if ( Left == 0 )
+        {
+            Pages[Page / BITS] &= ~(1ull << (Page % BITS));
+        }
+    }
+}
+
+void m6502::Breakpoints::ClearAll()
+{
+    *this = Breakpoints();
+}
@@ -0,0 +1,163 @@
+#include "m6502_callprofile.h"
+#include <algorithm>
+#include <map>
+
+m6502::CallProfile::CallProfile()
+{
+    Clear();
+}
+
+m6502::s32 m6502::CallProfile::Execute( s32 Cycles, CPU& cpu, Mem& memory )
+{
+    const s32 CyclesRequested = Cycles;
+    while ( Cycles > 0 )
+    {
+        if ( cpu.PendingEvents )
+        {
+            // An interrupt is a call to its handler, charged with its entry
+            const Byte SP = cpu.SP;
+            const Word PC = cpu.PC;
+            const s32 CyclesBefore = Cycles;
+            const bool Continue = cpu.ServicePendingEvents( Cycles, memory );
+            if ( cpu.PC != PC )
+            {
+                Call( cpu.PC, SP );
+                Nodes[Current].SelfCycles += CyclesBefore - Cycles;
+            }
+            if ( !Continue )
+            {
+                break;
+            }
+        }
+
+        const Byte Opcode = memory.Read( cpu.PC );
+        const Byte SP = cpu.SP;
+        const u32 Charged = Current;
+        const s32 CyclesUsed = cpu.Interpret( 1, memory );
+        if ( cpu.Halted != CPU::HaltReason::None )
+        {
+            // Stopped before the instruction (a breakpoint), nothing ran
+            break;
+        }
+        Nodes[Charged].SelfCycles += CyclesUsed;
+        Cycles -= CyclesUsed;
+
+        switch ( Opcode )
+        {
+            case CPU::INS_JSR:
+            case CPU::INS_BRK:
+                Call( cpu.PC, SP );
+                break;
+            case CPU::INS_RTS:
+            case CPU::INS_RTI:
+            case CPU::INS_TXS:
+                Unwind( cpu.SP );
+                break;
+        }
+    }
+    return CyclesRequested - Cycles;
+}
+
+void m6502::CallProfile::Call( Word Address, Byte ReturnSP )
+{
+    const unsigned long long Key = (unsigned long long)Current << 16 | Address;
+    auto [Found, IsNew] = Children.try_emplace( Key, (u32)Nodes.size() );
+    if ( IsNew )
+    {
+        Nodes.push_back( { Address, Current } );
+    }
+    Frames.push_back( { Current, ReturnSP } );
+    Current = Found->second;
+    Nodes[Current].Calls++;
+}
+
+void m6502::CallProfile::Unwind( Byte SP )
+{
+    while ( !Frames.empty() && Frames.back().ReturnSP <= SP )
+    {
+        Current = Frames.back().Node;
+        Frames.pop_back();
+    }
+}
+
+std::string m6502::CallProfile::NameOf( u32 NodeIndex ) const
+{
+    if ( NodeIndex == ROOT )
+    {
+        return "root";
+    }
+    std::string Name = Symbols.NameFor( Nodes[NodeIndex].Address );
+    if ( Name.empty() )
+    {
+        char Hex[8];
+        snprintf( Hex, sizeof(Hex), "$%04X", Nodes[NodeIndex].Address );
+        Name = Hex;
+    }
+    return Name;
+}
+
+std::vector<m6502::CallProfile::Routine> m6502::CallProfile::Routines() const
+{
+    // A node's parent always comes before it, so totals can be summed
+    // from the back
+    std::vector<unsigned long long> Total( Nodes.size() );
+    for ( size_t i = Nodes.size(); i-- > 0; )
+    {
+        Total[i] += Nodes[i].SelfCycles;
+        if ( i != ROOT )
+        {
+            Total[Nodes[i].Parent] += Total[i];
+        }
+    }
+
+    std::map<Word, Routine> ByAddress;
+    for ( u32 i = ROOT + 1; i < Nodes.size(); i++ )
+    {
+        const Node& Called = Nodes[i];
+        Routine& Entry = ByAddress.try_emplace( Called.Address, Routine{ Called.Address, NameOf( i ), 0, 0, 0 } ).first->second;
+        Entry.Calls += Called.Calls;
+        Entry.ExclusiveCycles += Called.SelfCycles;
+
+        // Inside a recursive call the outer call already counts it
+        bool IsOutermost = true;
+        for ( u32 Up = Called.Parent; Up != ROOT && IsOutermost; Up = Nodes[Up].Parent )
+        {
+            IsOutermost = Nodes[Up].Address != Called.Address;
+        }
+        if ( IsOutermost )
+        {
+            Entry.InclusiveCycles += Total[i];
+        }
+    }
+
+    std::vector<Routine> Sorted;
+    for ( auto& [Address, Entry] : ByAddress )
+    {
+        Sorted.push_back( std::move( Entry ) );
+    }
+    std::stable_sort( Sorted.begin(), Sorted.end(), []( const Routine& A, const Routine& B ) {
+        return A.InclusiveCycles > B.InclusiveCycles;
+    } );
+    return Sorted;
+}
+
+void m6502::CallProfile::WriteFoldedStacks( FILE* File ) const
+{
+    std::vector<std::string> Paths( Nodes.size() );
+    for ( u32 i = 0; i < Nodes.size(); i++ )
+    {
+        Paths[i] = i == ROOT ? NameOf( i ) : Paths[Nodes[i].Parent] + ";" + NameOf( i );
+        if ( Nodes[i].SelfCycles )
+        {
+            fprintf( File, "%s %llu\n", Paths[i].c_str(), Nodes[i].SelfCycles );
+        }
+    }
+}
+
+void m6502::CallProfile::Clear()
+{
+    Nodes.assign( 1, Node{ 0, ROOT } );
+    Children.clear();
+    Frames.clear();
+    Current = ROOT;
+}
@@ -0,0 +1,14 @@
+/* The opcode pairs CPU::Interpret fuses by default, the top 8 of a
+*  PairProfile of the functional test (6502FunctionalTestAsm) */
+
+/* Written by PairProfile::WriteFusedPairs from 30648050 instructions.
+*  M6502_FUSED_PAIR( First, Second ), the share of the instructions
+*  that were First followed by Second */
+M6502_FUSED_PAIR( 0xC5, 0xD0 )     // 15.77%
+M6502_FUSED_PAIR( 0x68, 0x29 )     //  8.10%
+M6502_FUSED_PAIR( 0xD0, 0x68 )     //  7.89%
+M6502_FUSED_PAIR( 0x08, 0xA5 )     //  7.89%
+M6502_FUSED_PAIR( 0x29, 0xC5 )     //  7.89%
+M6502_FUSED_PAIR( 0x28, 0x08 )     //  7.39%
+M6502_FUSED_PAIR( 0xA5, 0x8D )     //  0.99%
+M6502_FUSED_PAIR( 0x8D, 0xA5 )     //  0.99%
@@ -0,0 +1,77 @@
+#include "m6502_harness.h"
+
+#include <chrono>
+
+m6502::Word m6502::TrapHarness::FindSuccessAddress( const char* ListingPath )
+{
+    FILE* Listing = fopen( ListingPath, "r" );
+    if ( !Listing )
+    {
+        return 0;
+    }
+
+    // The call of the macro is a line that is only "success" (the
+    // definition says "success macro"), its expansion follows as
+    // "3469 : 4c6934          >        jmp *"
+    Word Address = 0;
+    bool InSuccess = false;
+    char Line[512];
+    while ( !Address && fgets( Line, sizeof(Line), Listing ) )
+    {
+        char Word0[64] = {}, Word1[64] = {};
+        const int NumWords = sscanf( Line, "%63s %63s", Word0, Word1 );
+        if ( NumWords >= 1 && strcmp( Word0, "success" ) == 0 && (NumWords == 1 || Word1[0] == ';') )
+        {
+            InSuccess = true;
+            continue;
+        }
+        unsigned int LineAddress;
+        if ( InSuccess && strstr( Line, "jmp *" ) && sscanf( Line, "%x :", &LineAddress ) == 1 )
+        {
+            Address = (m6502::Word)LineAddress;
+        }
+    }
+    fclose( Listing );
+    return Address;
+}
+
+m6502::TrapHarness::Result m6502::TrapHarness::Run( CPU& cpu, Mem& memory, Word SuccessAddress,
+                                                    unsigned long long MaxCycles, s32 SliceCycles )
+{
+    Result Out;
+
+    // The caller's HaltOnTrap comes back however we leave, a page handler
+    // may throw anything
+    struct RestoreHaltOnTrap {
+        CPU& cpu;
+        const bool HaltOnTrap;
+        ~RestoreHaltOnTrap() { cpu.HaltOnTrap = HaltOnTrap; }
+    } HaltOnTrapGuard{ cpu, cpu.HaltOnTrap };
+    cpu.HaltOnTrap = true;
+    const auto Start = std::chrono::steady_clock::now();
+    try
+    {
+        while ( Out.Cycles < MaxCycles )
+        {
+            const unsigned long long Left = MaxCycles - Out.Cycles;
+            Out.Cycles += cpu.Execute( Left < (unsigned long long)SliceCycles ? (s32)Left : SliceCycles, memory );
+            if ( cpu.Halted == CPU::HaltReason::Trap )
+            {
+                Out.Status = cpu.PC == SuccessAddress ? Outcome::Passed : Outcome::Failed;
+                break;
+            }
+            if ( cpu.Halted == CPU::HaltReason::Breakpoint )
+            {
+                Out.Status = Outcome::Breakpoint;
+                break;
+            }
+        }
+    }
+    catch ( const IllegalOpcode& )
+    {
+        Out.Status = Outcome::IllegalOpcode;
+    }
+    Out.Seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - Start ).count();
+    Out.TrapAddress = cpu.PC;
+    return Out;
+}
@@ -0,0 +1,705 @@
+#pragma once
+#include <array>
+#include "m6502.h"
+
+/* Instruction handlers used by CPU::Execute.
+*  Each opcode maps to exactly one handler in the DispatchTable, the opcode byte
+*  has already been fetched by the time the handler is called.
+*  Cycles are charged once per instruction: the table holds the base cycle count
+*  of each opcode and the handler returns only the extra cycles it took
+*  (page boundary crossed, branch taken). */
+namespace m6502 { namespace Instructions
+{
+    /* @return the extra cycles on top of the opcode's base cycles */
+    using Handler = s32 (*)( CPU& cpu, Mem& memory );
+
+    struct Instruction {
+        Handler Execute;
+        s32 BaseCycles;     // Including the opcode fetch
+        Byte Length;        // Opcode + operand bytes
+    };
+
+    using DispatchTable = std::array<Instruction, 256>;
+
+    using Register = Byte CPU::*;
+    using AddressMode = Word (CPU::*)( s32& ExtraCycles, const Mem& memory );
+
+    /* Read the operand of an instruction using the given addressing mode */
+    template<AddressMode Mode>
+    inline Byte ReadOperand( CPU& cpu, s32& ExtraCycles, const Mem& memory )
+    {
+        Word Address = (cpu.*Mode)( ExtraCycles, memory );
+        return cpu.ReadByte( Address, memory );
+    }
+
+    /* Trap for every opcode that has no handler */
+    inline s32 IllegalOpcode( CPU& cpu, Mem& memory )
+    {
+        cpu.PC--;
+        throw m6502::IllegalOpcode{ memory.Read( cpu.PC ), cpu.PC };
+    }
+
+    /* Load a Register with the value from the memory address
+    *  - LDA, LDX, LDY */
+    template<Register Reg, AddressMode Mode>
+    s32 LoadRegister( CPU& cpu, Mem& memory )
+    {
+        s32 ExtraCycles = 0;
+        cpu.*Reg = ReadOperand<Mode>( cpu, ExtraCycles, memory );
+        cpu.SetZeroAndNegativeFlags( cpu.*Reg );
+        return ExtraCycles;
+    }
+
+    /* Store a Register to the memory address
+    *  - STA, STX, STY */
+    template<Register Reg, AddressMode Mode>
+    s32 StoreRegister( CPU& cpu, Mem& memory )
+    {
+        s32 ExtraCycles = 0;
+        Word Address = (cpu.*Mode)( ExtraCycles, memory );
+        cpu.WriteByte( cpu.*Reg, Address, memory );
+        return ExtraCycles;
+    }
+
+    /* And the A Register with the value from the memory address */
+    template<AddressMode Mode>
+    s32 And( CPU& cpu, Mem& memory )
+    {
+        s32 ExtraCycles = 0;
+        cpu.A &= ReadOperand<Mode>( cpu, ExtraCycles, memory );
+        cpu.SetZeroAndNegativeFlags( cpu.A );
+        return ExtraCycles;
+    }
+
+    /* Or the A Register with the value from the memory address */
+    template<AddressMode Mode>
+    s32 Ora( CPU& cpu, Mem& memory )
+    {
+        s32 ExtraCycles = 0;
+        cpu.A |= ReadOperand<Mode>( cpu, ExtraCycles, memory );
+        cpu.SetZeroAndNegativeFlags( cpu.A );
+        return ExtraCycles;
+    }
+
+    /* Eor the A Register with the value from the memory address */
+    template<AddressMode Mode>
+    s32 Eor( CPU& cpu, Mem& memory )
+    {
+        s32 ExtraCycles = 0;
+        cpu.A ^= ReadOperand<Mode>( cpu, ExtraCycles, memory );
+        cpu.SetZeroAndNegativeFlags( cpu.A );
+        return ExtraCycles;
+    }
+
+    template<AddressMode Mode>
+    s32 Bit( CPU& cpu, Mem& memory )
+    {
+        s32 ExtraCycles = 0;
+        Byte Value = ReadOperand<Mode>( cpu, ExtraCycles, memory );
+        cpu.SetZeroAndNegativeFlags( !(cpu.A & Value), (Value & CPU::NegativeFlagBit) != 0 );
+        cpu.Flag.V = (Value & CPU::OverflowFlagBit) != 0;
+        return ExtraCycles;
+    }
+
+    /* Do add with carry given the operand */
+    inline void AddWithCarry( CPU& cpu, Byte Operand )
+    {
+        const bool AreSignBitsTheSame = !((cpu.A ^ Operand) & CPU::NegativeFlagBit);
+        Word Sum = cpu.A;
+        Sum += Operand;
+        Sum += cpu.Flag.C;
+        cpu.A = (Sum & 0xFF);
+        cpu.SetZeroAndNegativeFlags( cpu.A );
+        cpu.Flag.C = Sum > 0xFF;
+        cpu.Flag.V = AreSignBitsTheSame && ((cpu.A ^ Operand) & CPU::NegativeFlagBit);
+    }
+
+    /* Decimal mode add with carry (NMOS): the result and C are BCD, Z comes
+    *  from the binary sum and N and V from the sum before the high digit is
+    *  adjusted */
+    inline void AddDecimalWithCarry( CPU& cpu, Byte Operand )
+    {
+        const bool IsBinaryZero = ((cpu.A + Operand + cpu.Flag.C) & 0xFF) == 0;
+        s32 Low = (cpu.A & 0x0F) + (Operand & 0x0F) + cpu.Flag.C;
+        if ( Low >= 0x0A )
+        {
+            Low = ((Low + 0x06) & 0x0F) + 0x10;
+        }
+        s32 Sum = (cpu.A & 0xF0) + (Operand & 0xF0) + Low;
+        cpu.SetZeroAndNegativeFlags( IsBinaryZero, (Sum & CPU::NegativeFlagBit) != 0 );
+        cpu.Flag.V = (~(cpu.A ^ Operand) & (cpu.A ^ Sum) & CPU::NegativeFlagBit) != 0;
+        if ( Sum >= 0xA0 )
+        {
+            Sum += 0x60;
+        }
+        cpu.A = Sum & 0xFF;
+        cpu.Flag.C = Sum >= 0x100;
+    }
+
+    /* Decimal mode subtract with carry (NMOS): the flags are those of the
+    *  binary subtract, only the result is BCD */
+    inline void SubtractDecimalWithCarry( CPU& cpu, Byte Operand )
+    {
+        const Byte A = cpu.A;
+        const bool Carry = cpu.Flag.C;
+        AddWithCarry( cpu, ~Operand );
+        s32 Low = (A & 0x0F) - (Operand & 0x0F) + Carry - 1;
+        if ( Low < 0 )
+        {
+            Low = ((Low - 0x06) & 0x0F) - 0x10;
+        }
+        s32 Difference = (A & 0xF0) - (Operand & 0xF0) + Low;
+        if ( Difference < 0 )
+        {
+            Difference -= 0x60;
+        }
+        cpu.A = Difference & 0xFF;
+    }
+
+    template<AddressMode Mode>
+    s32 ADC( CPU& cpu, Mem& memory )
+    {
+        s32 ExtraCycles = 0;
+        const Byte Operand = ReadOperand<Mode>( cpu, ExtraCycles, memory );
+        if ( cpu.Flag.D )
+        {
+            AddDecimalWithCarry( cpu, Operand );
+        }
+        else
+        {
+            AddWithCarry( cpu, Operand );
+        }
+        return ExtraCycles;
+    }
+
+    /* Subtract with carry is add with carry of the inverted operand */
+    template<AddressMode Mode>
+    s32 SBC( CPU& cpu, Mem& memory )
+    {
+        s32 ExtraCycles = 0;
+        const Byte Operand = ReadOperand<Mode>( cpu, ExtraCycles, memory );
+        if ( cpu.Flag.D )
+        {
+            SubtractDecimalWithCarry( cpu, Operand );
+        }
+        else
+        {
+            AddWithCarry( cpu, ~Operand );
+        }
+        return ExtraCycles;
+    }
+
+    /* Sets the processor status for a CMP/CPX/CPY instruction */
+    template<Register Reg, AddressMode Mode>
+    s32 Compare( CPU& cpu, Mem& memory )
+    {
+        s32 ExtraCycles = 0;
+        Byte Operand = ReadOperand<Mode>( cpu, ExtraCycles, memory );
+        Byte RegisterValue = cpu.*Reg;
+        // N from bit 7 of the difference, Z when the difference is 0 (equal)
+        Byte Temp = RegisterValue - Operand;
+        cpu.SetZeroAndNegativeFlags( Temp );
+        cpu.Flag.C = RegisterValue >= Operand;
+        return ExtraCycles;
+    }
+
+    using ShiftOp = Byte (*)( CPU& cpu, Byte Operand );
+
+    /* Arithmetic Shift Left */
+    inline Byte ASL( CPU& cpu, Byte Operand )
+    {
+        cpu.Flag.C = ( Operand & CPU::NegativeFlagBit ) > 0;
+        Byte Result = Operand << 1;
+        cpu.SetZeroAndNegativeFlags( Result );
+        return Result;
+    }
+
+    /* Logical Shift Right */
+    inline Byte LSR( CPU& cpu, Byte Operand )
+    {
+        cpu.Flag.C = ( Operand & CPU::ZeroBit ) > 0;
+        Byte Result = Operand >> 1;
+        cpu.SetZeroAndNegativeFlags( Result );
+        return Result;
+    }
+
+    /* Rotate Left */
+    inline Byte ROL( CPU& cpu, Byte Operand )
+    {
+        Byte NewBit0 = cpu.Flag.C ? CPU::ZeroBit : 0;
+        cpu.Flag.C = ( Operand & CPU::NegativeFlagBit ) > 0;
+        Operand = Operand << 1;
+        Operand |= NewBit0;
+        cpu.SetZeroAndNegativeFlags( Operand );
+        return Operand;
+    }
+
+    /* Rotate Right */
+    inline Byte ROR( CPU& cpu, Byte Operand )
+    {
+        bool OldBit0 = (Operand & CPU::ZeroBit) > 0;
+        Operand = Operand >> 1;
+        if ( cpu.Flag.C )
+        {
+            Operand |= CPU::NegativeFlagBit;
+        }
+        cpu.Flag.C = OldBit0;
+        cpu.SetZeroAndNegativeFlags( Operand );
+        return Operand;
+    }
+
+    /* Shift/Rotate the A Register */
+    template<ShiftOp Op>
+    s32 ShiftAccumulator( CPU& cpu, Mem& )
+    {
+        cpu.A = Op( cpu, cpu.A );
+        return 0;
+    }
+
+    /* Shift/Rotate the value at the memory address */
+    template<ShiftOp Op, AddressMode Mode>
+    s32 ShiftMemory( CPU& cpu, Mem& memory )
+    {
+        s32 ExtraCycles = 0;
+        Word Address = (cpu.*Mode)( ExtraCycles, memory );
+        Byte Operand = cpu.ReadByte( Address, memory );
+        Byte Result = Op( cpu, Operand );
+        cpu.WriteByte( Result, Address, memory );
+        return ExtraCycles;
+    }
+
+    /* Add Delta (+1 or -1) to the value at the memory address
+    *  - INC, DEC */
+    template<s32 Delta, AddressMode Mode>
+    s32 IncrementMemory( CPU& cpu, Mem& memory )
+    {
+        s32 ExtraCycles = 0;
+        Word Address = (cpu.*Mode)( ExtraCycles, memory );
+        Byte Value = cpu.ReadByte( Address, memory );
+        Value += Delta;
+        cpu.WriteByte( Value, Address, memory );
+        cpu.SetZeroAndNegativeFlags( Value );
+        return ExtraCycles;
+    }
+
+    /* Add Delta (+1 or -1) to a register
+    *  - INX, INY, DEX, DEY */
+    template<s32 Delta, Register Reg>
+    s32 IncrementRegister( CPU& cpu, Mem& )
+    {
+        cpu.*Reg += Delta;
+        cpu.SetZeroAndNegativeFlags( cpu.*Reg );
+        return 0;
+    }
+
+    /* Copy one register to another
+    *  - TAX, TAY, TXA, TYA, TSX */
+    template<Register From, Register To>
+    s32 Transfer( CPU& cpu, Mem& )
+    {
+        cpu.*To = cpu.*From;
+        cpu.SetZeroAndNegativeFlags( cpu.*To );
+        return 0;
+    }
+
+    /* TXS is the only transfer that leaves the flags alone */
+    inline s32 TXS( CPU& cpu, Mem& )
+    {
+        cpu.SP = cpu.X;
+        return 0;
+    }
+
+    /* Conditional Branch, taken when the flag bit in PS matches Expected
+    *  - +1 cycle if taken, +1 more if the branch lands on another page */
+    template<Byte FlagBit, bool Expected>
+    s32 BranchIf( CPU& cpu, Mem& memory )
+    {
+        SByte Offset = cpu.FetchSByte( memory );
+        const bool Test = cpu.IsFlagSet( FlagBit );
+        if ( Test != Expected )
+        {
+            return 0;
+        }
+
+        const Word PCOld = cpu.PC;
+        cpu.PC += Offset;
+        if ( Offset == -2 )
+        {
+            cpu.NoteTrap();
+        }
+
+        const bool PageChanged = ( cpu.PC >> 8) != (PCOld >> 8);
+        return PageChanged ? 2 : 1;
+    }
+
+    /* Set or clear a bit in the processor status
+    *  - CLC, SEC, CLD, SED, CLI, SEI, CLV */
+    template<Byte FlagBit, bool Value>
+    s32 SetFlag( CPU& cpu, Mem& )
+    {
+        if ( Value )
+        {
+            cpu.PS |= FlagBit;
+        }
+        else
+        {
+            cpu.PS &= ~FlagBit;
+        }
+        return 0;
+    }
+
+    inline s32 NOP( CPU&, Mem& )
+    {
+        return 0;
+    }
+
+    inline s32 PHA( CPU& cpu, Mem& memory )
+    {
+        cpu.PushByteOntoStack( cpu.A, memory );
+        return 0;
+    }
+
+    inline s32 PHP( CPU& cpu, Mem& memory )
+    {
+        cpu.PushPSToStack( memory );
+        return 0;
+    }
+
+    inline s32 PLA( CPU& cpu, Mem& memory )
+    {
+        cpu.A = cpu.PopByteFromStack( memory );
+        cpu.SetZeroAndNegativeFlags( cpu.A );
+        return 0;
+    }
+
+    inline s32 PLP( CPU& cpu, Mem& memory )
+    {
+        cpu.PopPSFromStack( memory );
+        return 0;
+    }
+
+    inline s32 JSR( CPU& cpu, Mem& memory )
+    {
+        Word SubAddress = cpu.FetchWord( memory );
+        cpu.PushPCMinusOneToStack( memory );
+        cpu.PC = SubAddress;
+        return 0;
+    }
+
+    inline s32 RTS( CPU& cpu, Mem& memory )
+    {
+        Word ReturnAddress = cpu.PopWordFromStack( memory );
+        cpu.PC = ReturnAddress + 1;
+        return 0;
+    }
+
+    inline s32 JMPAbsolute( CPU& cpu, Mem& memory )
+    {
+        const Word Instruction = cpu.PC - 1;
+        cpu.PC = cpu.FetchWord( memory );
+        if ( cpu.PC == Instruction )
+        {
+            cpu.NoteTrap();
+        }
+        return 0;
+    }
+
+    //An original 6502 has does not correctly fetch the target
+    //address if the indirect vector falls on a page boundary
+    //( e.g.$xxFF where xx is any value from $00 to $FF ).
+    //In this case fetches the LSB from $xxFF as expected but
+    //takes the MSB from $xx00.This is fixed in some later chips
+    //like the 65SC02 so for compatibility always ensure the
+    //indirect vector is not at the end of the page.
+    inline s32 JMPIndirect( CPU& cpu, Mem& memory )
+    {
+        const Word Instruction = cpu.PC - 1;
+        Word Address = cpu.FetchWord( memory );
+        cpu.PC = cpu.ReadWord( Address, memory );
+        if ( cpu.PC == Instruction )
+        {
+            cpu.NoteTrap();
+        }
+        return 0;
+    }
+
+    inline s32 BRK( CPU& cpu, Mem& memory )
+    {
+        cpu.PushPCPlusOneToStack( memory );
+        cpu.PushPSToStack( memory );
+        constexpr Word InterruptVector = 0xFFFE;
+        cpu.PC = cpu.ReadWord( InterruptVector, memory );
+        cpu.Flag.B = true;
+        cpu.Flag.I = true;
+        return 0;
+    }
+
+    inline s32 RTI( CPU& cpu, Mem& memory )
+    {
+        cpu.PopPSFromStack( memory );
+        cpu.PC = cpu.PopWordFromStack( memory );
+        return 0;
+    }
+
+    /* Build the opcode -> handler, base cycles & length table, anything not listed traps */
+    constexpr DispatchTable MakeDispatchTable()
+    {
+        DispatchTable Table{};
+        for ( Instruction& Entry : Table )
+        {
+            Entry = { &IllegalOpcode, 0, 1 };
+        }
+
+        constexpr Register A = &CPU::A, X = &CPU::X, Y = &CPU::Y, SP = &CPU::SP;
+
+        constexpr AddressMode
+            IM = &CPU::AddressImmediate,
+            ZP = &CPU::AddressZeroPage,
+            ZPX = &CPU::AddressZeroPageX,
+            ZPY = &CPU::AddressZeroPageY,
+            ABS = &CPU::AddressAbsolute,
+            ABSX = &CPU::AddressAbsoluteX,
+            ABSX_5 = &CPU::AddressAbsoluteX_5,
+            ABSY = &CPU::AddressAbsoluteY,
+            ABSY_5 = &CPU::AddressAbsoluteY_5,
+            INDX = &CPU::AddressIndirectX,
+            INDY = &CPU::AddressIndirectY,
+            INDY_5 = &CPU::AddressIndirectY_5;
+
+        // Load/Store
+        Table[CPU::INS_LDA_IM]      = { &LoadRegister<A, IM>, 2, 2 };
+        Table[CPU::INS_LDA_ZP]      = { &LoadRegister<A, ZP>, 3, 2 };
+        Table[CPU::INS_LDA_ZPX]     = { &LoadRegister<A, ZPX>, 4, 2 };
+        Table[CPU::INS_LDA_ABS]     = { &LoadRegister<A, ABS>, 4, 3 };
+        Table[CPU::INS_LDA_ABSX]    = { &LoadRegister<A, ABSX>, 4, 3 };
+        Table[CPU::INS_LDA_ABSY]    = { &LoadRegister<A, ABSY>, 4, 3 };
+        Table[CPU::INS_LDA_INDX]    = { &LoadRegister<A, INDX>, 6, 2 };
+        Table[CPU::INS_LDA_INDY]    = { &LoadRegister<A, INDY>, 5, 2 };
+        Table[CPU::INS_LDX_IM]      = { &LoadRegister<X, IM>, 2, 2 };
+        Table[CPU::INS_LDX_ZP]      = { &LoadRegister<X, ZP>, 3, 2 };
+        Table[CPU::INS_LDX_ZPY]     = { &LoadRegister<X, ZPY>, 4, 2 };
+        Table[CPU::INS_LDX_ABS]     = { &LoadRegister<X, ABS>, 4, 3 };
+        Table[CPU::INS_LDX_ABSY]    = { &LoadRegister<X, ABSY>, 4, 3 };
+        Table[CPU::INS_LDY_IM]      = { &LoadRegister<Y, IM>, 2, 2 };
+        Table[CPU::INS_LDY_ZP]      = { &LoadRegister<Y, ZP>, 3, 2 };
+        Table[CPU::INS_LDY_ZPX]     = { &LoadRegister<Y, ZPX>, 4, 2 };
+        Table[CPU::INS_LDY_ABS]     = { &LoadRegister<Y, ABS>, 4, 3 };
+        Table[CPU::INS_LDY_ABSX]    = { &LoadRegister<Y, ABSX>, 4, 3 };
+        Table[CPU::INS_STA_ZP]      = { &StoreRegister<A, ZP>, 3, 2 };
+        Table[CPU::INS_STA_ZPX]     = { &StoreRegister<A, ZPX>, 4, 2 };
+        Table[CPU::INS_STA_ABS]     = { &StoreRegister<A, ABS>, 4, 3 };
+        Table[CPU::INS_STA_ABSX]    = { &StoreRegister<A, ABSX_5>, 5, 3 };
+        Table[CPU::INS_STA_ABSY]    = { &StoreRegister<A, ABSY_5>, 5, 3 };
+        Table[CPU::INS_STA_INDX]    = { &StoreRegister<A, INDX>, 6, 2 };
+        Table[CPU::INS_STA_INDY]    = { &StoreRegister<A, INDY_5>, 6, 2 };
+        Table[CPU::INS_STX_ZP]      = { &StoreRegister<X, ZP>, 3, 2 };
+        Table[CPU::INS_STX_ZPY]     = { &StoreRegister<X, ZPY>, 4, 2 };
+        Table[CPU::INS_STX_ABS]     = { &StoreRegister<X, ABS>, 4, 3 };
+        Table[CPU::INS_STY_ZP]      = { &StoreRegister<Y, ZP>, 3, 2 };
+        Table[CPU::INS_STY_ZPX]     = { &StoreRegister<Y, ZPX>, 4, 2 };
+        Table[CPU::INS_STY_ABS]     = { &StoreRegister<Y, ABS>, 4, 3 };
+
+        // Stack Operations
+        Table[CPU::INS_TSX]         = { &Transfer<SP, X>, 2, 1 };
+        Table[CPU::INS_TXS]         = { &TXS, 2, 1 };
+        Table[CPU::INS_PHA]         = { &PHA, 3, 1 };
+        Table[CPU::INS_PHP]         = { &PHP, 3, 1 };
+        Table[CPU::INS_PLA]         = { &PLA, 4, 1 };
+        Table[CPU::INS_PLP]         = { &PLP, 4, 1 };
+
+        // Jumps & Calls
+        Table[CPU::INS_JMP_ABS]     = { &JMPAbsolute, 3, 3 };
+        Table[CPU::INS_JMP_IND]     = { &JMPIndirect, 5, 3 };
+        Table[CPU::INS_JSR]         = { &JSR, 6, 3 };
+        Table[CPU::INS_RTS]         = { &RTS, 6, 1 };
+
+        // Logical Ops
+        Table[CPU::INS_AND_IM]      = { &And<IM>, 2, 2 };
+        Table[CPU::INS_AND_ZP]      = { &And<ZP>, 3, 2 };
+        Table[CPU::INS_AND_ZPX]     = { &And<ZPX>, 4, 2 };
+        Table[CPU::INS_AND_ABS]     = { &And<ABS>, 4, 3 };
+        Table[CPU::INS_AND_ABSX]    = { &And<ABSX>, 4, 3 };
+        Table[CPU::INS_AND_ABSY]    = { &And<ABSY>, 4, 3 };
+        Table[CPU::INS_AND_INDX]    = { &And<INDX>, 6, 2 };
+        Table[CPU::INS_AND_INDY]    = { &And<INDY>, 5, 2 };
+        Table[CPU::INS_ORA_IM]      = { &Ora<IM>, 2, 2 };
+        Table[CPU::INS_ORA_ZP]      = { &Ora<ZP>, 3, 2 };
+        Table[CPU::INS_ORA_ZPX]     = { &Ora<ZPX>, 4, 2 };
+        Table[CPU::INS_ORA_ABS]     = { &Ora<ABS>, 4, 3 };
+        Table[CPU::INS_ORA_ABSX]    = { &Ora<ABSX>, 4, 3 };
+        Table[CPU::INS_ORA_ABSY]    = { &Ora<ABSY>, 4, 3 };
+        Table[CPU::INS_ORA_INDX]    = { &Ora<INDX>, 6, 2 };
+        Table[CPU::INS_ORA_INDY]    = { &Ora<INDY>, 5, 2 };
+        Table[CPU::INS_EOR_IM]      = { &Eor<IM>, 2, 2 };
+        Table[CPU::INS_EOR_ZP]      = { &Eor<ZP>, 3, 2 };
+        Table[CPU::INS_EOR_ZPX]     = { &Eor<ZPX>, 4, 2 };
+        Table[CPU::INS_EOR_ABS]     = { &Eor<ABS>, 4, 3 };
+        Table[CPU::INS_EOR_ABSX]    = { &Eor<ABSX>, 4, 3 };
+        Table[CPU::INS_EOR_ABSY]    = { &Eor<ABSY>, 4, 3 };
+        Table[CPU::INS_EOR_INDX]    = { &Eor<INDX>, 6, 2 };
+        Table[CPU::INS_EOR_INDY]    = { &Eor<INDY>, 5, 2 };
+        Table[CPU::INS_BIT_ZP]      = { &Bit<ZP>, 3, 2 };
+        Table[CPU::INS_BIT_ABS]     = { &Bit<ABS>, 4, 3 };
+
+        // Transfer Registers
+        Table[CPU::INS_TAX]         = { &Transfer<A, X>, 2, 1 };
+        Table[CPU::INS_TAY]         = { &Transfer<A, Y>, 2, 1 };
+        Table[CPU::INS_TXA]         = { &Transfer<X, A>, 2, 1 };
+        Table[CPU::INS_TYA]         = { &Transfer<Y, A>, 2, 1 };
+
+        // Increment & Decrement
+        Table[CPU::INS_INX]         = { &IncrementRegister<+1, X>, 2, 1 };
+        Table[CPU::INS_INY]         = { &IncrementRegister<+1, Y>, 2, 1 };
+        Table[CPU::INS_DEX]         = { &IncrementRegister<-1, X>, 2, 1 };
+        Table[CPU::INS_DEY]         = { &IncrementRegister<-1, Y>, 2, 1 };
+        Table[CPU::INS_DEC_ZP]      = { &IncrementMemory<-1, ZP>, 5, 2 };
+        Table[CPU::INS_DEC_ZPX]     = { &IncrementMemory<-1, ZPX>, 6, 2 };
+        Table[CPU::INS_DEC_ABS]     = { &IncrementMemory<-1, ABS>, 6, 3 };
+        Table[CPU::INS_DEC_ABSX]    = { &IncrementMemory<-1, ABSX_5>, 7, 3 };
+        Table[CPU::INS_INC_ZP]      = { &IncrementMemory<+1, ZP>, 5, 2 };
+        Table[CPU::INS_INC_ZPX]     = { &IncrementMemory<+1, ZPX>, 6, 2 };
+        Table[CPU::INS_INC_ABS]     = { &IncrementMemory<+1, ABS>, 6, 3 };
+        Table[CPU::INS_INC_ABSX]    = { &IncrementMemory<+1, ABSX_5>, 7, 3 };
+
+        // Branching
+        Table[CPU::INS_BEQ]         = { &BranchIf<CPU::ZeroFlagBit, true>, 2, 2 };
+        Table[CPU::INS_BNE]         = { &BranchIf<CPU::ZeroFlagBit, false>, 2, 2 };
+        Table[CPU::INS_BCS]         = { &BranchIf<CPU::CarryFlagBit, true>, 2, 2 };
+        Table[CPU::INS_BCC]         = { &BranchIf<CPU::CarryFlagBit, false>, 2, 2 };
+        Table[CPU::INS_BMI]         = { &BranchIf<CPU::NegativeFlagBit, true>, 2, 2 };
+        Table[CPU::INS_BPL]         = { &BranchIf<CPU::NegativeFlagBit, false>, 2, 2 };
+        Table[CPU::INS_BVS]         = { &BranchIf<CPU::OverflowFlagBit, true>, 2, 2 };
+        Table[CPU::INS_BVC]         = { &BranchIf<CPU::OverflowFlagBit, false>, 2, 2 };
+
+        // Status Flags Changes
+        Table[CPU::INS_CLC]         = { &SetFlag<CPU::CarryFlagBit, false>, 2, 1 };
+        Table[CPU::INS_SEC]         = { &SetFlag<CPU::CarryFlagBit, true>, 2, 1 };
+        Table[CPU::INS_CLD]         = { &SetFlag<CPU::DecimalModeFlagBit, false>, 2, 1 };
+        Table[CPU::INS_SED]         = { &SetFlag<CPU::DecimalModeFlagBit, true>, 2, 1 };
+        Table[CPU::INS_CLI]         = { &SetFlag<CPU::InterruptDisableFlagBit, false>, 2, 1 };
+        Table[CPU::INS_SEI]         = { &SetFlag<CPU::InterruptDisableFlagBit, true>, 2, 1 };
+        Table[CPU::INS_CLV]         = { &SetFlag<CPU::OverflowFlagBit, false>, 2, 1 };
+
+        // Arithmetic
+        Table[CPU::INS_ADC_IM]      = { &ADC<IM>, 2, 2 };
+        Table[CPU::INS_ADC_ZP]      = { &ADC<ZP>, 3, 2 };
+        Table[CPU::INS_ADC_ZPX]     = { &ADC<ZPX>, 4, 2 };
+        Table[CPU::INS_ADC_ABS]     = { &ADC<ABS>, 4, 3 };
+        Table[CPU::INS_ADC_ABSX]    = { &ADC<ABSX>, 4, 3 };
+        Table[CPU::INS_ADC_ABSY]    = { &ADC<ABSY>, 4, 3 };
+        Table[CPU::INS_ADC_INDX]    = { &ADC<INDX>, 6, 2 };
+        Table[CPU::INS_ADC_INDY]    = { &ADC<INDY>, 5, 2 };
+        Table[CPU::INS_SBC_IM]      = { &SBC<IM>, 2, 2 };
+        Table[CPU::INS_SBC_ZP]      = { &SBC<ZP>, 3, 2 };
+        Table[CPU::INS_SBC_ZPX]     = { &SBC<ZPX>, 4, 2 };
+        Table[CPU::INS_SBC_ABS]     = { &SBC<ABS>, 4, 3 };
+        Table[CPU::INS_SBC_ABSX]    = { &SBC<ABSX>, 4, 3 };
+        Table[CPU::INS_SBC_ABSY]    = { &SBC<ABSY>, 4, 3 };
+        Table[CPU::INS_SBC_INDX]    = { &SBC<INDX>, 6, 2 };
+        Table[CPU::INS_SBC_INDY]    = { &SBC<INDY>, 5, 2 };
+
+        // Register Comparison
+        Table[CPU::INS_CMP_IM]      = { &Compare<A, IM>, 2, 2 };
+        Table[CPU::INS_CMP_ZP]      = { &Compare<A, ZP>, 3, 2 };
+        Table[CPU::INS_CMP_ZPX]     = { &Compare<A, ZPX>, 4, 2 };
+        Table[CPU::INS_CMP_ABS]     = { &Compare<A, ABS>, 4, 3 };
+        Table[CPU::INS_CMP_ABSX]    = { &Compare<A, ABSX>, 4, 3 };
+        Table[CPU::INS_CMP_ABSY]    = { &Compare<A, ABSY>, 4, 3 };
+        Table[CPU::INS_CMP_INDX]    = { &Compare<A, INDX>, 6, 2 };
+        Table[CPU::INS_CMP_INDY]    = { &Compare<A, INDY>, 5, 2 };
+        Table[CPU::INS_CPX_IM]      = { &Compare<X, IM>, 2, 2 };
+        Table[CPU::INS_CPX_ZP]      = { &Compare<X, ZP>, 3, 2 };
+        Table[CPU::INS_CPX_ABS]     = { &Compare<X, ABS>, 4, 3 };
+        Table[CPU::INS_CPY_IM]      = { &Compare<Y, IM>, 2, 2 };
+        Table[CPU::INS_CPY_ZP]      = { &Compare<Y, ZP>, 3, 2 };
+        Table[CPU::INS_CPY_ABS]     = { &Compare<Y, ABS>, 4, 3 };
+
+        // Shifts
+        Table[CPU::INS_ASL]         = { &ShiftAccumulator<&ASL>, 2, 1 };
+        Table[CPU::INS_ASL_ZP]      = { &ShiftMemory<&ASL, ZP>, 5, 2 };
+        Table[CPU::INS_ASL_ZPX]     = { &ShiftMemory<&ASL, ZPX>, 6, 2 };
+        Table[CPU::INS_ASL_ABS]     = { &ShiftMemory<&ASL, ABS>, 6, 3 };
+        Table[CPU::INS_ASL_ABSX]    = { &ShiftMemory<&ASL, ABSX_5>, 7, 3 };
+        Table[CPU::INS_LSR]         = { &ShiftAccumulator<&LSR>, 2, 1 };
+        Table[CPU::INS_LSR_ZP]      = { &ShiftMemory<&LSR, ZP>, 5, 2 };
+        Table[CPU::INS_LSR_ZPX]     = { &ShiftMemory<&LSR, ZPX>, 6, 2 };
+        Table[CPU::INS_LSR_ABS]     = { &ShiftMemory<&LSR, ABS>, 6, 3 };
+        Table[CPU::INS_LSR_ABSX]    = { &ShiftMemory<&LSR, ABSX_5>, 7, 3 };
+        Table[CPU::INS_ROL]         = { &ShiftAccumulator<&ROL>, 2, 1 };
+        Table[CPU::INS_ROL_ZP]      = { &ShiftMemory<&ROL, ZP>, 5, 2 };
+        Table[CPU::INS_ROL_ZPX]     = { &ShiftMemory<&ROL, ZPX>, 6, 2 };
+        Table[CPU::INS_ROL_ABS]     = { &ShiftMemory<&ROL, ABS>, 6, 3 };
+        Table[CPU::INS_ROL_ABSX]    = { &ShiftMemory<&ROL, ABSX_5>, 7, 3 };
+        Table[CPU::INS_ROR]         = { &ShiftAccumulator<&ROR>, 2, 1 };
+        Table[CPU::INS_ROR_ZP]      = { &ShiftMemory<&ROR, ZP>, 5, 2 };
+        Table[CPU::INS_ROR_ZPX]     = { &ShiftMemory<&ROR, ZPX>, 6, 2 };
+        Table[CPU::INS_ROR_ABS]     = { &ShiftMemory<&ROR, ABS>, 6, 3 };
+        Table[CPU::INS_ROR_ABSX]    = { &ShiftMemory<&ROR, ABSX_5>, 7, 3 };
+
+        // System Functions
+        Table[CPU::INS_NOP]         = { &NOP, 2, 1 };
+        Table[CPU::INS_BRK]         = { &BRK, 7, 1 };
+        Table[CPU::INS_RTI]         = { &RTI, 6, 1 };
+
+        return Table;
+    }
+
+    inline constexpr DispatchTable Dispatch = MakeDispatchTable();
+
+    constexpr u32 NO_FOLLOWER = 0x100;
+    using FollowerTable = std::array<u32, 256>;
+
+    /* Superinstructions: the opcode CPU::Interpret runs straight after each
+    *  opcode, when it is the one that comes next, without going back through
+    *  dispatch. Both still run through their own handlers with the cycle
+    *  budget and pending events checked in between, so nothing but the
+    *  dispatch changes. NO_FOLLOWER for none.
+    *  The pairs come from the M6502_FUSED_PAIRS header (see PairProfile) */
+    constexpr FollowerTable MakeFollowerTable()
+    {
+        FollowerTable Table{};
+        for ( u32& Follower : Table )
+        {
+            Follower = NO_FOLLOWER;
+        }
+#if defined( M6502_FUSED_PAIRS )
+    #define M6502_FUSED_PAIR( First, Second ) Table[First] = Second;
+    #include M6502_FUSED_PAIRS
+    #undef M6502_FUSED_PAIR
+#endif
+        return Table;
+    }
+
+    inline constexpr FollowerTable Followers = MakeFollowerTable();
+
+    /* @return true if the opcode can continue anywhere other than the next
+    *  instruction - branches, jumps, calls, returns, BRK and illegal opcodes */
+    inline bool IsControlFlow( Byte Opcode )
+    {
+        switch ( Opcode )
+        {
+            case CPU::INS_BEQ: case CPU::INS_BNE: case CPU::INS_BCS: case CPU::INS_BCC:
+            case CPU::INS_BMI: case CPU::INS_BPL: case CPU::INS_BVS: case CPU::INS_BVC:
+            case CPU::INS_JMP_ABS: case CPU::INS_JMP_IND: case CPU::INS_JSR:
+            case CPU::INS_RTS: case CPU::INS_RTI: case CPU::INS_BRK:
+                return true;
+            default:
+                return Dispatch[Opcode].Execute == &IllegalOpcode;
+        }
+    }
+}}
+
+/* Expands Op( 0x00 ) ... Op( 0xFF ), one per opcode. Used to give every opcode
+*  its own dispatch site with a constant index into the DispatchTable so the
+*  compiler can inline the handler instead of calling through the pointer. */
+#define M6502_OPCODE_ROW( Op, Hi ) \
+    Op( 0x##Hi##0 ) Op( 0x##Hi##1 ) Op( 0x##Hi##2 ) Op( 0x##Hi##3 ) \
+    Op( 0x##Hi##4 ) Op( 0x##Hi##5 ) Op( 0x##Hi##6 ) Op( 0x##Hi##7 ) \
+    Op( 0x##Hi##8 ) Op( 0x##Hi##9 ) Op( 0x##Hi##A ) Op( 0x##Hi##B ) \
+    Op( 0x##Hi##C ) Op( 0x##Hi##D ) Op( 0x##Hi##E ) Op( 0x##Hi##F )
+
+#define M6502_FOR_EACH_OPCODE( Op ) \
+    M6502_OPCODE_ROW( Op, 0 ) M6502_OPCODE_ROW( Op, 1 ) M6502_OPCODE_ROW( Op, 2 ) M6502_OPCODE_ROW( Op, 3 ) \
+    M6502_OPCODE_ROW( Op, 4 ) M6502_OPCODE_ROW( Op, 5 ) M6502_OPCODE_ROW( Op, 6 ) M6502_OPCODE_ROW( Op, 7 ) \
+    M6502_OPCODE_ROW( Op, 8 ) M6502_OPCODE_ROW( Op, 9 ) M6502_OPCODE_ROW( Op, A ) M6502_OPCODE_ROW( Op, B ) \
+    M6502_OPCODE_ROW( Op, C ) M6502_OPCODE_ROW( Op, D ) M6502_OPCODE_ROW( Op, E ) M6502_OPCODE_ROW( Op, F )
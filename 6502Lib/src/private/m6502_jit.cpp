@@ -0,0 +1,1589 @@
+#include "m6502_jit.h"
+
+#if defined( M6502_JIT )
+
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+
+#if defined( _WIN32 )
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "m6502_breakpoints.h"
+#include "m6502_instructions.h"
+
+namespace
+{
+    using namespace m6502;
+
+    enum HostReg : int { RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13 };
+
+    // Where things live while a block runs. All 6502 registers are kept zero
+    // extended in the low byte of their host register.
+    constexpr int CPUReg = RDI, MemReg = RSI;
+    constexpr int RegA = R8, RegX = R9, RegY = R10, RegSP = R11, RegPS = RDX;
+    constexpr int CyclesLeft = RBX;         // Counts down as instructions complete
+    constexpr int EntryTable = R12;         // Jit::Entries, to chain to the next block
+    constexpr int CodeMap = R13;            // Jit::CodeBytes, to spot stores to translated code
+    constexpr int Temp = RBP;               // RAX and RCX are the other scratch registers
+
+    constexpr s32 StackBase = 0x100;
+
+    enum AluOp : Byte { ALU_ADD = 0, ALU_OR = 1, ALU_ADC = 2, ALU_SBB = 3, ALU_AND = 4, ALU_SUB = 5, ALU_XOR = 6, ALU_CMP = 7 };
+    enum ShiftOp : Byte { SHIFT_LEFT = 4, SHIFT_RIGHT = 5 };
+    enum Condition : Byte { IF_ZERO = 0x4, IF_NOT_ZERO = 0x5, IF_LESS_OR_EQUAL = 0xE };
+
+    /* Just enough of an x86-64 assembler for the translator. 32-bit operations
+    *  only, memory operands are always [Base + Index + disp32] */
+    class Emitter {
+    public:
+        std::vector<Byte> Code;
+
+        u32 Size() const {
+            return (u32)Code.size();
+        }
+
+        void Emit( Byte Value ) {
+            Code.push_back( Value );
+        }
+
+        void Emit32( u32 Value ) {
+            for ( u32 i = 0; i < 4; i++ )
+            {
+                Emit( (Byte)(Value >> (i * 8)) );
+            }
+        }
+
+        void Rex( bool Wide, int Reg, int Index, int Base, bool ByteReg = false ) {
+            const Byte Prefix = 0x40 | (Wide << 3) | ((Reg >> 3) << 2) | ((Index >> 3) << 1) | (Base >> 3);
+            // sil/dil/spl/bpl need a REX prefix to be addressed as bytes
+            if ( Prefix != 0x40 || ( ByteReg && Reg >= RSP && Reg <= RDI ) )
+            {
+                Emit( Prefix );
+            }
+        }
+
+        /* Opcode Reg, Rm with both operands registers */
+        void RegReg( std::initializer_list<Byte> Opcode, int Reg, int Rm, bool Wide = false ) {
+            Rex( Wide, Reg, 0, Rm );
+            for ( Byte Op : Opcode )
+            {
+                Emit( Op );
+            }
+            Emit( 0xC0 | ((Reg & 7) << 3) | (Rm & 7) );
+        }
+
+        /* Opcode Reg, [Base + Index + Disp], Index < 0 for none */
+        void RegMem( std::initializer_list<Byte> Opcode, int Reg, int Base, int Index, s32 Disp, bool ByteReg = false, bool Wide = false ) {
+            Rex( Wide, Reg, Index < 0 ? 0 : Index, Base, ByteReg );
+            for ( Byte Op : Opcode )
+            {
+                Emit( Op );
+            }
+            if ( Index < 0 && (Base & 7) == RSP )
+            {
+                // RSP/R12 as a base can only be encoded with a SIB byte
+                Emit( 0x80 | ((Reg & 7) << 3) | 4 );
+                Emit( 0x24 );
+            }
+            else if ( Index < 0 )
+            {
+                Emit( 0x80 | ((Reg & 7) << 3) | (Base & 7) );
+            }
+            else
+            {
+                Emit( 0x80 | ((Reg & 7) << 3) | 4 );
+                Emit( ((Index & 7) << 3) | (Base & 7) );
+            }
+            Emit32( (u32)Disp );
+        }
+
+        void Mov( int Dst, int Src ) {
+            RegReg( { 0x89 }, Src, Dst );
+        }
+
+        void Mov64( int Dst, int Src ) {
+            RegReg( { 0x89 }, Src, Dst, true );
+        }
+
+        void MovImm64( int Dst, const void* Imm ) {
+            Rex( true, 0, 0, Dst );
+            Emit( 0xB8 + (Dst & 7) );
+            const unsigned long long Value = (unsigned long long)Imm;
+            Emit32( (u32)Value );
+            Emit32( (u32)(Value >> 32) );
+        }
+
+        void MovImm( int Dst, u32 Imm ) {
+            Rex( false, 0, 0, Dst );
+            Emit( 0xB8 + (Dst & 7) );
+            Emit32( Imm );
+        }
+
+        void Alu( AluOp Op, int Dst, int Src ) {
+            RegReg( { (Byte)((Op << 3) | 1) }, Src, Dst );
+        }
+
+        void AluImm( AluOp Op, int Dst, s32 Imm ) {
+            Rex( false, 0, 0, Dst );
+            const bool IsShort = Imm >= -128 && Imm <= 127;
+            Emit( IsShort ? 0x83 : 0x81 );
+            Emit( 0xC0 | (Op << 3) | (Dst & 7) );
+            if ( IsShort )
+            {
+                Emit( (Byte)Imm );
+            }
+            else
+            {
+                Emit32( (u32)Imm );
+            }
+        }
+
+        void Shift( ShiftOp Op, int Dst, Byte Count ) {
+            Rex( false, 0, 0, Dst );
+            Emit( 0xC1 );
+            Emit( 0xC0 | (Op << 3) | (Dst & 7) );
+            Emit( Count );
+        }
+
+        /* Copy bit Bit of Reg into the host carry flag */
+        void BitTest( int Reg, Byte Bit ) {
+            Rex( false, 0, 0, Reg );
+            Emit( 0x0F );
+            Emit( 0xBA );
+            Emit( 0xC0 | (4 << 3) | (Reg & 7) );
+            Emit( Bit );
+        }
+
+        void Test( int Reg, u32 Imm ) {
+            Rex( false, 0, 0, Reg );
+            Emit( 0xF7 );
+            Emit( 0xC0 | (Reg & 7) );
+            Emit32( Imm );
+        }
+
+        /* Complement the host carry flag */
+        void Cmc() {
+            Emit( 0xF5 );
+        }
+
+        void Load64( int Dst, int Base, int Index, s32 Disp ) {
+            RegMem( { 0x8B }, Dst, Base, Index, Disp, false, true );
+        }
+
+        /* cmp Reg, dword [Base + Index + Disp] */
+        void CompareMem( int Reg, int Base, int Index, s32 Disp ) {
+            RegMem( { 0x3B }, Reg, Base, Index, Disp );
+        }
+
+        void LoadByte( int Dst, int Base, int Index, s32 Disp ) {
+            RegMem( { 0x0F, 0xB6 }, Dst, Base, Index, Disp );
+        }
+
+        void StoreByte( int Src, int Base, int Index, s32 Disp ) {
+            RegMem( { 0x88 }, Src, Base, Index, Disp, true );
+        }
+
+        void StoreWord( int Src, int Base, s32 Disp ) {
+            Emit( 0x66 );
+            RegMem( { 0x89 }, Src, Base, -1, Disp );
+        }
+
+        void StoreByteImm( int Base, int Index, s32 Disp, Byte Imm ) {
+            RegMem( { 0xC6 }, 0, Base, Index, Disp );
+            Emit( Imm );
+        }
+
+        void CompareByteImm( int Base, int Index, s32 Disp, Byte Imm ) {
+            RegMem( { 0x80 }, 7, Base, Index, Disp );
+            Emit( Imm );
+        }
+
+        void Push( int Reg ) {
+            Rex( false, 0, 0, Reg );
+            Emit( 0x50 + (Reg & 7) );
+        }
+
+        void Pop( int Reg ) {
+            Rex( false, 0, 0, Reg );
+            Emit( 0x58 + (Reg & 7) );
+        }
+
+        void JumpTo( int Reg ) {
+            Rex( false, 0, 0, Reg );
+            Emit( 0xFF );
+            Emit( 0xC0 | (4 << 3) | (Reg & 7) );
+        }
+
+        void Ret() {
+            Emit( 0xC3 );
+        }
+
+        /* @return where to Bind the jump's target */
+        u32 Jump() {
+            Emit( 0xE9 );
+            Emit32( 0 );
+            return Size() - 4;
+        }
+
+        u32 JumpIf( Condition Cond ) {
+            Emit( 0x0F );
+            Emit( 0x80 | Cond );
+            Emit32( 0 );
+            return Size() - 4;
+        }
+
+        /* Point the jump at the current position */
+        void Bind( u32 JumpOperand ) {
+            const u32 Relative = Size() - (JumpOperand + 4);
+            memcpy( &Code[JumpOperand], &Relative, 4 );
+        }
+    };
+
+    enum class Kind {
+        Unsupported,
+        Load, Store, And, Ora, Eor, Bit, Adc, Sbc, Compare,
+        Asl, Lsr, Rol, Ror, Increment, Decrement,
+        IncrementRegister, DecrementRegister, Transfer, TXS, SetFlag, ClearFlag, NOP,
+        PHA, PHP, PLA, PLP,
+        Branch, Jump, JSR, RTS
+    };
+
+    enum class Mode {
+        Implied, Immediate, ZeroPage, ZeroPageX, ZeroPageY, Absolute, AbsoluteX, AbsoluteY, IndirectX, IndirectY
+    };
+
+    /* What the translator needs to know about an opcode */
+    struct OpInfo {
+        Kind Op = Kind::Unsupported;
+        Mode Addressing = Mode::Implied;
+        int Reg = 0;                // Load/Store/Compare/Increment register, Transfer source
+        int To = 0;                 // Transfer destination
+        Byte FlagBit = 0;           // SetFlag/ClearFlag/Branch
+        bool Expected = false;      // Branch taken when the flag is this
+    };
+
+    OpInfo Describe( Byte Opcode )
+    {
+        auto Make = []( Kind Op, Mode Addressing = Mode::Implied, int Reg = 0 )
+        {
+            OpInfo Info;
+            Info.Op = Op;
+            Info.Addressing = Addressing;
+            Info.Reg = Reg;
+            return Info;
+        };
+        auto Transfer = []( int From, int To )
+        {
+            OpInfo Info;
+            Info.Op = Kind::Transfer;
+            Info.Reg = From;
+            Info.To = To;
+            return Info;
+        };
+        auto Flag = []( Kind Op, Byte FlagBit, bool Expected = false )
+        {
+            OpInfo Info;
+            Info.Op = Op;
+            Info.FlagBit = FlagBit;
+            Info.Expected = Expected;
+            return Info;
+        };
+
+        switch ( Opcode )
+        {
+            case CPU::INS_LDA_IM:   return Make( Kind::Load, Mode::Immediate, RegA );
+            case CPU::INS_LDA_ZP:   return Make( Kind::Load, Mode::ZeroPage, RegA );
+            case CPU::INS_LDA_ZPX:  return Make( Kind::Load, Mode::ZeroPageX, RegA );
+            case CPU::INS_LDA_ABS:  return Make( Kind::Load, Mode::Absolute, RegA );
+            case CPU::INS_LDA_ABSX: return Make( Kind::Load, Mode::AbsoluteX, RegA );
+            case CPU::INS_LDA_ABSY: return Make( Kind::Load, Mode::AbsoluteY, RegA );
+            case CPU::INS_LDA_INDX: return Make( Kind::Load, Mode::IndirectX, RegA );
+            case CPU::INS_LDA_INDY: return Make( Kind::Load, Mode::IndirectY, RegA );
+            case CPU::INS_LDX_IM:   return Make( Kind::Load, Mode::Immediate, RegX );
+            case CPU::INS_LDX_ZP:   return Make( Kind::Load, Mode::ZeroPage, RegX );
+            case CPU::INS_LDX_ZPY:  return Make( Kind::Load, Mode::ZeroPageY, RegX );
+            case CPU::INS_LDX_ABS:  return Make( Kind::Load, Mode::Absolute, RegX );
+            case CPU::INS_LDX_ABSY: return Make( Kind::Load, Mode::AbsoluteY, RegX );
+            case CPU::INS_LDY_IM:   return Make( Kind::Load, Mode::Immediate, RegY );
+            case CPU::INS_LDY_ZP:   return Make( Kind::Load, Mode::ZeroPage, RegY );
+            case CPU::INS_LDY_ZPX:  return Make( Kind::Load, Mode::ZeroPageX, RegY );
+            case CPU::INS_LDY_ABS:  return Make( Kind::Load, Mode::Absolute, RegY );
+            case CPU::INS_LDY_ABSX: return Make( Kind::Load, Mode::AbsoluteX, RegY );
+
+            case CPU::INS_STA_ZP:   return Make( Kind::Store, Mode::ZeroPage, RegA );
+            case CPU::INS_STA_ZPX:  return Make( Kind::Store, Mode::ZeroPageX, RegA );
+            case CPU::INS_STA_ABS:  return Make( Kind::Store, Mode::Absolute, RegA );
+            case CPU::INS_STA_ABSX: return Make( Kind::Store, Mode::AbsoluteX, RegA );
+            case CPU::INS_STA_ABSY: return Make( Kind::Store, Mode::AbsoluteY, RegA );
+            case CPU::INS_STA_INDX: return Make( Kind::Store, Mode::IndirectX, RegA );
+            case CPU::INS_STA_INDY: return Make( Kind::Store, Mode::IndirectY, RegA );
+            case CPU::INS_STX_ZP:   return Make( Kind::Store, Mode::ZeroPage, RegX );
+            case CPU::INS_STX_ZPY:  return Make( Kind::Store, Mode::ZeroPageY, RegX );
+            case CPU::INS_STX_ABS:  return Make( Kind::Store, Mode::Absolute, RegX );
+            case CPU::INS_STY_ZP:   return Make( Kind::Store, Mode::ZeroPage, RegY );
+            case CPU::INS_STY_ZPX:  return Make( Kind::Store, Mode::ZeroPageX, RegY );
+            case CPU::INS_STY_ABS:  return Make( Kind::Store, Mode::Absolute, RegY );
+
+            case CPU::INS_AND_IM:   return Make( Kind::And, Mode::Immediate );
+            case CPU::INS_AND_ZP:   return Make( Kind::And, Mode::ZeroPage );
+            case CPU::INS_AND_ZPX:  return Make( Kind::And, Mode::ZeroPageX );
+            case CPU::INS_AND_ABS:  return Make( Kind::And, Mode::Absolute );
+            case CPU::INS_AND_ABSX: return Make( Kind::And, Mode::AbsoluteX );
+            case CPU::INS_AND_ABSY: return Make( Kind::And, Mode::AbsoluteY );
+            case CPU::INS_AND_INDX: return Make( Kind::And, Mode::IndirectX );
+            case CPU::INS_AND_INDY: return Make( Kind::And, Mode::IndirectY );
+            case CPU::INS_ORA_IM:   return Make( Kind::Ora, Mode::Immediate );
+            case CPU::INS_ORA_ZP:   return Make( Kind::Ora, Mode::ZeroPage );
+            case CPU::INS_ORA_ZPX:  return Make( Kind::Ora, Mode::ZeroPageX );
+            case CPU::INS_ORA_ABS:  return Make( Kind::Ora, Mode::Absolute );
+            case CPU::INS_ORA_ABSX: return Make( Kind::Ora, Mode::AbsoluteX );
+            case CPU::INS_ORA_ABSY: return Make( Kind::Ora, Mode::AbsoluteY );
+            case CPU::INS_ORA_INDX: return Make( Kind::Ora, Mode::IndirectX );
+            case CPU::INS_ORA_INDY: return Make( Kind::Ora, Mode::IndirectY );
+            case CPU::INS_EOR_IM:   return Make( Kind::Eor, Mode::Immediate );
+            case CPU::INS_EOR_ZP:   return Make( Kind::Eor, Mode::ZeroPage );
+            case CPU::INS_EOR_ZPX:  return Make( Kind::Eor, Mode::ZeroPageX );
+            case CPU::INS_EOR_ABS:  return Make( Kind::Eor, Mode::Absolute );
+            case CPU::INS_EOR_ABSX: return Make( Kind::Eor, Mode::AbsoluteX );
+            case CPU::INS_EOR_ABSY: return Make( Kind::Eor, Mode::AbsoluteY );
+            case CPU::INS_EOR_INDX: return Make( Kind::Eor, Mode::IndirectX );
+            case CPU::INS_EOR_INDY: return Make( Kind::Eor, Mode::IndirectY );
+            case CPU::INS_BIT_ZP:   return Make( Kind::Bit, Mode::ZeroPage );
+            case CPU::INS_BIT_ABS:  return Make( Kind::Bit, Mode::Absolute );
+
+            case CPU::INS_ADC_IM:   return Make( Kind::Adc, Mode::Immediate );
+            case CPU::INS_ADC_ZP:   return Make( Kind::Adc, Mode::ZeroPage );
+            case CPU::INS_ADC_ZPX:  return Make( Kind::Adc, Mode::ZeroPageX );
+            case CPU::INS_ADC_ABS:  return Make( Kind::Adc, Mode::Absolute );
+            case CPU::INS_ADC_ABSX: return Make( Kind::Adc, Mode::AbsoluteX );
+            case CPU::INS_ADC_ABSY: return Make( Kind::Adc, Mode::AbsoluteY );
+            case CPU::INS_ADC_INDX: return Make( Kind::Adc, Mode::IndirectX );
+            case CPU::INS_ADC_INDY: return Make( Kind::Adc, Mode::IndirectY );
+            case CPU::INS_SBC_IM:   return Make( Kind::Sbc, Mode::Immediate );
+            case CPU::INS_SBC_ZP:   return Make( Kind::Sbc, Mode::ZeroPage );
+            case CPU::INS_SBC_ZPX:  return Make( Kind::Sbc, Mode::ZeroPageX );
+            case CPU::INS_SBC_ABS:  return Make( Kind::Sbc, Mode::Absolute );
+            case CPU::INS_SBC_ABSX: return Make( Kind::Sbc, Mode::AbsoluteX );
+            case CPU::INS_SBC_ABSY: return Make( Kind::Sbc, Mode::AbsoluteY );
+            case CPU::INS_SBC_INDX: return Make( Kind::Sbc, Mode::IndirectX );
+            case CPU::INS_SBC_INDY: return Make( Kind::Sbc, Mode::IndirectY );
+
+            case CPU::INS_CMP_IM:   return Make( Kind::Compare, Mode::Immediate, RegA );
+            case CPU::INS_CMP_ZP:   return Make( Kind::Compare, Mode::ZeroPage, RegA );
+            case CPU::INS_CMP_ZPX:  return Make( Kind::Compare, Mode::ZeroPageX, RegA );
+            case CPU::INS_CMP_ABS:  return Make( Kind::Compare, Mode::Absolute, RegA );
+            case CPU::INS_CMP_ABSX: return Make( Kind::Compare, Mode::AbsoluteX, RegA );
+            case CPU::INS_CMP_ABSY: return Make( Kind::Compare, Mode::AbsoluteY, RegA );
+            case CPU::INS_CMP_INDX: return Make( Kind::Compare, Mode::IndirectX, RegA );
+            case CPU::INS_CMP_INDY: return Make( Kind::Compare, Mode::IndirectY, RegA );
+            case CPU::INS_CPX_IM:   return Make( Kind::Compare, Mode::Immediate, RegX );
+            case CPU::INS_CPX_ZP:   return Make( Kind::Compare, Mode::ZeroPage, RegX );
+            case CPU::INS_CPX_ABS:  return Make( Kind::Compare, Mode::Absolute, RegX );
+            case CPU::INS_CPY_IM:   return Make( Kind::Compare, Mode::Immediate, RegY );
+            case CPU::INS_CPY_ZP:   return Make( Kind::Compare, Mode::ZeroPage, RegY );
+            case CPU::INS_CPY_ABS:  return Make( Kind::Compare, Mode::Absolute, RegY );
+
+            case CPU::INS_ASL:      return Make( Kind::Asl );
+            case CPU::INS_ASL_ZP:   return Make( Kind::Asl, Mode::ZeroPage );
+            case CPU::INS_ASL_ZPX:  return Make( Kind::Asl, Mode::ZeroPageX );
+            case CPU::INS_ASL_ABS:  return Make( Kind::Asl, Mode::Absolute );
+            case CPU::INS_ASL_ABSX: return Make( Kind::Asl, Mode::AbsoluteX );
+            case CPU::INS_LSR:      return Make( Kind::Lsr );
+            case CPU::INS_LSR_ZP:   return Make( Kind::Lsr, Mode::ZeroPage );
+            case CPU::INS_LSR_ZPX:  return Make( Kind::Lsr, Mode::ZeroPageX );
+            case CPU::INS_LSR_ABS:  return Make( Kind::Lsr, Mode::Absolute );
+            case CPU::INS_LSR_ABSX: return Make( Kind::Lsr, Mode::AbsoluteX );
+            case CPU::INS_ROL:      return Make( Kind::Rol );
+            case CPU::INS_ROL_ZP:   return Make( Kind::Rol, Mode::ZeroPage );
+            case CPU::INS_ROL_ZPX:  return Make( Kind::Rol, Mode::ZeroPageX );
+            case CPU::INS_ROL_ABS:  return Make( Kind::Rol, Mode::Absolute );
+            case CPU::INS_ROL_ABSX: return Make( Kind::Rol, Mode::AbsoluteX );
+            case CPU::INS_ROR:      return Make( Kind::Ror );
+            case CPU::INS_ROR_ZP:   return Make( Kind::Ror, Mode::ZeroPage );
+            case CPU::INS_ROR_ZPX:  return Make( Kind::Ror, Mode::ZeroPageX );
+            case CPU::INS_ROR_ABS:  return Make( Kind::Ror, Mode::Absolute );
+            case CPU::INS_ROR_ABSX: return Make( Kind::Ror, Mode::AbsoluteX );
+
+            case CPU::INS_INC_ZP:   return Make( Kind::Increment, Mode::ZeroPage );
+            case CPU::INS_INC_ZPX:  return Make( Kind::Increment, Mode::ZeroPageX );
+            case CPU::INS_INC_ABS:  return Make( Kind::Increment, Mode::Absolute );
+            case CPU::INS_INC_ABSX: return Make( Kind::Increment, Mode::AbsoluteX );
+            case CPU::INS_DEC_ZP:   return Make( Kind::Decrement, Mode::ZeroPage );
+            case CPU::INS_DEC_ZPX:  return Make( Kind::Decrement, Mode::ZeroPageX );
+            case CPU::INS_DEC_ABS:  return Make( Kind::Decrement, Mode::Absolute );
+            case CPU::INS_DEC_ABSX: return Make( Kind::Decrement, Mode::AbsoluteX );
+            case CPU::INS_INX:      return Make( Kind::IncrementRegister, Mode::Implied, RegX );
+            case CPU::INS_INY:      return Make( Kind::IncrementRegister, Mode::Implied, RegY );
+            case CPU::INS_DEX:      return Make( Kind::DecrementRegister, Mode::Implied, RegX );
+            case CPU::INS_DEY:      return Make( Kind::DecrementRegister, Mode::Implied, RegY );
+
+            case CPU::INS_TAX:      return Transfer( RegA, RegX );
+            case CPU::INS_TAY:      return Transfer( RegA, RegY );
+            case CPU::INS_TXA:      return Transfer( RegX, RegA );
+            case CPU::INS_TYA:      return Transfer( RegY, RegA );
+            case CPU::INS_TSX:      return Transfer( RegSP, RegX );
+            case CPU::INS_TXS:      return Make( Kind::TXS );
+
+            case CPU::INS_CLC:      return Flag( Kind::ClearFlag, CPU::CarryFlagBit );
+            case CPU::INS_SEC:      return Flag( Kind::SetFlag, CPU::CarryFlagBit );
+            case CPU::INS_CLD:      return Flag( Kind::ClearFlag, CPU::DecimalModeFlagBit );
+            case CPU::INS_SED:      return Flag( Kind::SetFlag, CPU::DecimalModeFlagBit );
+            case CPU::INS_CLI:      return Flag( Kind::ClearFlag, CPU::InterruptDisableFlagBit );
+            case CPU::INS_SEI:      return Flag( Kind::SetFlag, CPU::InterruptDisableFlagBit );
+            case CPU::INS_CLV:      return Flag( Kind::ClearFlag, CPU::OverflowFlagBit );
+            case CPU::INS_NOP:      return Make( Kind::NOP );
+
+            case CPU::INS_PHA:      return Make( Kind::PHA );
+            case CPU::INS_PHP:      return Make( Kind::PHP );
+            case CPU::INS_PLA:      return Make( Kind::PLA );
+            case CPU::INS_PLP:      return Make( Kind::PLP );
+
+            case CPU::INS_BEQ:      return Flag( Kind::Branch, CPU::ZeroFlagBit, true );
+            case CPU::INS_BNE:      return Flag( Kind::Branch, CPU::ZeroFlagBit, false );
+            case CPU::INS_BCS:      return Flag( Kind::Branch, CPU::CarryFlagBit, true );
+            case CPU::INS_BCC:      return Flag( Kind::Branch, CPU::CarryFlagBit, false );
+            case CPU::INS_BMI:      return Flag( Kind::Branch, CPU::NegativeFlagBit, true );
+            case CPU::INS_BPL:      return Flag( Kind::Branch, CPU::NegativeFlagBit, false );
+            case CPU::INS_BVS:      return Flag( Kind::Branch, CPU::OverflowFlagBit, true );
+            case CPU::INS_BVC:      return Flag( Kind::Branch, CPU::OverflowFlagBit, false );
+            case CPU::INS_JMP_ABS:  return Make( Kind::Jump );
+            case CPU::INS_JSR:      return Make( Kind::JSR );
+            case CPU::INS_RTS:      return Make( Kind::RTS );
+
+            // BRK, RTI, JMP (ind) and the illegal opcodes stay in the interpreter
+            default:                return OpInfo{};
+        }
+    }
+
+    /* @return true for the instructions that pay a cycle when indexing crosses
+    *  a page (the reads, stores and read-modify-writes always pay it) */
+    bool ChargesPageCross( const OpInfo& Info )
+    {
+        switch ( Info.Op )
+        {
+            case Kind::Load: case Kind::And: case Kind::Ora: case Kind::Eor:
+            case Kind::Adc: case Kind::Sbc: case Kind::Compare:
+                return Info.Addressing == Mode::AbsoluteX
+                    || Info.Addressing == Mode::AbsoluteY
+                    || Info.Addressing == Mode::IndirectY;
+            default:
+                return false;
+        }
+    }
+
+    /* @return the most cycles the instruction can take */
+    s32 MaxCycles( Byte Opcode, const OpInfo& Info )
+    {
+        const s32 Base = Instructions::Dispatch[Opcode].BaseCycles;
+        if ( Info.Op == Kind::Branch )
+        {
+            return Base + 2;
+        }
+        return Base + (ChargesPageCross( Info ) ? 1 : 0);
+    }
+
+    /* @return true if the instruction at At, or a page it reads or writes
+    *  whatever the registers hold, is mapped now. Pages reached through an
+    *  index or a pointer are checked by the translated code */
+    bool TouchesMappedPage( u32 At, u32 Length, const OpInfo& Info, Word Operand, const Mem& memory )
+    {
+        if ( memory.MappedPage[At / Mem::PAGE_SIZE] || memory.MappedPage[(At + Length - 1) / Mem::PAGE_SIZE] )
+        {
+            return true;
+        }
+        switch ( Info.Addressing )
+        {
+            case Mode::ZeroPage: case Mode::ZeroPageX: case Mode::ZeroPageY:
+            case Mode::IndirectX: case Mode::IndirectY:
+                return memory.MappedPage[0];
+            case Mode::Absolute:
+                return memory.MappedPage[Operand / Mem::PAGE_SIZE];
+            default:
+                break;
+        }
+        switch ( Info.Op )
+        {
+            case Kind::PHA: case Kind::PHP: case Kind::PLA: case Kind::PLP:
+            case Kind::JSR: case Kind::RTS:
+                return memory.MappedPage[StackBase / Mem::PAGE_SIZE];
+            default:
+                return false;
+        }
+    }
+
+    /* The effective address of an operand, either known now or in RCX */
+    struct Address {
+        bool IsStatic;
+        Word Value;
+    };
+
+    static_assert( sizeof( Jit::Entry ) == 16, "The native code indexes Jit::Entries with a shift" );
+
+    /* Turns one block of 6502 instructions into native code.
+    *  The block charges the cycles of each way out to CyclesLeft, then jumps
+    *  straight into the next block if it is translated and there are enough
+    *  cycles left for it, otherwise leaves the next PC in RCX and jumps to the
+    *  epilogue to go back to Jit::Execute.
+    *  With GuardMappedPages set every access first checks Mem::MappedPage and
+    *  leaves the block before the instruction if its page is mapped, so the
+    *  interpreter does it through the bus. */
+    class Translator {
+    public:
+        /* Cycles of the instructions translated so far, page crossings are
+        *  charged at run time */
+        s32 Cycles = 0;
+
+        /* Where the block's body starts, after the prologue */
+        u32 BodyOffset = 0;
+
+        Translator( const Jit::Entry* Entries, const Byte* CodeBytes, bool GuardMappedPages )
+            : Entries( Entries ), CodeBytes( CodeBytes ), GuardMappedPages( GuardMappedPages )
+        {
+        }
+
+        void Prologue() {
+#if defined( _WIN32 )
+            // Microsoft x64 passes the arguments in RCX, RDX & R8 and expects RSI & RDI kept
+            E.Push( RSI );
+            E.Push( RDI );
+            E.Mov64( CPUReg, RCX );
+            E.Mov64( MemReg, RDX );
+            constexpr int CyclesArgument = R8;
+#else
+            constexpr int CyclesArgument = RDX;
+#endif
+            E.Push( RBX );
+            E.Push( RBP );
+            E.Push( R12 );
+            E.Push( R13 );
+            E.Mov( CyclesLeft, CyclesArgument );
+            E.MovImm64( EntryTable, Entries );
+            E.MovImm64( CodeMap, CodeBytes );
+            E.LoadByte( RegA, CPUReg, -1, offsetof( CPU, A ) );
+            E.LoadByte( RegX, CPUReg, -1, offsetof( CPU, X ) );
+            E.LoadByte( RegY, CPUReg, -1, offsetof( CPU, Y ) );
+            E.LoadByte( RegSP, CPUReg, -1, offsetof( CPU, SP ) );
+            E.LoadByte( RegPS, CPUReg, -1, offsetof( CPU, PS ) );
+            BodyOffset = E.Size();
+        }
+
+        void Translate( Word PC, Byte Opcode, Word Operand, const OpInfo& Info ) {
+            const s32 CyclesBefore = Cycles;
+            const Word Next = PC + Instructions::Dispatch[Opcode].Length;
+            InstructionPC = PC;
+            InstructionCycles = CyclesBefore;
+            Cycles += Instructions::Dispatch[Opcode].BaseCycles;
+
+            const Mode Addressing = Info.Addressing;
+            switch ( Info.Op )
+            {
+                case Kind::Load:
+                    Read( Info.Reg, Addressing, Operand, ChargesPageCross( Info ) );
+                    SetZeroAndNegative( Info.Reg );
+                    break;
+
+                case Kind::Store:
+                {
+                    const Address At = EffectiveAddress( Addressing, Operand, false );
+                    Write( Info.Reg, At );
+                    CheckForCodeWrite( At, Next );
+                    break;
+                }
+
+                case Kind::And:
+                case Kind::Ora:
+                case Kind::Eor:
+                {
+                    Read( RAX, Addressing, Operand, ChargesPageCross( Info ) );
+                    const AluOp Op = Info.Op == Kind::And ? ALU_AND : Info.Op == Kind::Ora ? ALU_OR : ALU_XOR;
+                    E.Alu( Op, RegA, RAX );
+                    SetZeroAndNegative( RegA );
+                    break;
+                }
+
+                case Kind::Bit:
+                    Read( RAX, Addressing, Operand, false );
+                    // N and V straight from the operand, Z from A & operand
+                    E.AluImm( ALU_AND, RegPS, ~(CPU::NegativeFlagBit | CPU::OverflowFlagBit | CPU::ZeroFlagBit) );
+                    E.Mov( Temp, RAX );
+                    E.AluImm( ALU_AND, Temp, CPU::NegativeFlagBit | CPU::OverflowFlagBit );
+                    E.Alu( ALU_OR, RegPS, Temp );
+                    E.Alu( ALU_AND, RAX, RegA );
+                    SetZeroFlagIfZero( RAX );
+                    break;
+
+                case Kind::Adc:
+                case Kind::Sbc:
+                    // Decimal mode is the interpreter's business
+                    E.Test( RegPS, CPU::DecimalModeFlagBit );
+                    SideExits.push_back( { E.JumpIf( IF_NOT_ZERO ), PC, CyclesBefore, false, {} } );
+                    Read( RAX, Addressing, Operand, ChargesPageCross( Info ) );
+                    if ( Info.Op == Kind::Sbc )
+                    {
+                        E.AluImm( ALU_XOR, RAX, 0xFF );
+                    }
+                    AddWithCarry();
+                    break;
+
+                case Kind::Compare:
+                    Read( RAX, Addressing, Operand, ChargesPageCross( Info ) );
+                    E.Mov( RCX, Info.Reg );
+                    E.Alu( ALU_SUB, RCX, RAX );
+                    // Carry when there was no borrow (the 32-bit difference is not negative)
+                    E.Mov( Temp, RCX );
+                    E.Shift( SHIFT_RIGHT, Temp, 31 );
+                    E.AluImm( ALU_XOR, Temp, 1 );
+                    SetCarry( Temp );
+                    E.AluImm( ALU_AND, RCX, 0xFF );
+                    SetZeroAndNegative( RCX );
+                    break;
+
+                case Kind::Asl:
+                case Kind::Lsr:
+                case Kind::Rol:
+                case Kind::Ror:
+                    if ( Addressing == Mode::Implied )
+                    {
+                        E.Mov( RAX, RegA );
+                        Shift( Info.Op );
+                        SetZeroAndNegative( RAX );
+                        E.Mov( RegA, RAX );
+                    }
+                    else
+                    {
+                        const Address At = EffectiveAddress( Addressing, Operand, false );
+                        Load( RAX, At );
+                        Shift( Info.Op );
+                        SetZeroAndNegative( RAX );
+                        Write( RAX, At );
+                        CheckForCodeWrite( At, Next );
+                    }
+                    break;
+
+                case Kind::Increment:
+                case Kind::Decrement:
+                {
+                    const Address At = EffectiveAddress( Addressing, Operand, false );
+                    Load( RAX, At );
+                    E.AluImm( ALU_ADD, RAX, Info.Op == Kind::Increment ? 1 : -1 );
+                    E.AluImm( ALU_AND, RAX, 0xFF );
+                    SetZeroAndNegative( RAX );
+                    Write( RAX, At );
+                    CheckForCodeWrite( At, Next );
+                    break;
+                }
+
+                case Kind::IncrementRegister:
+                case Kind::DecrementRegister:
+                    E.AluImm( ALU_ADD, Info.Reg, Info.Op == Kind::IncrementRegister ? 1 : -1 );
+                    E.AluImm( ALU_AND, Info.Reg, 0xFF );
+                    SetZeroAndNegative( Info.Reg );
+                    break;
+
+                case Kind::Transfer:
+                    E.Mov( Info.To, Info.Reg );
+                    SetZeroAndNegative( Info.To );
+                    break;
+
+                case Kind::TXS:
+                    E.Mov( RegSP, RegX );
+                    break;
+
+                case Kind::SetFlag:
+                    E.AluImm( ALU_OR, RegPS, Info.FlagBit );
+                    break;
+
+                case Kind::ClearFlag:
+                    E.AluImm( ALU_AND, RegPS, ~Info.FlagBit );
+                    break;
+
+                case Kind::NOP:
+                    break;
+
+                case Kind::PHA:
+                    GuardPage( StackBase / Mem::PAGE_SIZE );
+                    Push( RegA );
+                    CheckForStackWrite( Next );
+                    break;
+
+                case Kind::PHP:
+                    GuardPage( StackBase / Mem::PAGE_SIZE );
+                    E.Mov( RAX, RegPS );
+                    E.AluImm( ALU_OR, RAX, CPU::BreakFlagBit | CPU::UnusedFlagBit );
+                    Push( RAX );
+                    CheckForStackWrite( Next );
+                    break;
+
+                case Kind::PLA:
+                    GuardPage( StackBase / Mem::PAGE_SIZE );
+                    Pop( RegA );
+                    SetZeroAndNegative( RegA );
+                    break;
+
+                case Kind::PLP:
+                    GuardPage( StackBase / Mem::PAGE_SIZE );
+                    Pop( RegPS );
+                    E.AluImm( ALU_AND, RegPS, ~(CPU::BreakFlagBit | CPU::UnusedFlagBit) );
+                    break;
+
+                case Kind::Branch:
+                {
+                    const Word Target = Next + (SByte)Operand;
+                    const bool PageChanged = (Target >> 8) != (Next >> 8);
+                    E.Test( RegPS, Info.FlagBit );
+                    const u32 Taken = E.JumpIf( Info.Expected ? IF_NOT_ZERO : IF_ZERO );
+                    Exit( Next, Cycles );
+                    E.Bind( Taken );
+                    if ( Target == PC )
+                    {
+                        Trap( PC, Cycles + (PageChanged ? 2 : 1) );
+                        break;
+                    }
+                    Exit( Target, Cycles + (PageChanged ? 2 : 1) );
+                    break;
+                }
+
+                case Kind::Jump:
+                    if ( Operand == PC )
+                    {
+                        Trap( PC, Cycles );
+                        break;
+                    }
+                    Exit( Operand, Cycles );
+                    break;
+
+                case Kind::JSR:
+                {
+                    const Word ReturnAddress = Next - 1;
+                    GuardPage( StackBase / Mem::PAGE_SIZE );
+                    E.StoreByteImm( MemReg, RegSP, StackBase, ReturnAddress >> 8 );
+                    DecrementSP();
+                    E.StoreByteImm( MemReg, RegSP, StackBase, ReturnAddress & 0xFF );
+                    DecrementSP();
+                    CheckForStackWrite( Operand );
+                    Exit( Operand, Cycles );
+                    break;
+                }
+
+                case Kind::RTS:
+                    GuardPage( StackBase / Mem::PAGE_SIZE );
+                    E.Mov( RCX, RegSP );
+                    E.LoadByte( RAX, MemReg, RCX, StackBase + 1 );
+                    E.LoadByte( RCX, MemReg, RCX, StackBase + 2 );
+                    E.Shift( SHIFT_LEFT, RCX, 8 );
+                    E.Alu( ALU_OR, RCX, RAX );
+                    E.AluImm( ALU_ADD, RCX, 1 );
+                    E.AluImm( ALU_AND, RCX, 0xFFFF );
+                    E.AluImm( ALU_ADD, RegSP, 2 );
+                    E.AluImm( ALU_AND, RegSP, 0xFF );
+                    E.AluImm( ALU_SUB, CyclesLeft, Cycles );
+                    E.Mov( RAX, RCX );
+                    E.Shift( SHIFT_LEFT, RAX, 4 );
+                    E.CompareMem( CyclesLeft, EntryTable, RAX, offsetof( Jit::Entry, Budget ) );
+                    EpilogueJumps.push_back( E.JumpIf( IF_LESS_OR_EQUAL ) );
+                    E.Load64( RAX, EntryTable, RAX, offsetof( Jit::Entry, Body ) );
+                    E.JumpTo( RAX );
+                    break;
+
+                case Kind::Unsupported:
+                    break;
+            }
+        }
+
+        /* Leave the block for PC having used Cycles (plus page crossings) */
+        void Exit( Word PC, s32 CyclesUsed ) {
+            E.AluImm( ALU_SUB, CyclesLeft, CyclesUsed );
+            const s32 Offset = PC * (s32)sizeof( Jit::Entry );
+            E.CompareMem( CyclesLeft, EntryTable, -1, Offset + offsetof( Jit::Entry, Budget ) );
+            const u32 NotChained = E.JumpIf( IF_LESS_OR_EQUAL );
+            E.Load64( RAX, EntryTable, -1, Offset + offsetof( Jit::Entry, Body ) );
+            E.JumpTo( RAX );
+            E.Bind( NotChained );
+            E.MovImm( RCX, PC );
+            EpilogueJumps.push_back( E.Jump() );
+        }
+
+        /* A jump to itself at PC: with CPU::HaltOnTrap set go back to
+        *  Jit::Execute marked as halted, otherwise carry on like any jump */
+        void Trap( Word PC, s32 CyclesUsed ) {
+            E.CompareByteImm( CPUReg, -1, offsetof( CPU, HaltOnTrap ), 0 );
+            const u32 NoHalt = E.JumpIf( IF_ZERO );
+            E.StoreByteImm( CPUReg, -1, offsetof( CPU, Halted ), (Byte)CPU::HaltReason::Trap );
+            Leave( PC, CyclesUsed );
+            E.Bind( NoHalt );
+            Exit( PC, CyclesUsed );
+        }
+
+        /* Go back to Jit::Execute at PC having used Cycles (plus page crossings) */
+        void Leave( Word PC, s32 CyclesUsed ) {
+            E.AluImm( ALU_SUB, CyclesLeft, CyclesUsed );
+            E.MovImm( RCX, PC );
+            EpilogueJumps.push_back( E.Jump() );
+        }
+
+        /* @return the finished code */
+        std::vector<Byte>& Finish() {
+            for ( const SideExit& Side : SideExits )
+            {
+                E.Bind( Side.Jump );
+                if ( Side.CodeWritten )
+                {
+                    // Do what Mem::NoteWrite would have
+                    if ( Side.Written.IsStatic )
+                    {
+                        E.MovImm( Temp, Side.Written.Value >> 8 );
+                    }
+                    else
+                    {
+                        E.Mov( Temp, RCX );
+                        E.Shift( SHIFT_RIGHT, Temp, 8 );
+                    }
+                    E.StoreByteImm( MemReg, Temp, offsetof( Mem, CodePageWritten ), 1 );
+                    E.StoreByteImm( MemReg, -1, offsetof( Mem, CodeWritten ), 1 );
+                }
+                Leave( Side.PC, Side.Cycles );
+            }
+
+            for ( u32 Jump : EpilogueJumps )
+            {
+                E.Bind( Jump );
+            }
+            E.StoreWord( RCX, CPUReg, offsetof( CPU, PC ) );
+            E.StoreByte( RegA, CPUReg, -1, offsetof( CPU, A ) );
+            E.StoreByte( RegX, CPUReg, -1, offsetof( CPU, X ) );
+            E.StoreByte( RegY, CPUReg, -1, offsetof( CPU, Y ) );
+            E.StoreByte( RegSP, CPUReg, -1, offsetof( CPU, SP ) );
+            E.StoreByte( RegPS, CPUReg, -1, offsetof( CPU, PS ) );
+            E.Mov( RAX, CyclesLeft );
+            E.Pop( R13 );
+            E.Pop( R12 );
+            E.Pop( RBP );
+            E.Pop( RBX );
+#if defined( _WIN32 )
+            E.Pop( RDI );
+            E.Pop( RSI );
+#endif
+            E.Ret();
+            return E.Code;
+        }
+
+    private:
+
+        /* A conditional jump out of the middle of the block */
+        struct SideExit {
+            u32 Jump;
+            Word PC;
+            s32 Cycles;
+            bool CodeWritten;       // Set Mem's written flags on the way out
+            Address Written;        // for this address
+        };
+
+        const Jit::Entry* Entries;
+        const Byte* CodeBytes;
+        bool GuardMappedPages;
+        Word InstructionPC = 0;         // Of the instruction being translated
+        s32 InstructionCycles = 0;      // Cycles before it
+        Emitter E;
+        std::vector<SideExit> SideExits;
+        std::vector<u32> EpilogueJumps;
+
+        /* Charge a cycle when the host carry is clear */
+        void ChargeIfNoCarry() {
+            E.Cmc();
+            E.AluImm( ALU_SBB, CyclesLeft, 0 );
+        }
+
+        /* Leave the block before the instruction if Page is mapped */
+        void GuardPage( u32 Page ) {
+            if ( GuardMappedPages )
+            {
+                E.CompareByteImm( MemReg, -1, offsetof( Mem, MappedPage ) + Page, 0 );
+                SideExits.push_back( { E.JumpIf( IF_NOT_ZERO ), InstructionPC, InstructionCycles, false, {} } );
+            }
+        }
+
+        /* GuardPage for the address in RCX */
+        void GuardAddressInRCX() {
+            if ( GuardMappedPages )
+            {
+                E.Mov( Temp, RCX );
+                E.Shift( SHIFT_RIGHT, Temp, 8 );
+                E.CompareByteImm( MemReg, Temp, offsetof( Mem, MappedPage ), 0 );
+                SideExits.push_back( { E.JumpIf( IF_NOT_ZERO ), InstructionPC, InstructionCycles, false, {} } );
+            }
+        }
+
+        /* Page crossings are charged after the guards, a side exit must
+        *  leave the cycles as they were before the instruction */
+        Address EffectiveAddress( Mode Addressing, Word Operand, bool ChargePageCross ) {
+            switch ( Addressing )
+            {
+                case Mode::ZeroPage:
+                    GuardPage( 0 );
+                    return { true, (Word)(Operand & 0xFF) };
+
+                case Mode::Absolute:
+                    GuardPage( Operand / Mem::PAGE_SIZE );
+                    return { true, Operand };
+
+                case Mode::ZeroPageX:
+                case Mode::ZeroPageY:
+                    GuardPage( 0 );
+                    E.Mov( RCX, Addressing == Mode::ZeroPageX ? RegX : RegY );
+                    E.AluImm( ALU_ADD, RCX, Operand & 0xFF );
+                    E.AluImm( ALU_AND, RCX, 0xFF );
+                    return { false, 0 };
+
+                case Mode::AbsoluteX:
+                case Mode::AbsoluteY:
+                {
+                    const int Index = Addressing == Mode::AbsoluteX ? RegX : RegY;
+                    const s32 Low = Operand & 0xFF;
+                    E.Mov( RCX, Index );
+                    E.AluImm( ALU_ADD, RCX, Operand );
+                    E.AluImm( ALU_AND, RCX, 0xFFFF );
+                    GuardAddressInRCX();
+                    if ( ChargePageCross && Low != 0 )
+                    {
+                        // Crosses when Index >= 0x100 - Low
+                        E.AluImm( ALU_CMP, Index, 0x100 - Low );
+                        ChargeIfNoCarry();
+                    }
+                    return { false, 0 };
+                }
+
+                case Mode::IndirectX:
+                    // The pointer's high byte comes from ZP + 1 without wrapping, like CPU::ReadWord
+                    GuardPage( 0 );
+                    E.Mov( Temp, RegX );
+                    E.AluImm( ALU_ADD, Temp, Operand & 0xFF );
+                    E.AluImm( ALU_AND, Temp, 0xFF );
+                    E.LoadByte( RCX, MemReg, Temp, 1 );
+                    E.Shift( SHIFT_LEFT, RCX, 8 );
+                    E.LoadByte( RAX, MemReg, Temp, 0 );
+                    E.Alu( ALU_OR, RCX, RAX );
+                    GuardAddressInRCX();
+                    return { false, 0 };
+
+                case Mode::IndirectY:
+                    GuardPage( 0 );
+                    E.LoadByte( RCX, MemReg, -1, (Operand & 0xFF) + 1 );
+                    E.Shift( SHIFT_LEFT, RCX, 8 );
+                    E.LoadByte( RAX, MemReg, -1, Operand & 0xFF );
+                    E.Alu( ALU_ADD, RAX, RegY );
+                    E.Alu( ALU_ADD, RCX, RAX );
+                    E.AluImm( ALU_AND, RCX, 0xFFFF );
+                    GuardAddressInRCX();
+                    if ( ChargePageCross )
+                    {
+                        E.AluImm( ALU_CMP, RAX, 0x100 );
+                        ChargeIfNoCarry();
+                    }
+                    return { false, 0 };
+
+                default:
+                    return { true, 0 };
+            }
+        }
+
+        void Load( int Dst, Address At ) {
+            if ( At.IsStatic )
+            {
+                E.LoadByte( Dst, MemReg, -1, At.Value );
+            }
+            else
+            {
+                E.LoadByte( Dst, MemReg, RCX, 0 );
+            }
+        }
+
+        /* Store and mark the page dirty, like Mem::NoteWrite */
+        void Write( int Src, Address At ) {
+            if ( At.IsStatic )
+            {
+                E.StoreByte( Src, MemReg, -1, At.Value );
+                E.StoreByteImm( MemReg, -1, offsetof( Mem, DirtyPage ) + At.Value / Mem::PAGE_SIZE, 1 );
+            }
+            else
+            {
+                E.StoreByte( Src, MemReg, RCX, 0 );
+                E.Mov( Temp, RCX );
+                E.Shift( SHIFT_RIGHT, Temp, 8 );
+                E.StoreByteImm( MemReg, Temp, offsetof( Mem, DirtyPage ), 1 );
+            }
+        }
+
+        /* Read the operand into Dst */
+        void Read( int Dst, Mode Addressing, Word Operand, bool ChargePageCross ) {
+            if ( Addressing == Mode::Immediate )
+            {
+                E.MovImm( Dst, Operand & 0xFF );
+                return;
+            }
+            Load( Dst, EffectiveAddress( Addressing, Operand, ChargePageCross ) );
+        }
+
+        /* After a store, leave the block for Next if the page holds code.
+        *  Must be the last thing the instruction does. */
+        void CheckForCodeWrite( Address At, Word Next ) {
+            // By the byte, code and data often share a page
+            if ( At.IsStatic )
+            {
+                E.CompareByteImm( CodeMap, -1, At.Value, 0 );
+            }
+            else
+            {
+                E.CompareByteImm( CodeMap, RCX, 0, 0 );
+            }
+            SideExits.push_back( { E.JumpIf( IF_NOT_ZERO ), Next, Cycles, true, At } );
+        }
+
+        /* CheckForCodeWrite for pushes, code on the stack page is rare enough
+        *  to go by the page */
+        void CheckForStackWrite( Word Next ) {
+            E.CompareByteImm( MemReg, -1, offsetof( Mem, CodePage ) + StackBase / Mem::PAGE_SIZE, 0 );
+            SideExits.push_back( { E.JumpIf( IF_NOT_ZERO ), Next, Cycles, true, { true, StackBase } } );
+        }
+
+        void SetZeroFlagIfZero( int Value ) {
+            // Value - 1 only borrows when Value is 0
+            E.AluImm( ALU_CMP, Value, 1 );
+            E.Alu( ALU_SBB, Temp, Temp );
+            E.AluImm( ALU_AND, Temp, CPU::ZeroFlagBit );
+            E.Alu( ALU_OR, RegPS, Temp );
+        }
+
+        /* N and Z from a byte value, see CPU::SetZeroAndNegativeFlags */
+        void SetZeroAndNegative( int Value ) {
+            E.AluImm( ALU_AND, RegPS, ~(CPU::NegativeFlagBit | CPU::ZeroFlagBit) );
+            E.Mov( Temp, Value );
+            E.AluImm( ALU_AND, Temp, CPU::NegativeFlagBit );
+            E.Alu( ALU_OR, RegPS, Temp );
+            SetZeroFlagIfZero( Value );
+        }
+
+        /* Carry from a register holding 0 or 1 */
+        void SetCarry( int Bit ) {
+            E.AluImm( ALU_AND, RegPS, ~CPU::CarryFlagBit );
+            E.Alu( ALU_OR, RegPS, Bit );
+        }
+
+        /* Operand in RAX, see Instructions::AddWithCarry */
+        void AddWithCarry() {
+            E.BitTest( RegPS, 0 );
+            E.Mov( RCX, RegA );
+            E.Alu( ALU_ADC, RCX, RAX );
+            // V when the operands' signs match and the result's sign differs
+            E.Alu( ALU_XOR, RAX, RCX );
+            E.Alu( ALU_XOR, RegA, RCX );
+            E.Alu( ALU_AND, RAX, RegA );
+            E.AluImm( ALU_AND, RAX, 0x80 );
+            E.Shift( SHIFT_RIGHT, RAX, 1 );
+            E.AluImm( ALU_AND, RegPS, ~(CPU::OverflowFlagBit | CPU::CarryFlagBit) );
+            E.Alu( ALU_OR, RegPS, RAX );
+            E.Mov( RAX, RCX );
+            E.Shift( SHIFT_RIGHT, RAX, 8 );
+            E.Alu( ALU_OR, RegPS, RAX );
+            E.Mov( RegA, RCX );
+            E.AluImm( ALU_AND, RegA, 0xFF );
+            SetZeroAndNegative( RegA );
+        }
+
+        /* Shift/rotate RAX, see Instructions::ASL etc. */
+        void Shift( Kind Op ) {
+            switch ( Op )
+            {
+                case Kind::Asl:
+                    E.Mov( Temp, RAX );
+                    E.Shift( SHIFT_RIGHT, Temp, 7 );
+                    SetCarry( Temp );
+                    E.Shift( SHIFT_LEFT, RAX, 1 );
+                    E.AluImm( ALU_AND, RAX, 0xFF );
+                    break;
+                case Kind::Lsr:
+                    E.Mov( Temp, RAX );
+                    E.AluImm( ALU_AND, Temp, 1 );
+                    SetCarry( Temp );
+                    E.Shift( SHIFT_RIGHT, RAX, 1 );
+                    break;
+                case Kind::Rol:
+                    E.Mov( Temp, RegPS );
+                    E.AluImm( ALU_AND, Temp, CPU::CarryFlagBit );
+                    E.Shift( SHIFT_LEFT, RAX, 1 );
+                    E.Alu( ALU_OR, RAX, Temp );
+                    E.Mov( Temp, RAX );
+                    E.Shift( SHIFT_RIGHT, Temp, 8 );
+                    SetCarry( Temp );
+                    E.AluImm( ALU_AND, RAX, 0xFF );
+                    break;
+                case Kind::Ror:
+                    E.Mov( Temp, RegPS );
+                    E.AluImm( ALU_AND, Temp, CPU::CarryFlagBit );
+                    E.Shift( SHIFT_LEFT, Temp, 8 );
+                    E.Alu( ALU_OR, RAX, Temp );
+                    E.Mov( Temp, RAX );
+                    E.AluImm( ALU_AND, Temp, 1 );
+                    SetCarry( Temp );
+                    E.Shift( SHIFT_RIGHT, RAX, 1 );
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void DecrementSP() {
+            E.AluImm( ALU_SUB, RegSP, 1 );
+            E.AluImm( ALU_AND, RegSP, 0xFF );
+        }
+
+        void Push( int Src ) {
+            E.StoreByte( Src, MemReg, RegSP, StackBase );
+            E.StoreByteImm( MemReg, -1, offsetof( Mem, DirtyPage ) + StackBase / Mem::PAGE_SIZE, 1 );
+            DecrementSP();
+        }
+
+        void Pop( int Dst ) {
+            E.AluImm( ALU_ADD, RegSP, 1 );
+            E.AluImm( ALU_AND, RegSP, 0xFF );
+            E.LoadByte( Dst, MemReg, RegSP, StackBase );
+        }
+    };
+
+    Byte* AllocateCodeBuffer( u32 Size )
+    {
+#if defined( _WIN32 )
+        return (Byte*)VirtualAlloc( nullptr, Size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+#else
+        void* Buffer = mmap( nullptr, Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        return Buffer == MAP_FAILED ? nullptr : (Byte*)Buffer;
+#endif
+    }
+
+    void FreeCodeBuffer( Byte* Buffer, u32 Size )
+    {
+#if defined( _WIN32 )
+        VirtualFree( Buffer, 0, MEM_RELEASE );
+#else
+        munmap( Buffer, Size );
+#endif
+    }
+
+    /* The buffer is never writable and executable at the same time */
+    void SetCodeBufferWritable( Byte* Buffer, u32 Size, bool Writable )
+    {
+#if defined( _WIN32 )
+        DWORD OldProtect;
+        VirtualProtect( Buffer, Size, Writable ? PAGE_READWRITE : PAGE_EXECUTE_READ, &OldProtect );
+#else
+        mprotect( Buffer, Size, Writable ? (PROT_READ | PROT_WRITE) : (PROT_READ | PROT_EXEC) );
+#endif
+    }
+}
+
+m6502::Jit::Jit( u32 HotThreshold, u32 MaxCodeBufferSize )
+    : HotThreshold( HotThreshold ),
+      MaxCodeBufferSize( MaxCodeBufferSize )
+{
+}
+
+m6502::Jit::~Jit()
+{
+    if ( CodeBuffer )
+    {
+        FreeCodeBuffer( CodeBuffer, CodeBufferBytes );
+    }
+}
+
+void m6502::Jit::Allocate()
+{
+    BlockAt.resize( Mem::MAX_MEM );
+    Entries.resize( Mem::MAX_MEM );
+    CodeBytes.resize( Mem::MAX_MEM );
+    Heat.resize( Mem::MAX_MEM );
+}
+
+m6502::s32 m6502::Jit::Execute( s32 Cycles, CPU& cpu, Mem& memory )
+{
+    const s32 CyclesRequested = Cycles;
+    cpu.Halted = CPU::HaltReason::None;
+
+    if ( BlockAt.empty() )
+    {
+        Allocate();
+    }
+    if ( memory.Identity != BoundIdentity )
+    {
+        Rebind( memory );
+    }
+    if ( ( cpu.Breaks && cpu.Breaks->Count() ) || AnyPageArmed )
+    {
+        FollowBreakpoints( cpu.Breaks );
+    }
+
+    while ( Cycles > 0 )
+    {
+        if ( !memory.IsPlainMemory() && !GuardMappedPages )
+        {
+            // The blocks so far don't check for mapped pages. Mapping is
+            // done here or by a device the interpreter ran, never in a block
+            Flush();
+            GuardMappedPages = true;
+        }
+        if ( memory.CodeWritten )
+        {
+            InvalidateWrittenPages( memory );
+        }
+
+        // Blocks never touch a mapped page, nothing they do can raise an interrupt, so
+        // checking between blocks is checking at every instruction boundary.
+        // The interpreter takes it (or steps past a masked IRQ)
+        if ( cpu.PendingEvents )
+        {
+            const bool StopRequested = cpu.PendingEvents & CPU::PendingStop;
+            Cycles -= cpu.Interpret( 1, memory );
+            if ( StopRequested || cpu.Halted != CPU::HaltReason::None )
+            {
+                break;
+            }
+            continue;
+        }
+
+        Block* Current = BlockAt[cpu.PC].get();
+        if ( !Current && Heat[cpu.PC]++ >= HotThreshold )
+        {
+            Heat[cpu.PC] = 0;
+            Current = Compile( cpu.PC, memory );
+        }
+
+        if ( Current && Current->Armed )
+        {
+            // The interpreter stops at the breakpoints
+            Cycles -= cpu.Interpret( 1, memory );
+        }
+        else if ( Current && Cycles > Current->Budget )
+        {
+            // The block starts on a page without breakpoints, the
+            // interpreter would forget the one it passed here too
+            cpu.BreakpointPassed = CPU::NO_BREAKPOINT;
+            const s32 CyclesBefore = Cycles;
+            Cycles = Current->Code( &cpu, &memory, Cycles );
+            if ( cpu.Halted != CPU::HaltReason::None )
+            {
+                // Blocks leave for Execute right after a trap (CPU::HaltOnTrap)
+                break;
+            }
+            if ( Cycles == CyclesBefore )
+            {
+                // Side exit on the first instruction (decimal mode ADC/SBC, a
+                // mapped page), the interpreter steps over it or we would be
+                // straight back
+                Cycles -= cpu.Interpret( 1, memory );
+            }
+        }
+        else if ( Current )
+        {
+            // Too few cycles left for the block, the interpreter finishes the slice
+            Cycles -= cpu.Interpret( Cycles, memory );
+        }
+        else
+        {
+            Cycles -= cpu.Interpret( 1, memory );
+        }
+
+        if ( cpu.Halted != CPU::HaltReason::None )
+        {
+            // A breakpoint or a trap the interpreter stopped at
+            break;
+        }
+    }
+
+    const s32 NumCyclesUsed = CyclesRequested - Cycles;
+    return NumCyclesUsed;
+}
+
+m6502::Jit::Block* m6502::Jit::Compile( Word Address, Mem& memory )
+{
+    const Mem& Memory = memory;
+    if ( MaxCodeBufferSize == 0 || Describe( Memory[Address] ).Op == Kind::Unsupported )
+    {
+        return nullptr;
+    }
+
+    Translator Translation( Entries.data(), CodeBytes.data(), GuardMappedPages );
+    Translation.Prologue();
+
+    std::unique_ptr<Block> NewBlock = std::make_unique<Block>();
+    NewBlock->Start = Address;
+    NewBlock->Budget = 0;
+
+    u32 At = Address;
+    u32 NumInstructions = 0;
+    s32 LastMaxCycles = 0;
+    bool EndsWithControlFlow = false;
+    while ( NumInstructions < MAX_BLOCK_LENGTH && !EndsWithControlFlow )
+    {
+        const Byte Opcode = Memory[At];
+        const OpInfo Info = Describe( Opcode );
+        const u32 Length = Instructions::Dispatch[Opcode].Length;
+        if ( Info.Op == Kind::Unsupported || At + Length > Mem::MAX_MEM )
+        {
+            break;
+        }
+
+        Word Operand = 0;
+        if ( Length > 1 )
+        {
+            Operand = Memory[At + 1];
+        }
+        if ( Length > 2 )
+        {
+            Operand |= Memory[At + 2] << 8;
+        }
+        if ( TouchesMappedPage( At, Length, Info, Operand, Memory ) )
+        {
+            // The interpreter goes through the bus for it
+            break;
+        }
+        if ( ArmedPage[At / Mem::PAGE_SIZE] || ArmedPage[(At + Length - 1) / Mem::PAGE_SIZE] )
+        {
+            // The interpreter stops at the breakpoints there
+            break;
+        }
+
+        // Every instruction but the last must be able to start
+        NewBlock->Budget += LastMaxCycles;
+        LastMaxCycles = MaxCycles( Opcode, Info );
+
+        Translation.Translate( (Word)At, Opcode, Operand, Info );
+        for ( u32 i = 0; i < Length; i++ )
+        {
+            NewBlock->Bytes.push_back( Memory[At + i] );
+        }
+        At += Length;
+        NumInstructions++;
+        EndsWithControlFlow = Instructions::IsControlFlow( Opcode );
+    }
+
+    if ( NumInstructions == 0 )
+    {
+        return nullptr;
+    }
+    if ( !EndsWithControlFlow )
+    {
+        Translation.Exit( (Word)At, Translation.Cycles );
+    }
+
+    const std::vector<Byte>& Code = Translation.Finish();
+    if ( !ReserveCode( (u32)Code.size() ) )
+    {
+        return nullptr;
+    }
+
+    // Only unprotect the pages being written
+    constexpr u32 HostPageSize = 4096;
+    const u32 FirstHostPage = CodeBufferUsed / HostPageSize * HostPageSize;
+    const u32 WriteSize = CodeBufferUsed + (u32)Code.size() - FirstHostPage;
+    SetCodeBufferWritable( CodeBuffer + FirstHostPage, WriteSize, true );
+    memcpy( CodeBuffer + CodeBufferUsed, Code.data(), Code.size() );
+    SetCodeBufferWritable( CodeBuffer + FirstHostPage, WriteSize, false );
+    NewBlock->Code = reinterpret_cast<NativeCode>( CodeBuffer + CodeBufferUsed );
+    Entries[Address].Body = CodeBuffer + CodeBufferUsed + Translation.BodyOffset;
+    Entries[Address].Budget = NewBlock->Budget;
+    CodeBufferUsed += (u32)Code.size();
+
+    for ( u32 i = Address; i < At; i++ )
+    {
+        CodeBytes[i]++;
+    }
+    const u32 FirstPage = Address / Mem::PAGE_SIZE;
+    const u32 LastPage = (At - 1) / Mem::PAGE_SIZE;
+    for ( u32 Page = FirstPage; Page <= LastPage; Page++ )
+    {
+        PageBlocks[Page].push_back( Address );
+        memory.CodePage[Page] = true;
+    }
+
+    BlockAt[Address] = std::move( NewBlock );
+    NumCompiledBlocks++;
+    return BlockAt[Address].get();
+}
+
+void m6502::Jit::Rebind( Mem& memory )
+{
+    // Nothing recorded the writes to this Mem, treat every page holding a
+    // block as written so only the blocks with other bytes here are dropped
+    for ( u32 Page = 0; Page < Mem::NUM_PAGES; Page++ )
+    {
+        if ( !PageBlocks[Page].empty() )
+        {
+            memory.CodePage[Page] = true;
+            memory.CodePageWritten[Page] = true;
+            memory.CodeWritten = true;
+        }
+    }
+    InvalidateWrittenPages( memory );
+    BoundIdentity = memory.Identity;
+}
+
+bool m6502::Jit::ReserveCode( u32 Size )
+{
+    if ( CodeBufferUsed + Size <= CodeBufferBytes )
+    {
+        return true;
+    }
+    if ( Size > MaxCodeBufferSize )
+    {
+        return false;
+    }
+
+    // Translated code jumps to absolute addresses in the buffer, so it can't
+    // be moved to a bigger one, everything starts again there
+    Flush();
+    u32 NewSize = CodeBufferBytes ? CodeBufferBytes * 2 : MIN_CODE_BUFFER_SIZE;
+    NewSize = NewSize < Size ? Size : NewSize;
+    NewSize = NewSize > MaxCodeBufferSize ? MaxCodeBufferSize : NewSize;
+    if ( NewSize != CodeBufferBytes )
+    {
+        // Without more executable memory we carry on in the one we have
+        Byte* NewBuffer = AllocateCodeBuffer( NewSize );
+        if ( NewBuffer )
+        {
+            if ( CodeBuffer )
+            {
+                FreeCodeBuffer( CodeBuffer, CodeBufferBytes );
+            }
+            CodeBuffer = NewBuffer;
+            CodeBufferBytes = NewSize;
+        }
+    }
+    return Size <= CodeBufferBytes;
+}
+
+void m6502::Jit::InvalidateWrittenPages( Mem& memory )
+{
+    for ( u32 Page = 0; Page < Mem::NUM_PAGES; Page++ )
+    {
+        // Usually one page is written, skip the others 8 at a time
+        unsigned long long EightPages;
+        if ( Page % 8 == 0 )
+        {
+            memcpy( &EightPages, &memory.CodePageWritten[Page], sizeof( EightPages ) );
+            if ( EightPages == 0 )
+            {
+                Page += 7;
+                continue;
+            }
+        }
+        if ( !memory.CodePageWritten[Page] )
+        {
+            continue;
+        }
+        memory.CodePageWritten[Page] = false;
+
+        // Code and data often share a page, so only drop the blocks whose
+        // bytes really changed, or whose page was mapped since. A block on
+        // several pages is listed on each of them, it may have gone already
+        std::vector<Word>& Starts = PageBlocks[Page];
+        for ( u32 i = 0; i < Starts.size(); )
+        {
+            std::unique_ptr<Block>& Compiled = BlockAt[Starts[i]];
+            if ( Compiled && !memory.MappedPage[Page] && IsUnchanged( *Compiled, memory ) )
+            {
+                i++;
+                continue;
+            }
+            if ( Compiled )
+            {
+                Drop( Starts[i] );
+            }
+            Starts[i] = Starts.back();
+            Starts.pop_back();
+        }
+        memory.CodePage[Page] = !Starts.empty();
+    }
+    memory.CodeWritten = false;
+}
+
+void m6502::Jit::FollowBreakpoints( const Breakpoints* Breaks )
+{
+    AnyPageArmed = false;
+    for ( u32 Page = 0; Page < Mem::NUM_PAGES; Page++ )
+    {
+        const bool Armed = Breaks && Breaks->IsPageArmed( Page );
+        AnyPageArmed |= Armed;
+        if ( Armed == ArmedPage[Page] )
+        {
+            continue;
+        }
+        ArmedPage[Page] = Armed;
+        for ( Word Start : PageBlocks[Page] )
+        {
+            if ( BlockAt[Start] )
+            {
+                Rearm( *BlockAt[Start] );
+            }
+        }
+    }
+}
+
+void m6502::Jit::Rearm( Block& Compiled )
+{
+    const u32 FirstPage = Compiled.Start / Mem::PAGE_SIZE;
+    const u32 LastPage = (Compiled.Start + (u32)Compiled.Bytes.size() - 1) / Mem::PAGE_SIZE;
+    Compiled.Armed = false;
+    for ( u32 Page = FirstPage; Page <= LastPage; Page++ )
+    {
+        Compiled.Armed |= ArmedPage[Page];
+    }
+
+    // No block chains to it while it is armed
+    Entries[Compiled.Start].Budget = Compiled.Armed ? INT_MAX : Compiled.Budget;
+}
+
+void m6502::Jit::Drop( Word Start )
+{
+    for ( u32 i = 0; i < BlockAt[Start]->Bytes.size(); i++ )
+    {
+        CodeBytes[Start + i]--;
+    }
+    BlockAt[Start].reset();
+    Entries[Start] = Entry{};
+    NumCompiledBlocks--;
+}
+
+bool m6502::Jit::IsUnchanged( const Block& Compiled, const Mem& memory )
+{
+    return memcmp( &memory.Data[Compiled.Start], Compiled.Bytes.data(), Compiled.Bytes.size() ) == 0;
+}
+
+void m6502::Jit::Flush()
+{
+    for ( std::unique_ptr<Block>& Compiled : BlockAt )
+    {
+        Compiled.reset();
+    }
+    for ( Entry& Chain : Entries )
+    {
+        Chain = Entry{};
+    }
+    for ( std::vector<Word>& Starts : PageBlocks )
+    {
+        Starts.clear();
+    }
+    for ( Byte& Count : CodeBytes )
+    {
+        Count = 0;
+    }
+    for ( u32& Count : Heat )
+    {
+        Count = 0;
+    }
+    NumCompiledBlocks = 0;
+    CodeBufferUsed = 0;
+}
+
+#endif
@@ -0,0 +1,319 @@
+#include "m6502_journal.h"
+
+m6502::Journal::Journal( std::vector<Byte> Recorded )
+    : Bytes( std::move( Recorded ) ), Replaying( true )
+{
+}
+
+bool m6502::Journal::Attach( Byte Page, Mem& memory )
+{
+    const Mem::PageHandler& Device = memory.Handlers[Page];
+    if ( !Device.Read || memory.ReadPages[Page] )
+    {
+        return false;
+    }
+    Devices[Page] = Device;
+
+    Mem::PageHandler Through;
+    Through.Read = ReadDevice;
+    Through.Write = Device.Write ? WriteDevice : nullptr;
+    Through.Context = this;
+    memory.MapHandler( Page, Through );
+    return true;
+}
+
+m6502::s32 m6502::Journal::Execute( s32 Cycles, CPU& cpu, Mem& memory )
+{
+    const s32 CyclesRequested = Cycles;
+    if ( Replaying )
+    {
+        ApplyDueLines( cpu );
+    }
+    Running = &cpu;
+    while ( Cycles > 0 )
+    {
+        // Replaying, run exactly up to the next line change
+        s32 Slice = Cycles;
+        Event Kind;
+        unsigned long long Stamp;
+        if ( Replaying && NextLine( Kind, Stamp ) && Stamp - CycleCount < (unsigned long long)Slice )
+        {
+            Slice = (s32)(Stamp - CycleCount);
+        }
+
+        s32 CyclesUsed;
+        try
+        {
+            CyclesUsed = cpu.Execute( Slice, memory );
+        }
+        catch ( ... )
+        {
+            Running = nullptr;
+            Pending.clear();
+            throw;
+        }
+        CycleCount += CyclesUsed;
+        Cycles -= CyclesUsed;
+        if ( Replaying )
+        {
+            ApplyDueLines( cpu );
+        }
+        else
+        {
+            StampEvents( cpu );
+        }
+        if ( cpu.Halted != CPU::HaltReason::None )
+        {
+            break;
+        }
+    }
+    Running = nullptr;
+    cpu.PendingEvents &= ~CPU::PendingStop;     // Left over if the last instruction read a device
+    return CyclesRequested - Cycles;
+}
+
+void m6502::Journal::SetIrq( CPU& cpu, bool Asserted )
+{
+    if ( !Replaying )
+    {
+        NoteAtBoundary( Asserted ? Event::Irq : Event::IrqRelease );
+        if ( !Running )
+        {
+            cpu.SetIrq( Asserted );
+        }
+    }
+}
+
+void m6502::Journal::TriggerNmi( CPU& cpu )
+{
+    if ( !Replaying )
+    {
+        NoteAtBoundary( Event::Nmi );
+        if ( !Running )
+        {
+            cpu.TriggerNmi();
+        }
+    }
+}
+
+void m6502::Journal::NoteAtBoundary( Event Kind, Byte Value )
+{
+    if ( !Running )
+    {
+        Note( Kind, Value );
+        return;
+    }
+    Pending.push_back( { Kind, Value } );
+    Running->RequestStop();
+}
+
+void m6502::Journal::StampEvents( CPU& cpu )
+{
+    // The reads happened inside the instruction, the line changes only
+    // count from its end: reads first so a replay meets them in that order
+    for ( const Unstamped& Kept : Pending )
+    {
+        if ( Kept.Kind == Event::DeviceRead )
+        {
+            Note( Kept.Kind, Kept.Value );
+        }
+    }
+    for ( const Unstamped& Kept : Pending )
+    {
+        if ( Kept.Kind != Event::DeviceRead )
+        {
+            Note( Kept.Kind );
+            Apply( Kept.Kind, cpu );
+        }
+    }
+    Pending.clear();
+}
+
+void m6502::Journal::ApplyDueLines( CPU& cpu )
+{
+    Event Kind;
+    unsigned long long Stamp;
+    while ( NextLine( Kind, Stamp ) && Stamp <= CycleCount )
+    {
+        Note( Kind );
+        if ( Diverged )
+        {
+            return;
+        }
+        Apply( Kind, cpu );
+    }
+}
+
+bool m6502::Journal::NextLine( Event& Kind, unsigned long long& Stamp )
+{
+    if ( Diverged )
+    {
+        return false;
+    }
+    if ( LineSearchFrom == NO_SEARCH || Offset < LineSearchFrom || Offset > LineOffset )
+    {
+        LineSearchFrom = Offset;
+        LineFound = false;
+        unsigned long long Tagged;
+        unsigned long long At = LastStamp;
+        size_t Next = Offset;
+        LineOffset = Next;
+        while ( ReadVarint( Next, Tagged ) )
+        {
+            At += Tagged >> 2;
+            if ( (Event)(Tagged & 3) != Event::DeviceRead )
+            {
+                LineFound = true;
+                LineKind = (Event)(Tagged & 3);
+                LineStamp = At;
+                break;
+            }
+            Next++;     // The value read
+            LineOffset = Next;
+        }
+        if ( !LineFound )
+        {
+            LineOffset = Bytes.size();
+        }
+    }
+    Kind = LineKind;
+    Stamp = LineStamp;
+    return LineFound;
+}
+
+void m6502::Journal::Apply( Event Kind, CPU& cpu )
+{
+    switch ( Kind )
+    {
+        case Event::Irq:
+            cpu.SetIrq( true );
+            break;
+        case Event::IrqRelease:
+            cpu.SetIrq( false );
+            break;
+        case Event::Nmi:
+            cpu.TriggerNmi();
+            break;
+        case Event::DeviceRead:
+            break;
+    }
+}
+
+m6502::Byte m6502::Journal::Note( Event Kind, Byte Value )
+{
+    if ( !Replaying )
+    {
+        WriteVarint( (CycleCount - LastStamp) << 2 | (Byte)Kind );
+        LastStamp = CycleCount;
+        if ( Kind == Event::DeviceRead )
+        {
+            Bytes.push_back( Value );
+        }
+        return Value;
+    }
+
+    unsigned long long Tagged;
+    size_t At = Offset;
+    if ( Diverged || !ReadVarint( At, Tagged ) || (Event)(Tagged & 3) != Kind )
+    {
+        Diverged = true;
+        return 0;
+    }
+    Value = 0;
+    if ( Kind == Event::DeviceRead )
+    {
+        if ( At == Bytes.size() )
+        {
+            Diverged = true;
+            return 0;
+        }
+        Value = Bytes[At++];
+    }
+    LastStamp += Tagged >> 2;
+    Offset = At;
+    return Value;
+}
+
+bool m6502::Journal::PeekNext( Event& Kind, unsigned long long& Stamp ) const
+{
+    unsigned long long Tagged;
+    size_t At = Offset;
+    if ( !Replaying || !ReadVarint( At, Tagged ) )
+    {
+        return false;
+    }
+    Kind = (Event)(Tagged & 3);
+    Stamp = LastStamp + (Tagged >> 2);
+    return true;
+}
+
+m6502::Journal::Position m6502::Journal::Tell() const
+{
+    Position Where;
+    Where.Offset = Replaying ? Offset : Bytes.size();
+    Where.Cycles = CycleCount;
+    Where.LastStamp = LastStamp;
+    return Where;
+}
+
+void m6502::Journal::Seek( const Position& Where )
+{
+    if ( Replaying )
+    {
+        Offset = Where.Offset;
+    }
+    else
+    {
+        Bytes.resize( Where.Offset );
+    }
+    CycleCount = Where.Cycles;
+    LastStamp = Where.LastStamp;
+    Diverged = false;
+    LineSearchFrom = NO_SEARCH;
+    Pending.clear();
+}
+
+m6502::Byte m6502::Journal::ReadDevice( void* Context, Word Address )
+{
+    Journal& Self = *static_cast<Journal*>( Context );
+    if ( Self.Replaying )
+    {
+        return Self.Note( Event::DeviceRead );
+    }
+    const Mem::PageHandler& Device = Self.Devices[Address / Mem::PAGE_SIZE];
+    const Byte Value = Device.Read( Device.Context, Address );
+    Self.NoteAtBoundary( Event::DeviceRead, Value );
+    return Value;
+}
+
+void m6502::Journal::WriteDevice( void* Context, Word Address, Byte Value )
+{
+    Journal& Self = *static_cast<Journal*>( Context );
+    const Mem::PageHandler& Device = Self.Devices[Address / Mem::PAGE_SIZE];
+    Device.Write( Device.Context, Address, Value );
+}
+
+void m6502::Journal::WriteVarint( unsigned long long Value )
+{
+    while ( Value >= 0x80 )
+    {
+        Bytes.push_back( (Byte)(Value | 0x80) );
+        Value >>= 7;
+    }
+    Bytes.push_back( (Byte)Value );
+}
+
+bool m6502::Journal::ReadVarint( size_t& At, unsigned long long& Value ) const
+{
+    Value = 0;
+    for ( u32 Shift = 0; At < Bytes.size() && Shift < 64; Shift += 7 )
+    {
+        const Byte Next = Bytes[At++];
+        Value |= (unsigned long long)(Next & 0x7F) << Shift;
+        if ( !(Next & 0x80) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
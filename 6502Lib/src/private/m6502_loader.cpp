@@ -0,0 +1,120 @@
+#include "m6502_loader.h"
+
+#include <climits>
+
+#if defined( _WIN32 )
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+m6502::MappedFile::MappedFile( const char* Path )
+{
+#if defined( _WIN32 )
+    HANDLE File = CreateFileA( Path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+    if ( File == INVALID_HANDLE_VALUE )
+    {
+        return;
+    }
+    FileHandle = File;
+    LARGE_INTEGER FileSize;
+    if ( !GetFileSizeEx( File, &FileSize ) || FileSize.QuadPart == 0 || FileSize.QuadPart > UINT_MAX )
+    {
+        return;
+    }
+    MappingHandle = CreateFileMappingA( File, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    if ( !MappingHandle )
+    {
+        return;
+    }
+    Bytes = (const Byte*)MapViewOfFile( MappingHandle, FILE_MAP_READ, 0, 0, 0 );
+    Size = Bytes ? (u32)FileSize.QuadPart : 0;
+#else
+    const int File = open( Path, O_RDONLY );
+    if ( File < 0 )
+    {
+        return;
+    }
+    struct stat Info;
+    if ( fstat( File, &Info ) == 0 && Info.st_size > 0 && (unsigned long long)Info.st_size <= 0xFFFFFFFFull )
+    {
+        void* Mapping = mmap( nullptr, Info.st_size, PROT_READ, MAP_PRIVATE, File, 0 );
+        if ( Mapping != MAP_FAILED )
+        {
+            Bytes = (const Byte*)Mapping;
+            Size = (u32)Info.st_size;
+        }
+    }
+    // The mapping keeps the file alive
+    close( File );
+#endif
+}
+
+m6502::MappedFile::~MappedFile()
+{
+#if defined( _WIN32 )
+    if ( Bytes )
+    {
+        UnmapViewOfFile( Bytes );
+    }
+    if ( MappingHandle )
+    {
+        CloseHandle( MappingHandle );
+    }
+    if ( FileHandle )
+    {
+        CloseHandle( FileHandle );
+    }
+#else
+    if ( Bytes )
+    {
+        munmap( (void*)Bytes, Size );
+    }
+#endif
+}
+
+m6502::u32 m6502::MappedFile::LoadBin( Word Address, Mem& memory ) const
+{
+    if ( !Bytes )
+    {
+        return 0;
+    }
+    return memory.Load( Bytes, Size, Address );
+}
+
+m6502::Word m6502::MappedFile::LoadPrg( Mem& memory ) const
+{
+    Word LoadAddress = 0;
+    if ( Bytes && Size > 2 )
+    {
+        LoadAddress = Bytes[0] | (Bytes[1] << 8);
+        memory.Load( Bytes + 2, Size - 2, LoadAddress );
+    }
+    return LoadAddress;
+}
+
+m6502::u32 m6502::MappedFile::MapRom( Word Address, Mem& memory ) const
+{
+    if ( !Bytes || Address % Mem::PAGE_SIZE != 0 )
+    {
+        return 0;
+    }
+
+    // The OS maps whole host pages (4 KiB or more, zero filled past the end
+    // of the file), so a last partial 256 byte page can be read in full
+    u32 NumPages = (Size + Mem::PAGE_SIZE - 1) / Mem::PAGE_SIZE;
+    const u32 FirstPage = Address / Mem::PAGE_SIZE;
+    if ( NumPages > Mem::NUM_PAGES - FirstPage )
+    {
+        NumPages = Mem::NUM_PAGES - FirstPage;
+    }
+    for ( u32 i = 0; i < NumPages; i++ )
+    {
+        // ReadOnly: the bus never writes through the pointer
+        memory.MapMemory( (Byte)(FirstPage + i), const_cast<Byte*>( Bytes + i * Mem::PAGE_SIZE ), true );
+    }
+    return NumPages;
+}
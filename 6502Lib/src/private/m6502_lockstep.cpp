@@ -0,0 +1,608 @@
+#include "m6502_lockstep.h"
+
+#include "m6502_instructions.h"
+
+namespace
+{
+    using namespace m6502;
+
+    enum class Kind : Byte {
+        Unsupported,    // Run by CPU::Interpret one lane at a time
+        Load, Store, Transfer, TransferNoFlags, Increment, Decrement,
+        And, Ora, Eor, Adc, Sbc, Compare,
+        Branch, Jump, SetFlag, ClearFlag, Nop,
+    };
+
+    enum class Mode : Byte {
+        Implied, Immediate, ZeroPage, ZeroPageX, ZeroPageY, Absolute, AbsoluteX, AbsoluteY,
+    };
+
+    enum Register : Byte { RegA, RegX, RegY, RegSP };
+
+    /* What the lanes have to do for an opcode */
+    struct LaneOp {
+        Kind Op = Kind::Unsupported;
+        Mode Addressing = Mode::Implied;
+        Register Reg = RegA;            // Loaded/stored/compared, the source of a transfer
+        Register To = RegA;             // The destination of a transfer
+        Byte FlagBit = 0;               // Branch, SetFlag, ClearFlag
+        bool Expected = false;          // Branch taken when the flag is this
+    };
+
+    /* Modes with Mode::Immediate first, then the order of Mode, 0 where there is no opcode */
+    LaneOp Group( Byte Opcode, Kind Op, Register Reg, const Byte (&Opcodes)[7] )
+    {
+        const Mode Modes[7] = { Mode::Immediate, Mode::ZeroPage, Mode::ZeroPageX, Mode::ZeroPageY,
+                                Mode::Absolute, Mode::AbsoluteX, Mode::AbsoluteY };
+        for ( u32 i = 0; i < 7; i++ )
+        {
+            if ( Opcodes[i] == Opcode && Opcodes[i] != 0 )
+            {
+                LaneOp Info;
+                Info.Op = Op;
+                Info.Addressing = Modes[i];
+                Info.Reg = Reg;
+                return Info;
+            }
+        }
+        return LaneOp();
+    }
+
+    LaneOp Describe( Byte Opcode )
+    {
+        //                           IM    ZP    ZPX   ZPY   ABS   ABSX  ABSY
+        static const Byte LDA[7] = { 0xA9, 0xA5, 0xB5, 0,    0xAD, 0xBD, 0xB9 };
+        static const Byte LDX[7] = { 0xA2, 0xA6, 0,    0xB6, 0xAE, 0,    0xBE };
+        static const Byte LDY[7] = { 0xA0, 0xA4, 0xB4, 0,    0xAC, 0xBC, 0    };
+        static const Byte STA[7] = { 0,    0x85, 0x95, 0,    0x8D, 0x9D, 0x99 };
+        static const Byte STX[7] = { 0,    0x86, 0,    0x96, 0x8E, 0,    0    };
+        static const Byte STY[7] = { 0,    0x84, 0x94, 0,    0x8C, 0,    0    };
+        static const Byte AND[7] = { 0x29, 0x25, 0x35, 0,    0x2D, 0x3D, 0x39 };
+        static const Byte ORA[7] = { 0x09, 0x05, 0x15, 0,    0x0D, 0x1D, 0x19 };
+        static const Byte EOR[7] = { 0x49, 0x45, 0x55, 0,    0x4D, 0x5D, 0x59 };
+        static const Byte ADC[7] = { 0x69, 0x65, 0x75, 0,    0x6D, 0x7D, 0x79 };
+        static const Byte SBC[7] = { 0xE9, 0xE5, 0xF5, 0,    0xED, 0xFD, 0xF9 };
+        static const Byte CMP[7] = { 0xC9, 0xC5, 0xD5, 0,    0xCD, 0xDD, 0xD9 };
+        static const Byte CPX[7] = { 0xE0, 0xE4, 0,    0,    0xEC, 0,    0    };
+        static const Byte CPY[7] = { 0xC0, 0xC4, 0,    0,    0xCC, 0,    0    };
+
+        const LaneOp Groups[] = {
+            Group( Opcode, Kind::Load, RegA, LDA ),     Group( Opcode, Kind::Load, RegX, LDX ),
+            Group( Opcode, Kind::Load, RegY, LDY ),     Group( Opcode, Kind::Store, RegA, STA ),
+            Group( Opcode, Kind::Store, RegX, STX ),    Group( Opcode, Kind::Store, RegY, STY ),
+            Group( Opcode, Kind::And, RegA, AND ),      Group( Opcode, Kind::Ora, RegA, ORA ),
+            Group( Opcode, Kind::Eor, RegA, EOR ),      Group( Opcode, Kind::Adc, RegA, ADC ),
+            Group( Opcode, Kind::Sbc, RegA, SBC ),      Group( Opcode, Kind::Compare, RegA, CMP ),
+            Group( Opcode, Kind::Compare, RegX, CPX ),  Group( Opcode, Kind::Compare, RegY, CPY ),
+        };
+        for ( const LaneOp& Info : Groups )
+        {
+            if ( Info.Op != Kind::Unsupported )
+            {
+                return Info;
+            }
+        }
+
+        LaneOp Info;
+        auto Transfer = [&]( Kind Op, Register From, Register To ) {
+            Info.Op = Op;
+            Info.Reg = From;
+            Info.To = To;
+        };
+        auto Flag = [&]( Kind Op, Byte FlagBit, bool Expected ) {
+            Info.Op = Op;
+            Info.FlagBit = FlagBit;
+            Info.Expected = Expected;
+        };
+        switch ( Opcode )
+        {
+            case CPU::INS_TAX: Transfer( Kind::Transfer, RegA, RegX ); break;
+            case CPU::INS_TAY: Transfer( Kind::Transfer, RegA, RegY ); break;
+            case CPU::INS_TXA: Transfer( Kind::Transfer, RegX, RegA ); break;
+            case CPU::INS_TYA: Transfer( Kind::Transfer, RegY, RegA ); break;
+            case CPU::INS_TSX: Transfer( Kind::Transfer, RegSP, RegX ); break;
+            case CPU::INS_TXS: Transfer( Kind::TransferNoFlags, RegX, RegSP ); break;
+            case CPU::INS_INX: Transfer( Kind::Increment, RegX, RegX ); break;
+            case CPU::INS_INY: Transfer( Kind::Increment, RegY, RegY ); break;
+            case CPU::INS_DEX: Transfer( Kind::Decrement, RegX, RegX ); break;
+            case CPU::INS_DEY: Transfer( Kind::Decrement, RegY, RegY ); break;
+            case CPU::INS_BPL: Flag( Kind::Branch, CPU::NegativeFlagBit, false ); break;
+            case CPU::INS_BMI: Flag( Kind::Branch, CPU::NegativeFlagBit, true ); break;
+            case CPU::INS_BVC: Flag( Kind::Branch, CPU::OverflowFlagBit, false ); break;
+            case CPU::INS_BVS: Flag( Kind::Branch, CPU::OverflowFlagBit, true ); break;
+            case CPU::INS_BCC: Flag( Kind::Branch, CPU::CarryFlagBit, false ); break;
+            case CPU::INS_BCS: Flag( Kind::Branch, CPU::CarryFlagBit, true ); break;
+            case CPU::INS_BNE: Flag( Kind::Branch, CPU::ZeroFlagBit, false ); break;
+            case CPU::INS_BEQ: Flag( Kind::Branch, CPU::ZeroFlagBit, true ); break;
+            case CPU::INS_CLC: Flag( Kind::ClearFlag, CPU::CarryFlagBit, false ); break;
+            case CPU::INS_SEC: Flag( Kind::SetFlag, CPU::CarryFlagBit, true ); break;
+            case CPU::INS_CLD: Flag( Kind::ClearFlag, CPU::DecimalModeFlagBit, false ); break;
+            case CPU::INS_SED: Flag( Kind::SetFlag, CPU::DecimalModeFlagBit, true ); break;
+            case CPU::INS_CLI: Flag( Kind::ClearFlag, CPU::InterruptDisableFlagBit, false ); break;
+            case CPU::INS_SEI: Flag( Kind::SetFlag, CPU::InterruptDisableFlagBit, true ); break;
+            case CPU::INS_CLV: Flag( Kind::ClearFlag, CPU::OverflowFlagBit, false ); break;
+            case CPU::INS_JMP_ABS: Info.Op = Kind::Jump; Info.Addressing = Mode::Absolute; break;
+            case CPU::INS_NOP: Info.Op = Kind::Nop; break;
+            default: break;
+        }
+        return Info;
+    }
+
+    struct DecodeTable {
+        LaneOp Ops[256];
+        DecodeTable() {
+            for ( u32 Opcode = 0; Opcode < 256; Opcode++ )
+            {
+                Ops[Opcode] = Describe( (Byte)Opcode );
+            }
+        }
+    };
+
+    /* Only reads pay for crossing a page, stores have it in their base cycles */
+    bool ChargesPageCross( const LaneOp& Info )
+    {
+        return Info.Op != Kind::Store &&
+            ( Info.Addressing == Mode::AbsoluteX || Info.Addressing == Mode::AbsoluteY );
+    }
+}
+
+template<m6502::u32 NumLanes>
+m6502::LockstepEngine<NumLanes>::LockstepEngine( const Byte* Image )
+    : Image( Image )
+{
+    for ( u32 i = 0; i < NumLanes; i++ )
+    {
+        Lane& L = Lanes[i];
+        L.memory = std::make_unique<Mem>();
+        L.Engine = this;
+        L.Index = i;
+        L.cpu.Reset();
+        L.cpu.PS = 0;
+
+        Mem::PageHandler CopyPage;
+        CopyPage.Write = &CopyOnWrite;
+        CopyPage.Context = &L;
+        for ( u32 Page = 0; Page < Mem::NUM_PAGES; Page++ )
+        {
+            // Reads come straight from the image, the bus never writes through it
+            L.memory->Map( (Byte)Page, const_cast<Byte*>( Image + Page * Mem::PAGE_SIZE ), nullptr, CopyPage );
+        }
+    }
+}
+
+template<m6502::u32 NumLanes>
+void m6502::LockstepEngine<NumLanes>::CopyOnWrite( void* Context, Word Address, Byte Value )
+{
+    Lane& L = *static_cast<Lane*>( Context );
+    Mem& memory = *L.memory;
+    const u32 Page = Address / Mem::PAGE_SIZE;
+    memcpy( memory.Data + Page * Mem::PAGE_SIZE, L.Engine->Image + Page * Mem::PAGE_SIZE, Mem::PAGE_SIZE );
+    memory.UnmapPage( (Byte)Page );
+    memory.Data[Address] = Value;
+    L.NumPrivatePages++;
+    L.Engine->PrivatePagesOf[Page]++;
+}
+
+template<m6502::u32 NumLanes>
+m6502::Byte m6502::LockstepEngine<NumLanes>::ReadLane( u32 Lane, Word Address ) const
+{
+    const Mem& memory = *Lanes[Lane].memory;
+    const Byte* From = memory.ReadPages[Address / Mem::PAGE_SIZE];
+    return From ? From[Address % Mem::PAGE_SIZE] : memory.ReadSlow( Address );
+}
+
+template<m6502::u32 NumLanes>
+void m6502::LockstepEngine<NumLanes>::WriteLane( u32 Lane, Word Address, Byte Value )
+{
+    Mem& memory = *Lanes[Lane].memory;
+    Byte* To = memory.WritePages[Address / Mem::PAGE_SIZE];
+    if ( To )
+    {
+        memory.NoteWrite( Address );
+        To[Address % Mem::PAGE_SIZE] = Value;
+        return;
+    }
+    memory.WriteSlow( Address, Value );
+}
+
+template<m6502::u32 NumLanes>
+m6502::u32 m6502::LockstepEngine<NumLanes>::Run( s32 Cycles )
+{
+    RunCycles = Cycles;
+    SplitLanes.clear();
+    Thrown = nullptr;
+
+    PC = Lanes[0].cpu.PC;
+    for ( u32 i = 0; i < NumLanes; i++ )
+    {
+        const CPU& cpu = Lanes[i].cpu;
+        A[i] = cpu.A;
+        X[i] = cpu.X;
+        Y[i] = cpu.Y;
+        SP[i] = cpu.SP;
+        PS[i] = cpu.PS;
+        CyclesLeft[i] = Cycles;
+        Active[i] = 0xFF;
+        if ( cpu.PC != PC || cpu.PendingEvents )
+        {
+            Leave( i, cpu.PC, true );
+        }
+    }
+
+    while ( true )
+    {
+        // Like CPU::Execute each lane stops once its cycles are used up
+        u32 NumActive = 0;
+        for ( u32 i = 0; i < NumLanes; i++ )
+        {
+            if ( Active[i] && CyclesLeft[i] <= 0 )
+            {
+                Leave( i, PC, false );
+            }
+            NumActive += Active[i] & 1;
+        }
+        if ( NumActive == 0 )
+        {
+            break;
+        }
+        Step();
+    }
+
+    for ( u32 i : SplitLanes )
+    {
+        Lane& L = Lanes[i];
+        if ( CyclesLeft[i] <= 0 )
+        {
+            continue;
+        }
+        try
+        {
+            L.CyclesUsed += L.cpu.Execute( CyclesLeft[i], *L.memory );
+        }
+        catch ( ... )
+        {
+            if ( !Thrown )
+            {
+                Thrown = std::current_exception();
+            }
+        }
+    }
+
+    if ( Thrown )
+    {
+        std::rethrow_exception( Thrown );
+    }
+    return NumLanes - (u32)SplitLanes.size();
+}
+
+template<m6502::u32 NumLanes>
+void m6502::LockstepEngine<NumLanes>::Leave( u32 Lane, Word LanePC, bool Split )
+{
+    Active[Lane] = 0;
+    CPU& cpu = Lanes[Lane].cpu;
+    cpu.PC = LanePC;
+    cpu.A = A[Lane];
+    cpu.X = X[Lane];
+    cpu.Y = Y[Lane];
+    cpu.SP = SP[Lane];
+    cpu.PS = PS[Lane];
+    Lanes[Lane].CyclesUsed = RunCycles - CyclesLeft[Lane];
+    if ( Split )
+    {
+        SplitLanes.push_back( Lane );
+    }
+}
+
+template<m6502::u32 NumLanes>
+void m6502::LockstepEngine<NumLanes>::SplitFrom( const Word* LanePCs )
+{
+    // The PC most lanes are at stays in lockstep
+    u32 BestCount = 0;
+    Word BestPC = PC;
+    for ( u32 i = 0; i < NumLanes; i++ )
+    {
+        if ( !Active[i] )
+        {
+            continue;
+        }
+        u32 Count = 0;
+        for ( u32 j = 0; j < NumLanes; j++ )
+        {
+            Count += Active[j] && LanePCs[j] == LanePCs[i];
+        }
+        if ( Count > BestCount )
+        {
+            BestCount = Count;
+            BestPC = LanePCs[i];
+        }
+    }
+
+    for ( u32 i = 0; i < NumLanes; i++ )
+    {
+        if ( Active[i] && LanePCs[i] != BestPC )
+        {
+            Leave( i, LanePCs[i], true );
+        }
+    }
+    PC = BestPC;
+}
+
+template<m6502::u32 NumLanes>
+void m6502::LockstepEngine<NumLanes>::StepEachLane()
+{
+    Word LanePCs[NumLanes] = {};
+    for ( u32 i = 0; i < NumLanes; i++ )
+    {
+        if ( !Active[i] )
+        {
+            continue;
+        }
+        CPU& cpu = Lanes[i].cpu;
+        cpu.PC = PC;
+        cpu.A = A[i];
+        cpu.X = X[i];
+        cpu.Y = Y[i];
+        cpu.SP = SP[i];
+        cpu.PS = PS[i];
+        try
+        {
+            CyclesLeft[i] -= cpu.Interpret( 1, *Lanes[i].memory );
+        }
+        catch ( ... )
+        {
+            // The lane stops where the interpreter left it
+            if ( !Thrown )
+            {
+                Thrown = std::current_exception();
+            }
+            Active[i] = 0;
+            Lanes[i].CyclesUsed = RunCycles - CyclesLeft[i];
+            continue;
+        }
+        A[i] = cpu.A;
+        X[i] = cpu.X;
+        Y[i] = cpu.Y;
+        SP[i] = cpu.SP;
+        PS[i] = cpu.PS;
+        LanePCs[i] = cpu.PC;
+        if ( cpu.PendingEvents )
+        {
+            // Trapped (HaltOnTrap), CPU::Execute stops it on its own
+            Leave( i, cpu.PC, true );
+        }
+    }
+    SplitFrom( LanePCs );
+}
+
+template<m6502::u32 NumLanes>
+void m6502::LockstepEngine<NumLanes>::Step()
+{
+    static const DecodeTable Decode;
+
+    // Code comes from the image, a lane with its own copy of the page (code
+    // and data share pages) must still hold the same bytes
+    const Word OperandAt = PC + 1;
+    const Word OperandEnd = PC + 2;
+    if ( PrivatePagesOf[PC / Mem::PAGE_SIZE] || PrivatePagesOf[OperandEnd / Mem::PAGE_SIZE] )
+    {
+        bool Differs = false;
+        for ( u32 i = 0; i < NumLanes && !Differs; i++ )
+        {
+            Differs = Active[i] && ( ReadLane( i, PC ) != Image[PC] ||
+                                     ReadLane( i, OperandAt ) != Image[OperandAt] ||
+                                     ReadLane( i, OperandEnd ) != Image[OperandEnd] );
+        }
+        if ( Differs )
+        {
+            StepEachLane();
+            return;
+        }
+    }
+    const Byte Opcode = Image[PC];
+    const LaneOp& Info = Decode.Ops[Opcode];
+    const Word Operand = Image[OperandAt] | (Image[OperandEnd] << 8);
+    const Word Next = PC + Instructions::Dispatch[Opcode].Length;
+    const s32 BaseCycles = Instructions::Dispatch[Opcode].BaseCycles;
+
+    const bool IsTrap = (Info.Op == Kind::Jump && Operand == PC) ||
+                        (Info.Op == Kind::Branch && (Operand & 0xFF) == 0xFE);
+    if ( Info.Op == Kind::Unsupported || IsTrap )
+    {
+        StepEachLane();
+        return;
+    }
+    if ( Info.Op == Kind::Adc || Info.Op == Kind::Sbc )
+    {
+        // Decimal mode is left to the interpreter
+        Byte AnyDecimal = 0;
+        for ( u32 i = 0; i < NumLanes; i++ )
+        {
+            AnyDecimal |= PS[i] & Active[i] & CPU::DecimalModeFlagBit;
+        }
+        if ( AnyDecimal )
+        {
+            StepEachLane();
+            return;
+        }
+    }
+
+    Byte* const Registers[] = { A, X, Y, SP };
+    Byte* const Reg = Registers[Info.Reg];
+
+    // Effective address and page crossing for each lane
+    Word Address[NumLanes];
+    Byte Crossed[NumLanes];
+    const Byte* Index = Info.Addressing == Mode::ZeroPageX || Info.Addressing == Mode::AbsoluteX ? X : Y;
+    for ( u32 i = 0; i < NumLanes; i++ )
+    {
+        switch ( Info.Addressing )
+        {
+            case Mode::ZeroPage:
+                Address[i] = Operand & 0xFF;
+                break;
+            case Mode::ZeroPageX:
+            case Mode::ZeroPageY:
+                Address[i] = (Operand + Index[i]) & 0xFF;
+                break;
+            case Mode::AbsoluteX:
+            case Mode::AbsoluteY:
+                Address[i] = Operand + Index[i];
+                break;
+            default:
+                Address[i] = Operand;
+                break;
+        }
+        Crossed[i] = ((Address[i] ^ Operand) >> 8) != 0;
+    }
+
+    Byte Value[NumLanes];
+    if ( Info.Addressing == Mode::Immediate )
+    {
+        for ( u32 i = 0; i < NumLanes; i++ )
+        {
+            Value[i] = (Byte)Operand;
+        }
+    }
+    else if ( Info.Addressing != Mode::Implied && Info.Op != Kind::Store && Info.Op != Kind::Jump )
+    {
+        for ( u32 i = 0; i < NumLanes; i++ )
+        {
+            Value[i] = Active[i] ? ReadLane( i, Address[i] ) : 0;
+        }
+    }
+
+    // Everything below only changes the active lanes, Active is 0xFF or 0
+    auto Set = [&]( Byte* Target, const Byte* From ) {
+        for ( u32 i = 0; i < NumLanes; i++ )
+        {
+            Target[i] = (Target[i] & ~Active[i]) | (From[i] & Active[i]);
+        }
+    };
+    auto SetZeroAndNegative = [&]( const Byte* From ) {
+        for ( u32 i = 0; i < NumLanes; i++ )
+        {
+            const Byte Flags = (From[i] & CPU::NegativeFlagBit) | (From[i] == 0 ? CPU::ZeroFlagBit : 0);
+            const Byte NewPS = (PS[i] & ~(CPU::NegativeFlagBit | CPU::ZeroFlagBit)) | Flags;
+            PS[i] = (PS[i] & ~Active[i]) | (NewPS & Active[i]);
+        }
+    };
+
+    Byte Result[NumLanes];
+    s32 ExtraCycles[NumLanes] = {};
+    switch ( Info.Op )
+    {
+        case Kind::Load:
+            Set( Reg, Value );
+            SetZeroAndNegative( Reg );
+            break;
+
+        case Kind::Store:
+            for ( u32 i = 0; i < NumLanes; i++ )
+            {
+                if ( Active[i] )
+                {
+                    WriteLane( i, Address[i], Reg[i] );
+                }
+            }
+            break;
+
+        case Kind::Transfer:
+            Set( Registers[Info.To], Reg );
+            SetZeroAndNegative( Registers[Info.To] );
+            break;
+
+        case Kind::TransferNoFlags:
+            Set( Registers[Info.To], Reg );
+            break;
+
+        case Kind::Increment:
+        case Kind::Decrement:
+            for ( u32 i = 0; i < NumLanes; i++ )
+            {
+                Result[i] = Reg[i] + (Info.Op == Kind::Increment ? 1 : -1);
+            }
+            Set( Reg, Result );
+            SetZeroAndNegative( Reg );
+            break;
+
+        case Kind::And:
+        case Kind::Ora:
+        case Kind::Eor:
+            for ( u32 i = 0; i < NumLanes; i++ )
+            {
+                Result[i] = Info.Op == Kind::And ? A[i] & Value[i] :
+                            Info.Op == Kind::Ora ? A[i] | Value[i] : A[i] ^ Value[i];
+            }
+            Set( A, Result );
+            SetZeroAndNegative( A );
+            break;
+
+        case Kind::Adc:
+        case Kind::Sbc:
+            // See Instructions::AddWithCarry
+            for ( u32 i = 0; i < NumLanes; i++ )
+            {
+                const Byte Operand = Info.Op == Kind::Adc ? Value[i] : (Byte)~Value[i];
+                const Word Sum = A[i] + Operand + (PS[i] & CPU::CarryFlagBit);
+                const Byte Sum8 = (Byte)Sum;
+                const bool Overflow = !((A[i] ^ Operand) & 0x80) && ((Sum8 ^ Operand) & 0x80);
+                Result[i] = Sum8;
+                const Byte NewPS = (PS[i] & ~(CPU::CarryFlagBit | CPU::OverflowFlagBit)) |
+                    (Sum > 0xFF ? CPU::CarryFlagBit : 0) | (Overflow ? CPU::OverflowFlagBit : 0);
+                PS[i] = (PS[i] & ~Active[i]) | (NewPS & Active[i]);
+            }
+            Set( A, Result );
+            SetZeroAndNegative( A );
+            break;
+
+        case Kind::Compare:
+            for ( u32 i = 0; i < NumLanes; i++ )
+            {
+                Result[i] = Reg[i] - Value[i];
+                const Byte NewPS = (PS[i] & ~CPU::CarryFlagBit) | (Reg[i] >= Value[i] ? CPU::CarryFlagBit : 0);
+                PS[i] = (PS[i] & ~Active[i]) | (NewPS & Active[i]);
+            }
+            SetZeroAndNegative( Result );
+            break;
+
+        case Kind::SetFlag:
+        case Kind::ClearFlag:
+            for ( u32 i = 0; i < NumLanes; i++ )
+            {
+                const Byte NewPS = Info.Op == Kind::SetFlag ? PS[i] | Info.FlagBit : PS[i] & ~Info.FlagBit;
+                PS[i] = (PS[i] & ~Active[i]) | (NewPS & Active[i]);
+            }
+            break;
+
+        case Kind::Branch:
+        {
+            // See Instructions::BranchIf
+            const Word Target = Next + (SByte)Operand;
+            const s32 TakenCycles = (Target >> 8) != (Next >> 8) ? 2 : 1;
+            Word LanePCs[NumLanes];
+            for ( u32 i = 0; i < NumLanes; i++ )
+            {
+                const bool Taken = ((PS[i] & Info.FlagBit) != 0) == Info.Expected;
+                LanePCs[i] = Taken ? Target : Next;
+                ExtraCycles[i] = Taken ? TakenCycles : 0;
+                CyclesLeft[i] -= Active[i] ? BaseCycles + ExtraCycles[i] : 0;
+            }
+            SplitFrom( LanePCs );
+            return;
+        }
+
+        default:
+            break;
+    }
+
+    const bool PageCrossCosts = ChargesPageCross( Info );
+    for ( u32 i = 0; i < NumLanes; i++ )
+    {
+        CyclesLeft[i] -= Active[i] ? BaseCycles + (PageCrossCosts ? Crossed[i] : 0) : 0;
+    }
+    PC = Info.Op == Kind::Jump ? Operand : Next;
+}
+
+template struct m6502::LockstepEngine<8>;
+template struct m6502::LockstepEngine<16>;
+template struct m6502::LockstepEngine<32>;
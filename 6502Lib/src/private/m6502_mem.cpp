@@ -0,0 +1,35 @@
+#include "m6502.h"
+#include <atomic>
+
+// The page table side of Mem::Read and Mem::Write, kept out of m6502.cpp so
+// it is not inlined into every memory access of CPU::Interpret
+
+m6502::Byte m6502::Mem::ReadSlow( Word Address ) const
+{
+    const Byte* From = ReadPages[Address / PAGE_SIZE];
+    if ( From )
+    {
+        return From[Address % PAGE_SIZE];
+    }
+    const PageHandler& Handler = Handlers[Address / PAGE_SIZE];
+    return Handler.Read( Handler.Context, Address );
+}
+
+void m6502::Mem::WriteSlow( Word Address, Byte Value )
+{
+    NoteWrite( Address );
+    Byte* To = WritePages[Address / PAGE_SIZE];
+    if ( To )
+    {
+        To[Address % PAGE_SIZE] = Value;
+        return;
+    }
+    const PageHandler& Handler = Handlers[Address / PAGE_SIZE];
+    Handler.Write( Handler.Context, Address, Value );
+}
+
+unsigned long long m6502::Mem::NewIdentity()
+{
+    static std::atomic<unsigned long long> Last{ 0 };
+    return ++Last;
+}
@@ -0,0 +1,102 @@
+#include "m6502_pairprofile.h"
+#include <algorithm>
+
+m6502::PairProfile::PairProfile()
+    : Counts( 256 * 256, 0 )
+{
+}
+
+m6502::s32 m6502::PairProfile::Execute( s32 Cycles, CPU& cpu, Mem& memory )
+{
+    const s32 CyclesRequested = Cycles;
+    while ( Cycles > 0 )
+    {
+        if ( cpu.PendingEvents )
+        {
+            // Taken here so Interpret only ever runs the opcode we read. The
+            // handler's first opcode doesn't follow the one before it
+            const Word PC = cpu.PC;
+            const bool Continue = cpu.ServicePendingEvents( Cycles, memory );
+            if ( cpu.PC != PC )
+            {
+                Previous = NO_PREVIOUS;
+            }
+            if ( !Continue )
+            {
+                break;
+            }
+        }
+
+        const Byte Opcode = memory.Read( cpu.PC );
+        Cycles -= cpu.Interpret( 1, memory );
+        if ( cpu.Halted != CPU::HaltReason::None )
+        {
+            // A trap or breakpoint, the opcode at PC did not run
+            break;
+        }
+
+        if ( Previous != NO_PREVIOUS )
+        {
+            Counts[Previous << 8 | Opcode]++;
+        }
+        Previous = Opcode;
+        InstructionCount++;
+    }
+    return CyclesRequested - Cycles;
+}
+
+std::vector<m6502::PairProfile::Pair> m6502::PairProfile::Top( u32 NumPairs ) const
+{
+    std::vector<Pair> Best;
+    for ( u32 First = 0; First < 256; First++ )
+    {
+        Pair Most{ (Byte)First, 0, 0 };
+        for ( u32 Second = 0; Second < 256; Second++ )
+        {
+            if ( Counts[First << 8 | Second] > Most.Count )
+            {
+                Most.Second = (Byte)Second;
+                Most.Count = Counts[First << 8 | Second];
+            }
+        }
+        if ( Most.Count > 0 )
+        {
+            Best.push_back( Most );
+        }
+    }
+
+    std::sort( Best.begin(), Best.end(), []( const Pair& A, const Pair& B ) {
+        return A.Count > B.Count;
+    } );
+    if ( Best.size() > NumPairs )
+    {
+        Best.resize( NumPairs );
+    }
+    return Best;
+}
+
+bool m6502::PairProfile::WriteFusedPairs( const char* Path, u32 NumPairs ) const
+{
+    FILE* File = fopen( Path, "w" );
+    if ( !File )
+    {
+        return false;
+    }
+
+    fprintf( File, "/* Written by PairProfile::WriteFusedPairs from %llu instructions.\n", InstructionCount );
+    fprintf( File, "*  M6502_FUSED_PAIR( First, Second ), the share of the instructions\n" );
+    fprintf( File, "*  that were First followed by Second */\n" );
+    for ( const Pair& Fused : Top( NumPairs ) )
+    {
+        const double Share = InstructionCount ? 100.0 * Fused.Count / InstructionCount : 0.0;
+        fprintf( File, "M6502_FUSED_PAIR( 0x%02X, 0x%02X )     // %5.2f%%\n", Fused.First, Fused.Second, Share );
+    }
+    return fclose( File ) == 0;
+}
+
+void m6502::PairProfile::Clear()
+{
+    std::fill( Counts.begin(), Counts.end(), 0 );
+    InstructionCount = 0;
+    Previous = NO_PREVIOUS;
+}
@@ -0,0 +1,121 @@
+#include "m6502_pcprofile.h"
+#include <algorithm>
+#include <map>
+
+m6502::PcProfile::PcProfile()
+    : Counters( Mem::MAX_MEM )
+{
+}
+
+m6502::s32 m6502::PcProfile::Execute( s32 Cycles, CPU& cpu, Mem& memory )
+{
+    const s32 CyclesRequested = Cycles;
+    while ( Cycles > 0 )
+    {
+        if ( cpu.PendingEvents )
+        {
+            // Taken here so Interpret only ever runs the instruction
+            const s32 CyclesBefore = Cycles;
+            const bool Continue = cpu.ServicePendingEvents( Cycles, memory );
+            InterruptCycleCount += CyclesBefore - Cycles;
+            if ( !Continue )
+            {
+                break;
+            }
+        }
+
+        const Word Address = cpu.PC;
+        const s32 CyclesUsed = cpu.Interpret( 1, memory );
+        if ( cpu.Halted != CPU::HaltReason::None )
+        {
+            // Stopped before the instruction (a breakpoint), nothing ran
+            break;
+        }
+        Counters[Address].Instructions++;
+        Counters[Address].Cycles += CyclesUsed;
+        Cycles -= CyclesUsed;
+    }
+
+    const s32 NumCyclesUsed = CyclesRequested - Cycles;
+    TotalCycleCount += NumCyclesUsed;
+    return NumCyclesUsed;
+}
+
+std::vector<m6502::PcProfile::HotSpot> m6502::PcProfile::MostCycles( std::vector<HotSpot> Spots, u32 NumSpots )
+{
+    std::sort( Spots.begin(), Spots.end(), []( const HotSpot& A, const HotSpot& B ) {
+        return A.Cycles != B.Cycles ? A.Cycles > B.Cycles : A.Address < B.Address;
+    } );
+    if ( Spots.size() > NumSpots )
+    {
+        Spots.resize( NumSpots );
+    }
+    return Spots;
+}
+
+std::vector<m6502::PcProfile::HotSpot> m6502::PcProfile::HotSpots( u32 NumSpots ) const
+{
+    std::vector<HotSpot> Spots;
+    for ( u32 Address = 0; Address < Mem::MAX_MEM; Address++ )
+    {
+        if ( Counters[Address].Instructions )
+        {
+            Spots.push_back( { (Word)Address, Counters[Address].Instructions, Counters[Address].Cycles, std::string() } );
+        }
+    }
+    Spots = MostCycles( std::move( Spots ), NumSpots );
+    for ( HotSpot& Spot : Spots )
+    {
+        Spot.Symbol = SymbolFor( Spot.Address );
+    }
+    return Spots;
+}
+
+std::vector<m6502::PcProfile::HotSpot> m6502::PcProfile::HotSymbols( u32 NumSpots ) const
+{
+    std::map<Word, HotSpot> PerLabel;
+    for ( u32 Address = 0; Address < Mem::MAX_MEM; Address++ )
+    {
+        const SymbolTable::Label* Label = Counters[Address].Instructions ? Symbols.Closest( (Word)Address ) : nullptr;
+        if ( !Label )
+        {
+            continue;
+        }
+        HotSpot& Spot = PerLabel.try_emplace( Label->first, HotSpot{ Label->first, 0, 0, Label->second } ).first->second;
+        Spot.Instructions += Counters[Address].Instructions;
+        Spot.Cycles += Counters[Address].Cycles;
+    }
+
+    std::vector<HotSpot> Spots;
+    for ( auto& [LabelAddress, Spot] : PerLabel )
+    {
+        Spots.push_back( std::move( Spot ) );
+    }
+    return MostCycles( std::move( Spots ), NumSpots );
+}
+
+void m6502::PcProfile::WriteReport( FILE* File, u32 NumSpots ) const
+{
+    const double Total = TotalCycleCount ? (double)TotalCycleCount : 1.0;
+    fprintf( File, "%llu cycles, %llu taking interrupts\n", TotalCycleCount, InterruptCycleCount );
+    if ( !Symbols.IsEmpty() )
+    {
+        fprintf( File, "\n%-24s %6s %14s %14s\n", "label", "%", "cycles", "instructions" );
+        for ( const HotSpot& Spot : HotSymbols( NumSpots ) )
+        {
+            fprintf( File, "%-24s %6.2f %14llu %14llu\n", Spot.Symbol.c_str(), 100.0 * Spot.Cycles / Total, Spot.Cycles, Spot.Instructions );
+        }
+    }
+    fprintf( File, "\n%-7s %-24s %6s %14s %14s\n", "address", "symbol", "%", "cycles", "instructions" );
+    for ( const HotSpot& Spot : HotSpots( NumSpots ) )
+    {
+        fprintf( File, "$%04X   %-24s %6.2f %14llu %14llu\n", Spot.Address, Spot.Symbol.c_str(), 100.0 * Spot.Cycles / Total, Spot.Cycles, Spot.Instructions );
+    }
+}
+
+void m6502::PcProfile::Clear()
+{
+    std::fill( Counters.begin(), Counters.end(), Counter() );
+    InterruptCycleCount = 0;
+    TotalCycleCount = 0;
+}
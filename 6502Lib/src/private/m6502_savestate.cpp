@@ -0,0 +1,221 @@
+#include "m6502_savestate.h"
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    using namespace m6502;
+
+    constexpr Byte MAGIC[8] = { 'M', '6', '5', '0', '2', 'S', 'S', 0x1A };
+
+    void PutWord( Byte* To, Word Value )
+    {
+        To[0] = Value & 0xFF;
+        To[1] = Value >> 8;
+    }
+
+    void PutU32( Byte* To, u32 Value )
+    {
+        PutWord( To, Value & 0xFFFF );
+        PutWord( To + 2, Value >> 16 );
+    }
+
+    Word GetWord( const Byte* From )
+    {
+        return From[0] | (From[1] << 8);
+    }
+
+    u32 GetU32( const Byte* From )
+    {
+        return GetWord( From ) | ((u32)GetWord( From + 2 ) << 16);
+    }
+
+    bool IsZero( const Byte* Page )
+    {
+        for ( u32 i = 0; i < Mem::PAGE_SIZE; i++ )
+        {
+            if ( Page[i] )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /* Check the header and set the registers, interrupt lines and Cycles
+    *  @return the number of stored pages, or -1 if it is not a save state we can read */
+    long long ReadHeader( const Byte* Header, CPU& cpu, unsigned long long* Cycles )
+    {
+        if ( memcmp( Header, MAGIC, sizeof(MAGIC) ) != 0 || GetU32( Header + 8 ) > SaveState::VERSION )
+        {
+            return -1;
+        }
+        const u32 NumStored = GetU32( Header + 12 );
+        for ( u32 Page = 0; Page < Mem::NUM_PAGES; Page++ )
+        {
+            const Word Index = GetWord( Header + 32 + Page * 2 );
+            if ( Index != SaveState::ZERO_PAGE && Index >= NumStored )
+            {
+                return -1;
+            }
+        }
+        *Cycles = GetU32( Header + 16 ) | (unsigned long long)GetU32( Header + 20 ) << 32;
+        cpu.PC = GetWord( Header + 24 );
+        cpu.SP = Header[26];
+        cpu.A = Header[27];
+        cpu.X = Header[28];
+        cpu.Y = Header[29];
+        cpu.PS = Header[30];
+        cpu.PendingEvents &= ~(CPU::PendingIrq | CPU::PendingNmi);
+        if ( Header[31] & SaveState::IRQ_HELD )
+        {
+            cpu.PendingEvents |= CPU::PendingIrq;
+        }
+        if ( Header[31] & SaveState::NMI_LATCHED )
+        {
+            cpu.PendingEvents |= CPU::PendingNmi;
+        }
+        return NumStored;
+    }
+}
+
+bool m6502::SaveState::Write( FILE* File, const CPU& cpu, const Mem& memory, unsigned long long Cycles )
+{
+    Byte Header[HEADER_SIZE] = {};
+    memcpy( Header, MAGIC, sizeof(MAGIC) );
+    PutU32( Header + 8, VERSION );
+    PutU32( Header + 16, (u32)Cycles );
+    PutU32( Header + 20, (u32)(Cycles >> 32) );
+    PutWord( Header + 24, cpu.PC );
+    Header[26] = cpu.SP;
+    Header[27] = cpu.A;
+    Header[28] = cpu.X;
+    Header[29] = cpu.Y;
+    Header[30] = cpu.PS;
+    Header[31] = ((cpu.PendingEvents & CPU::PendingIrq) ? IRQ_HELD : 0)
+        | ((cpu.PendingEvents & CPU::PendingNmi) ? NMI_LATCHED : 0);
+
+    Byte Stored[Mem::NUM_PAGES];
+    u32 NumStored = 0;
+    for ( u32 Page = 0; Page < Mem::NUM_PAGES; Page++ )
+    {
+        const Byte* Bytes = memory.Data + Page * Mem::PAGE_SIZE;
+        Word Index = ZERO_PAGE;
+        if ( NumStored > 0 && memcmp( Bytes, memory.Data + Stored[NumStored - 1] * Mem::PAGE_SIZE, Mem::PAGE_SIZE ) == 0 )
+        {
+            Index = NumStored - 1;
+        }
+        else if ( !IsZero( Bytes ) )
+        {
+            Stored[NumStored] = (Byte)Page;
+            Index = NumStored++;
+        }
+        PutWord( Header + 32 + Page * 2, Index );
+    }
+    PutU32( Header + 12, NumStored );
+
+    if ( fwrite( Header, 1, HEADER_SIZE, File ) != HEADER_SIZE )
+    {
+        return false;
+    }
+    for ( u32 i = 0; i < NumStored; i++ )
+    {
+        if ( fwrite( memory.Data + Stored[i] * Mem::PAGE_SIZE, 1, Mem::PAGE_SIZE, File ) != Mem::PAGE_SIZE )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool m6502::SaveState::Read( FILE* File, CPU& cpu, Mem& memory, unsigned long long* Cycles )
+{
+    Byte Header[HEADER_SIZE];
+    if ( fread( Header, 1, HEADER_SIZE, File ) != HEADER_SIZE )
+    {
+        return false;
+    }
+    CPU Registers = cpu;
+    unsigned long long CyclesRead = 0;
+    const long long NumStored = ReadHeader( Header, Registers, &CyclesRead );
+    if ( NumStored < 0 )
+    {
+        return false;
+    }
+
+    // The stored pages can be in any order, go through them as they come
+    // with the pages using each one sorted by its index. Everything is
+    // built in Ram so a short file leaves cpu and memory alone
+    Byte ByIndex[Mem::NUM_PAGES];
+    for ( u32 Page = 0; Page < Mem::NUM_PAGES; Page++ )
+    {
+        ByIndex[Page] = (Byte)Page;
+    }
+    std::stable_sort( ByIndex, ByIndex + Mem::NUM_PAGES, [&Header]( Byte A, Byte B ) {
+        return GetWord( Header + 32 + A * 2 ) < GetWord( Header + 32 + B * 2 );
+    } );
+
+    std::vector<Byte> Ram( Mem::MAX_MEM, 0 );
+    Byte Stored[Mem::PAGE_SIZE];
+    u32 Next = 0;
+    for ( long long Index = 0; Index < NumStored; Index++ )
+    {
+        if ( fread( Stored, 1, Mem::PAGE_SIZE, File ) != Mem::PAGE_SIZE )
+        {
+            return false;
+        }
+        for ( ; Next < Mem::NUM_PAGES && GetWord( Header + 32 + ByIndex[Next] * 2 ) == Index; Next++ )
+        {
+            memcpy( Ram.data() + ByIndex[Next] * Mem::PAGE_SIZE, Stored, Mem::PAGE_SIZE );
+        }
+    }
+
+    cpu = Registers;
+    if ( Cycles )
+    {
+        *Cycles = CyclesRead;
+    }
+    memcpy( memory.Data, Ram.data(), Mem::MAX_MEM );
+    for ( u32 Page = 0; Page < Mem::NUM_PAGES; Page++ )
+    {
+        memory.NoteWrite( Page * Mem::PAGE_SIZE );
+    }
+    return true;
+}
+
+bool m6502::SaveState::Read( const Byte* Bytes, unsigned long long Size, CPU& cpu, Mem& memory, unsigned long long* Cycles )
+{
+    if ( Size < HEADER_SIZE )
+    {
+        return false;
+    }
+    CPU Registers = cpu;
+    unsigned long long CyclesRead = 0;
+    const long long NumStored = ReadHeader( Bytes, Registers, &CyclesRead );
+    if ( NumStored < 0 || Size < HEADER_SIZE + (unsigned long long)NumStored * Mem::PAGE_SIZE )
+    {
+        return false;
+    }
+
+    cpu = Registers;
+    if ( Cycles )
+    {
+        *Cycles = CyclesRead;
+    }
+    const Byte* Pages = Bytes + HEADER_SIZE;
+    for ( u32 Page = 0; Page < Mem::NUM_PAGES; Page++ )
+    {
+        Byte* To = memory.Data + Page * Mem::PAGE_SIZE;
+        const Word Index = GetWord( Bytes + 32 + Page * 2 );
+        if ( Index == ZERO_PAGE )
+        {
+            memset( To, 0, Mem::PAGE_SIZE );
+        }
+        else
+        {
+            memcpy( To, Pages + Index * Mem::PAGE_SIZE, Mem::PAGE_SIZE );
+        }
+        memory.NoteWrite( Page * Mem::PAGE_SIZE );
+    }
+    return true;
+}
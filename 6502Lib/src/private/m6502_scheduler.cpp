@@ -0,0 +1,58 @@
+#include "m6502_scheduler.h"
+
+#include <algorithm>
+#include <climits>
+
+m6502::Scheduler::EventId m6502::Scheduler::Schedule( unsigned long long Cycle, Callback Call, void* Context )
+{
+    const EventId Id = NextId++;
+    Events.push_back( { Cycle, Id, Call, Context } );
+    std::push_heap( Events.begin(), Events.end(), Later );
+    return Id;
+}
+
+bool m6502::Scheduler::Cancel( EventId Id )
+{
+    for ( size_t i = 0; i < Events.size(); i++ )
+    {
+        if ( Events[i].Id == Id )
+        {
+            Events[i] = Events.back();
+            Events.pop_back();
+            std::make_heap( Events.begin(), Events.end(), Later );
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned long long m6502::Scheduler::Run( unsigned long long Cycles, CPU& cpu, Mem& memory )
+{
+    const unsigned long long Start = CycleCount;
+    const unsigned long long End = Start + Cycles;
+    CallDueEvents();
+    while ( CycleCount < End )
+    {
+        const unsigned long long Until = std::min( NextEventCycle(), End );
+        const unsigned long long Slice = std::min( Until - CycleCount, (unsigned long long)INT_MAX );
+        CycleCount += cpu.Execute( (s32)Slice, memory );
+        CallDueEvents();
+        if ( cpu.Halted != CPU::HaltReason::None )
+        {
+            break;
+        }
+    }
+    return CycleCount - Start;
+}
+
+void m6502::Scheduler::CallDueEvents()
+{
+    while ( !Events.empty() && Events.front().Cycle <= CycleCount )
+    {
+        // Off the heap before the call, it may schedule or cancel events
+        std::pop_heap( Events.begin(), Events.end(), Later );
+        const Event Due = Events.back();
+        Events.pop_back();
+        Due.Call( Due.Context, Due.Cycle );
+    }
+}
@@ -0,0 +1,91 @@
+#include "m6502_snapshot.h"
+
+namespace
+{
+    using namespace m6502;
+
+    /* Put back what the 6502 itself holds, whatever else the caller has set
+    *  on cpu stays as it is now rather than as it was when saved */
+    void RestoreRegisters( CPU& cpu, const CPU& Saved )
+    {
+        cpu.PC = Saved.PC;
+        cpu.SP = Saved.SP;
+        cpu.A = Saved.A;
+        cpu.X = Saved.X;
+        cpu.Y = Saved.Y;
+        cpu.PS = Saved.PS;
+        const u32 Lines = CPU::PendingIrq | CPU::PendingNmi;
+        cpu.PendingEvents = (cpu.PendingEvents & ~Lines) | (Saved.PendingEvents & Lines);
+    }
+}
+
+m6502::Snapshot::Snapshot( const CPU& cpu, Mem& memory )
+    : cpu( cpu )
+{
+    for ( u32 Page = 0; Page < Mem::NUM_PAGES; Page++ )
+    {
+        SavePage( Page, memory );
+    }
+    memory.ClearDirtyPages();
+}
+
+m6502::Snapshot m6502::Snapshot::Fork( const CPU& cpu, Mem& memory ) const
+{
+    Snapshot Child = *this;
+    Child.cpu = cpu;
+    for ( u32 Page = 0; Page < Mem::NUM_PAGES; Page++ )
+    {
+        if ( memory.DirtyPage[Page] )
+        {
+            Child.SavePage( Page, memory );
+        }
+    }
+    memory.ClearDirtyPages();
+    return Child;
+}
+
+void m6502::Snapshot::Restore( CPU& cpu, Mem& memory ) const
+{
+    RestoreRegisters( cpu, this->cpu );
+    for ( u32 Page = 0; Page < Mem::NUM_PAGES; Page++ )
+    {
+        RestorePage( Page, memory );
+    }
+    memory.ClearDirtyPages();
+}
+
+void m6502::Snapshot::Restore( CPU& cpu, Mem& memory, const Snapshot& Current ) const
+{
+    RestoreRegisters( cpu, this->cpu );
+    for ( u32 Page = 0; Page < Mem::NUM_PAGES; Page++ )
+    {
+        if ( memory.DirtyPage[Page] || Pages[Page] != Current.Pages[Page] )
+        {
+            RestorePage( Page, memory );
+        }
+    }
+    memory.ClearDirtyPages();
+}
+
+m6502::u32 m6502::Snapshot::NumSharedPages( const Snapshot& Other ) const
+{
+    u32 NumShared = 0;
+    for ( u32 Page = 0; Page < Mem::NUM_PAGES; Page++ )
+    {
+        NumShared += Pages[Page] == Other.Pages[Page];
+    }
+    return NumShared;
+}
+
+void m6502::Snapshot::SavePage( u32 Page, const Mem& memory )
+{
+    auto Copy = std::make_shared<SavedPage>();
+    memcpy( Copy->Bytes, memory.Data + Page * Mem::PAGE_SIZE, Mem::PAGE_SIZE );
+    Pages[Page] = std::move( Copy );
+}
+
+void m6502::Snapshot::RestorePage( u32 Page, Mem& memory ) const
+{
+    memcpy( memory.Data + Page * Mem::PAGE_SIZE, Pages[Page]->Bytes, Mem::PAGE_SIZE );
+    memory.NoteWrite( Page * Mem::PAGE_SIZE );  // Decoded blocks on the page are stale
+}
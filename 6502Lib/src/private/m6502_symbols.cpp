@@ -0,0 +1,54 @@
+#include "m6502_symbols.h"
+
+bool m6502::SymbolTable::Load( const char* ListingPath )
+{
+    FILE* Listing = fopen( ListingPath, "r" );
+    if ( !Listing )
+    {
+        return false;
+    }
+
+    // A label is the first thing in the source column of a line with an
+    // address: "0400 : d8               start   cld". Equates have "=" for
+    // ":" and macro expansions a ">" where the label would be
+    constexpr size_t SOURCE_COLUMN = 24;
+    char Line[512];
+    while ( fgets( Line, sizeof(Line), Listing ) )
+    {
+        unsigned int Address;
+        char Name[64];
+        if ( strlen( Line ) > SOURCE_COLUMN && Line[5] == ':' &&
+             sscanf( Line, "%x :", &Address ) == 1 &&
+             Line[SOURCE_COLUMN] != ' ' && Line[SOURCE_COLUMN] != '>' && Line[SOURCE_COLUMN] != ';' &&
+             sscanf( Line + SOURCE_COLUMN, "%63s", Name ) == 1 )
+        {
+            Labels.emplace( (Word)Address, Name );
+        }
+    }
+    fclose( Listing );
+    return true;
+}
+
+const m6502::SymbolTable::Label* m6502::SymbolTable::Closest( Word Address ) const
+{
+    auto After = Labels.upper_bound( Address );
+    if ( After == Labels.begin() )
+    {
+        return nullptr;
+    }
+    return &*std::prev( After );
+}
+
+std::string m6502::SymbolTable::NameFor( Word Address ) const
+{
+    const Label* Found = Closest( Address );
+    if ( !Found )
+    {
+        return std::string();
+    }
+    if ( Found->first == Address )
+    {
+        return Found->second;
+    }
+    return Found->second + "+" + std::to_string( Address - Found->first );
+}
@@ -0,0 +1,107 @@
+#include "m6502_trace.h"
+
+m6502::TraceRing::TraceRing( u32 Capacity )
+{
+    u32 Size = 1;
+    while ( Size < Capacity )
+    {
+        Size *= 2;
+    }
+    Mask = Size - 1;
+    Slots = std::make_unique<std::atomic<unsigned long long>[]>( Size * 2 );
+    for ( u32 i = 0; i < Size * 2; i++ )
+    {
+        Slots[i].store( 0, std::memory_order_relaxed );
+    }
+}
+
+m6502::TraceRecord m6502::TraceRing::Unpack( unsigned long long Packed, unsigned long long Cycle )
+{
+    TraceRecord Record;
+    Record.Cycle = Cycle;
+    Record.PC = (Word)Packed;
+    Record.Opcode = (Byte)(Packed >> 16);
+    Record.A = (Byte)(Packed >> 24);
+    Record.X = (Byte)(Packed >> 32);
+    Record.Y = (Byte)(Packed >> 40);
+    Record.SP = (Byte)(Packed >> 48);
+    Record.PS = (Byte)(Packed >> 56);
+    return Record;
+}
+
+m6502::u32 m6502::TraceRing::Drain( TraceRecord* Out, u32 MaxRecords )
+{
+    const unsigned long long Pushed = Head.load( std::memory_order_acquire );
+    unsigned long long From = Tail;
+    if ( Pushed - From > Capacity() )
+    {
+        LostCount += Pushed - Capacity() - From;
+        From = Pushed - Capacity();
+    }
+    const unsigned long long To = Pushed - From > MaxRecords ? From + MaxRecords : Pushed;
+    for ( unsigned long long i = From; i < To; i++ )
+    {
+        const std::atomic<unsigned long long>* Slot = &Slots[(i & Mask) * 2];
+        Out[i - From] = Unpack( Slot[0].load( std::memory_order_relaxed ), Slot[1].load( std::memory_order_relaxed ) );
+    }
+
+    // Anything the CPU started writing since is a record Capacity on from
+    // one we copied, those may be torn
+    std::atomic_thread_fence( std::memory_order_acquire );
+    const unsigned long long Written = Writing.load( std::memory_order_relaxed );
+    unsigned long long FirstIntact = From;
+    if ( Written > Capacity() && Written - Capacity() > From )
+    {
+        FirstIntact = Written - Capacity() < To ? Written - Capacity() : To;
+    }
+    const u32 NumIntact = (u32)(To - FirstIntact);
+    if ( FirstIntact != From )
+    {
+        for ( u32 i = 0; i < NumIntact; i++ )
+        {
+            Out[i] = Out[FirstIntact - From + i];
+        }
+        LostCount += FirstIntact - From;
+    }
+    Tail = To;
+    return NumIntact;
+}
+
+m6502::u32 m6502::TraceRing::Latest( TraceRecord* Out, u32 MaxRecords ) const
+{
+    const unsigned long long Pushed = Head.load( std::memory_order_relaxed );
+    unsigned long long Count = Pushed < Capacity() ? Pushed : Capacity();
+    if ( Count > MaxRecords )
+    {
+        Count = MaxRecords;
+    }
+    for ( unsigned long long i = 0; i < Count; i++ )
+    {
+        const std::atomic<unsigned long long>* Slot = &Slots[((Pushed - Count + i) & Mask) * 2];
+        Out[i] = Unpack( Slot[0].load( std::memory_order_relaxed ), Slot[1].load( std::memory_order_relaxed ) );
+    }
+    return (u32)Count;
+}
+
+void m6502::TraceRing::Dump( FILE* File, u32 NumRecords ) const
+{
+    std::unique_ptr<TraceRecord[]> Records = std::make_unique<TraceRecord[]>( NumRecords );
+    const u32 Count = Latest( Records.get(), NumRecords );
+    fprintf( File, "%12s  PC    OP  A  X  Y  SP PS\n", "cycle" );
+    for ( u32 i = 0; i < Count; i++ )
+    {
+        const TraceRecord& Record = Records[i];
+        fprintf( File, "%12llu  %04X  %02X  %02X %02X %02X %02X %02X\n", Record.Cycle, Record.PC,
+                 Record.Opcode, Record.A, Record.X, Record.Y, Record.SP, Record.PS );
+    }
+}
+
+void m6502::TraceRing::DumpAfter( const char* Why ) const
+{
+    if ( DumpFile )
+    {
+        fprintf( DumpFile, "m6502 trace, %s:\n", Why );
+        Dump( DumpFile, DumpCount );
+        fflush( DumpFile );
+    }
+}
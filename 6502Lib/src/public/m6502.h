@@ -1,6 +1,7 @@
 #pragma once
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 namespace m6502 
 {
@@ -14,17 +15,106 @@ namespace m6502
     struct Mem;
     struct CPU;
     struct StatusFlags;
+    struct IllegalOpcode;
+    struct Jit;
+    struct MappedFile;
+    struct BatchRunner;
+    struct Snapshot;
+    struct SaveState;
+    struct Journal;
+    struct Scheduler;
+    struct TrapHarness;
+    struct PairProfile;
+    struct PcProfile;
+    struct CallProfile;
+    struct SymbolTable;
+    struct Breakpoints;
+    struct TraceRecord;
+    struct TraceRing;
+    template<u32 NumLanes> struct LockstepEngine;
 }
 
+/* Thrown by CPU::Execute when it decodes an opcode that is not implemented */
+struct m6502::IllegalOpcode {
+    Byte Opcode;        // The opcode that was fetched
+    Word Address;       // Where the opcode was fetched from
+};
+
 
 struct m6502::Mem {
     
     static constexpr u32 MAX_MEM = 1024 * 64;
+    static constexpr u32 PAGE_SIZE = 256;
+    static constexpr u32 NUM_PAGES = MAX_MEM / PAGE_SIZE;
+
+    /* The RAM. operator[] always goes here, the CPU goes through the page
+    *  tables (Read/Write) which point here unless a page is mapped */
     Byte Data[MAX_MEM];
 
+    /* What a mapped page does on the accesses that don't go to memory */
+    struct PageHandler {
+        Byte (*Read)( void* Context, Word Address ) = nullptr;
+        void (*Write)( void* Context, Word Address, Byte Value ) = nullptr;
+        void* Context = nullptr;
+    };
+
+    /* Per page, where the CPU reads and writes go. nullptr means through
+    *  the page's handler */
+    Byte* ReadPages[NUM_PAGES];
+    Byte* WritePages[NUM_PAGES];
+    PageHandler Handlers[NUM_PAGES];
+    u32 NumMappedPages = 0;
+
+    /* Pages whose reads or writes don't go to Data. Translated code reads
+    *  and writes Data directly, it checks here first */
+    bool MappedPage[NUM_PAGES] = {};
+
+    /* Pages holding code that the Jit has translated. Writes to them
+    *  are recorded so the blocks can be dropped (self modifying code) */
+    bool CodePage[NUM_PAGES] = {};
+    bool CodePageWritten[NUM_PAGES] = {};
+    bool CodeWritten = false;
+
+    /* Pages written to since the last ClearDirtyPages, lets reset, snapshots
+    *  and diffs touch only what a run changed */
+    bool DirtyPage[NUM_PAGES] = {};
+
+    /* Different for every Mem made and every assignment to one, lets the
+    *  Jit tell this Mem from one that was at the same address before */
+    unsigned long long Identity = NewIdentity();
+
+    Mem() {
+        for (u32 Page = 0; Page < NUM_PAGES; Page++) {
+            ReadPages[Page] = WritePages[Page] = Data + Page * PAGE_SIZE;
+        }
+    }
+
+    Mem( const Mem& Other ) {
+        *this = Other;
+    }
+
+    /* Pages of the other Mem that point at its RAM point at ours */
+    Mem& operator=( const Mem& Other ) {
+        memcpy( (void*)this, (const void*)&Other, sizeof(Mem) );
+        Identity = NewIdentity();
+        for (u32 Page = 0; Page < NUM_PAGES; Page++) {
+            if ( Other.ReadPages[Page] == Other.Data + Page * PAGE_SIZE )
+            {
+                ReadPages[Page] = Data + Page * PAGE_SIZE;
+            }
+            if ( Other.WritePages[Page] == Other.Data + Page * PAGE_SIZE )
+            {
+                WritePages[Page] = Data + Page * PAGE_SIZE;
+            }
+        }
+        return *this;
+    }
+
+    /* Zero all of memory */
     void Initialise() {
-        for (u32 i = 0; i < MAX_MEM; i++) {
-            Data[i] = 0;
+        memset( Data, 0, sizeof(Data) );
+        for (u32 Page = 0; Page < NUM_PAGES; Page++) {
+            NoteWrite( Page * PAGE_SIZE );
         }
     };
 
@@ -35,11 +125,162 @@ struct m6502::Mem {
         return Data[Address];
     }
 
+    /* What the non const operator[] returns: reads as the byte, only
+    *  assigning to it goes through NoteWrite */
+    struct ByteRef {
+        Mem& memory;
+        u32 Address;
+
+        operator Byte() const {
+            return memory.Data[Address];
+        }
+
+        ByteRef& operator=( Byte Value ) {
+            memory.NoteWrite( Address );
+            memory.Data[Address] = Value;
+            return *this;
+        }
+
+        ByteRef& operator=( const ByteRef& Other ) {
+            return *this = (Byte)Other;
+        }
+    };
+
     /* Write 1 byte */
-    Byte& operator[] (u32 Address)  {
-        
+    ByteRef operator[] (u32 Address)  {
+
         // Assert here Addres is < MAX_MEM
-        return Data[Address];
+        return ByteRef{ *this, Address };
+    }
+
+    /* Copy Bytes into RAM at Address in one go, anything past the end of
+    *  memory is dropped
+    *  @return the number of bytes copied */
+    u32 Load( const Byte* Bytes, u32 NumBytes, Word Address ) {
+        if ( NumBytes > MAX_MEM - Address )
+        {
+            NumBytes = MAX_MEM - Address;
+        }
+        memcpy( Data + Address, Bytes, NumBytes );
+        for (u32 Page = Address / PAGE_SIZE; Page * PAGE_SIZE < Address + NumBytes; Page++) {
+            NoteWrite( Page * PAGE_SIZE );
+        }
+        return NumBytes;
+    }
+
+    /* Read 1 byte through the page tables, what the CPU sees.
+    *  With nothing mapped this is a plain RAM read, checking the page table
+    *  on every access measured ~10% slower in CPU::Interpret */
+    Byte Read( Word Address ) const {
+        if ( NumMappedPages == 0 )
+        {
+            return Data[Address];
+        }
+        return ReadSlow( Address );
+    }
+
+    /* Write 1 byte through the page tables */
+    void Write( Word Address, Byte Value ) {
+        const u32 Page = Address / PAGE_SIZE;
+        if ( NumMappedPages == 0 && !CodePage[Page] )
+        {
+            Data[Address] = Value;
+            DirtyPage[Page] = true;
+            return;
+        }
+        WriteSlow( Address, Value );
+    }
+
+    /* Read and Write through the page tables, out of line to keep the
+    *  instruction handlers small enough to inline into CPU::Interpret */
+    Byte ReadSlow( Word Address ) const;
+    void WriteSlow( Word Address, Byte Value );
+
+    /* @return an Identity no Mem has had, never 0 */
+    static unsigned long long NewIdentity();
+
+    /* Page reads and writes go to Memory (PAGE_SIZE bytes, bank switching),
+    *  with ReadOnly set writes are dropped (ROM) */
+    void MapMemory( Byte Page, Byte* Memory, bool ReadOnly = false ) {
+        PageHandler DropWrites;
+        DropWrites.Write = []( void*, Word, Byte ) {};
+        Map( Page, Memory, ReadOnly ? nullptr : Memory, DropWrites );
+    }
+
+    /* Page accesses call Handler (memory mapped I/O), a nullptr Read or
+    *  Write in it leaves that access going to RAM */
+    void MapHandler( Byte Page, const PageHandler& Handler ) {
+        Byte* Ram = Data + Page * PAGE_SIZE;
+        Map( Page, Handler.Read ? nullptr : Ram, Handler.Write ? nullptr : Ram, Handler );
+    }
+
+    /* Page goes back to RAM */
+    void UnmapPage( Byte Page ) {
+        Byte* Ram = Data + Page * PAGE_SIZE;
+        Map( Page, Ram, Ram, PageHandler() );
+    }
+
+    /* @return true if no page is mapped, every access goes straight to Data */
+    bool IsPlainMemory() const {
+        return NumMappedPages == 0;
+    }
+
+    /* @return the number of dirty pages, their numbers are written to Pages in order */
+    u32 GetDirtyPages( Byte Pages[NUM_PAGES] ) const {
+        u32 NumDirty = 0;
+        for (u32 Page = 0; Page < NUM_PAGES; Page++) {
+            if ( DirtyPage[Page] )
+            {
+                Pages[NumDirty++] = (Byte)Page;
+            }
+        }
+        return NumDirty;
+    }
+
+    void ClearDirtyPages() {
+        memset( DirtyPage, 0, sizeof(DirtyPage) );
+    }
+
+    /* Zero the dirty pages and mark everything clean. Memory that was all
+    *  zero at the last ClearDirtyPages is all zero again */
+    void ZeroDirtyPages() {
+        for (u32 Page = 0; Page < NUM_PAGES; Page++) {
+            if ( DirtyPage[Page] )
+            {
+                memset( Data + Page * PAGE_SIZE, 0, PAGE_SIZE );
+                NoteWrite( Page * PAGE_SIZE );
+            }
+        }
+        ClearDirtyPages();
+    }
+
+    /* Set a page table entry, used by the Map and Unmap functions */
+    void Map( Byte Page, Byte* ReadFrom, Byte* WriteTo, const PageHandler& Handler ) {
+        Byte* Ram = Data + Page * PAGE_SIZE;
+        const bool WasMapped = ReadPages[Page] != Ram || WritePages[Page] != Ram;
+        const bool IsMapped = ReadFrom != Ram || WriteTo != Ram;
+        NumMappedPages += (u32)IsMapped - (u32)WasMapped;
+        MappedPage[Page] = IsMapped;
+        ReadPages[Page] = ReadFrom;
+        WritePages[Page] = WriteTo;
+        Handlers[Page] = Handler;
+        if ( CodePage[Page] )
+        {
+            // The code there now comes from elsewhere
+            CodePageWritten[Page] = true;
+            CodeWritten = true;
+        }
+    }
+
+    /* Record a write, marks the page dirty and flags writes to pages holding decoded code */
+    void NoteWrite( u32 Address ) {
+        const u32 Page = Address / PAGE_SIZE;
+        DirtyPage[Page] = true;
+        if ( CodePage[Page] )
+        {
+            CodePageWritten[Page] = true;
+            CodeWritten = true;
+        }
     }
 
 };
@@ -67,66 +308,139 @@ struct m6502::CPU {
         StatusFlags Flag;
     };
 
+    /* Lazy flags (M6502_LAZY_FLAGS): while Execute runs, N and Z are kept here
+    *  and only written back to PS when the whole byte is needed.
+    *  Z is set when the low byte is 0, N when bit 7 or bit 8 is set */
+    Word NZResult;
+
+    /* Interrupts waiting for the next instruction boundary, one bit per
+    *  source (PendingIrq, PendingNmi). Execute tests the whole word once per
+    *  instruction so while nothing is pending it costs one branch */
+    u32 PendingEvents = 0;
+
+    static constexpr u32
+        PendingIrq = 1 << 0,    // The IRQ line is held, taken when the I flag is clear
+        PendingNmi = 1 << 1,    // The NMI line went active, taken once
+        PendingTrap = 1 << 2,   // A jump to itself with HaltOnTrap set, Execute stops
+        PendingStop = 1 << 3;   // RequestStop, Execute returns
+
+    /* Why the last Execute stopped before using up its cycles */
+    enum class HaltReason : Byte {
+        None,           // It didn't, the cycles ran out
+        Trap,           // A jmp * or branch to itself (HaltOnTrap), PC is left on it
+        Breakpoint,     // PC is on one of Breaks, the instruction there has not run
+    };
+    HaltReason Halted = HaltReason::None;
+
+    /* Stop Execute as soon as a JMP or taken branch jumps to itself, the way
+    *  test programs and firmware signal they are done. Leave it off for code
+    *  that idles in a jmp * waiting for interrupts */
+    bool HaltOnTrap = false;
+
+    /* Built with M6502_TRACE the interpreter records every instruction it
+    *  runs in this ring, see m6502_trace.h. Not owned */
+    TraceRing* Trace = nullptr;
+
+    /* Where Interpret stops, see m6502_breakpoints.h. Not owned.
+    *  Executing again after stopping at one runs the instruction there */
+    Breakpoints* Breaks = nullptr;
+
+    /* The breakpoint the last Execute stopped at, passed over on the next */
+    static constexpr u32 NO_BREAKPOINT = Mem::MAX_MEM;
+    u32 BreakpointPassed = NO_BREAKPOINT;
+
+    /* Reset the CPU and zero memory */
     void Reset( Mem& memory) {
         Reset( 0xFFFC, memory );
         
     }
 
     void Reset( Word ResetVector, Mem& memory) {
+        Reset( ResetVector );
+        memory.Initialise();
+    }
+
+    /* Reset the registers only, memory is left as it is */
+    void Reset( Word ResetVector = 0xFFFC ) {
         PC = ResetVector;
         SP = 0xFF;
         Flag.C = Flag.Z = Flag.I = Flag.D = Flag.B = Flag.V = Flag.N = 0;
         A = X = Y = 0;
-        memory.Initialise();
+        PendingEvents = 0;
+        Halted = HaltReason::None;
+        BreakpointPassed = NO_BREAKPOINT;
+    }
+
+    /* Called by a JMP or taken branch that jumps to itself */
+    void NoteTrap() {
+        if ( HaltOnTrap )
+        {
+            PendingEvents |= PendingTrap;
+        }
+    }
+
+    /* Make Execute return at the next instruction boundary, with Halted left
+    *  alone. For code called back from inside Execute (a device handler)
+    *  that needs the CPU to stop where it is */
+    void RequestStop() {
+        PendingEvents |= PendingStop;
     }
 
-    Byte FetchByte( s32& Cycles, const Mem& memory ) {
-        Byte Data = memory[PC];
+    /* Hold the IRQ line (level triggered), it is taken at every instruction
+    *  boundary where the I flag is clear until it is released */
+    void SetIrq( bool Asserted ) {
+        PendingEvents = Asserted ? PendingEvents | PendingIrq : PendingEvents & ~PendingIrq;
+    }
+
+    /* Pulse the NMI line (edge triggered), it is taken at the next
+    *  instruction boundary whatever the I flag */
+    void TriggerNmi() {
+        PendingEvents |= PendingNmi;
+    }
+
+    /* Memory access helpers. These do not count cycles, CPU::Execute charges
+    *  each instruction's cycles in one go (see m6502_instructions.h) */
+    Byte FetchByte( const Mem& memory ) {
+        Byte Data = memory.Read( PC );
         PC++;
-        Cycles--;
         return Data;
     }
 
-    SByte FetchSByte( s32& Cycles, const Mem& memory ) {
-        return FetchByte( Cycles, memory );
+    SByte FetchSByte( const Mem& memory ) {
+        return FetchByte( memory );
     }
 
-    Word FetchWord( s32& Cycles, const Mem& memory ) {
+    Word FetchWord( const Mem& memory ) {
         // 6502 is little endian
-        Word Data = memory[PC];
+        Word Data = memory.Read( PC );
         PC++;
         
-        Data |= (memory[PC] << 8);
+        Data |= (memory.Read( PC ) << 8);
         PC++;
 
-        Cycles -=2;
-
         return Data;
     }
 
-    Byte ReadByte( s32& Cycles, Word Address, const Mem& memory ){
-        Byte Data = memory[Address];
-        Cycles--;
+    Byte ReadByte( Word Address, const Mem& memory ){
+        Byte Data = memory.Read( Address );
         return Data;
     }
 
-    Word ReadWord( s32& Cycles, Word Address, const Mem& memory ){
-        Byte LoByte = ReadByte( Cycles, Address, memory );
-        Byte HiByte = ReadByte( Cycles, Address + 1, memory );
+    Word ReadWord( Word Address, const Mem& memory ){
+        Byte LoByte = ReadByte( Address, memory );
+        Byte HiByte = ReadByte( Address + 1, memory );
         return LoByte | (HiByte << 8);
     }
     
     /* Write 1 byte to memory */
-    void WriteByte( Byte Value, s32& Cycles, Word Address, Mem& memory ) {
-        memory[Address] = Value;
-        Cycles--;
+    void WriteByte( Byte Value, Word Address, Mem& memory ) {
+        memory.Write( Address, Value );
     }
 
     /* Write 2 bytes to memory */
-    void WriteWord( Word Value, s32& Cycles, Word Address, Mem& memory ) {
-        memory[Address]       = Value & 0xFF;
-        memory[Address + 1]   = (Value >> 8);
-        Cycles -= 2;
+    void WriteWord( Word Value, Word Address, Mem& memory ) {
+        memory.Write( Address, Value & 0xFF );
+        memory.Write( Address + 1, Value >> 8 );
     }
 
     /* @return the stack pointer as a full 16-bit address (in the 1st page) */
@@ -135,54 +449,69 @@ struct m6502::CPU {
     }
 
     /* Push Word to stack*/
-     void PushWordToStack( s32& Cycles, Mem& memory, Word Value ) {
-        WriteByte( Value >> 8, Cycles, SPToAddress(), memory );
+     void PushWordToStack( Mem& memory, Word Value ) {
+        WriteByte( Value >> 8, SPToAddress(), memory );
         SP--;
-        WriteByte( Value & 0xFF, Cycles, SPToAddress(), memory );
+        WriteByte( Value & 0xFF, SPToAddress(), memory );
         SP--;
     }
 
     /* Push the PC-1 onto the stack */
-    void PushPCMinusOneToStack( s32& Cycles, Mem& memory ) {
-        PushWordToStack( Cycles, memory, PC - 1 );
+    void PushPCMinusOneToStack( Mem& memory ) {
+        PushWordToStack( memory, PC - 1 );
     }
 
     /* Push the PC+1 onto the stack */
-    void PushPCPlusOneToStack( s32& Cycles, Mem& memory ) {
-        PushWordToStack( Cycles, memory, PC + 1 );
+    void PushPCPlusOneToStack( Mem& memory ) {
+        PushWordToStack( memory, PC + 1 );
     }
 
     /* Push the PC onto the stack */
-    void PushPCToStack( s32& Cycles, Mem& memory ) {
-        PushWordToStack( Cycles, memory, PC );
+    void PushPCToStack( Mem& memory ) {
+        PushWordToStack( memory, PC );
     }
 
-    void PushByteOntoStack( s32& Cycles, Byte Value, Mem& memory ) {
+    void PushByteOntoStack( Byte Value, Mem& memory ) {
         Word SPWord = SPToAddress();
-        memory[SPWord] = Value;
-        Cycles--;
+        memory.Write( SPWord, Value );
         SP--;
-        Cycles--;
     }
 
-    Word PopWordFromStack( s32& Cycles, Mem& memory ) {
-        Word ValueFromStack = ReadWord( Cycles, SPToAddress() + 1, memory );
+    Word PopWordFromStack( Mem& memory ) {
+        Word ValueFromStack = ReadWord( SPToAddress() + 1, memory );
         SP += 2;
-        Cycles--;
         
         return ValueFromStack;
     }
 
-    Byte PopByteFromStack( s32& Cycles, Mem& memory ){
+    Byte PopByteFromStack( Mem& memory ){
         SP++;
-        Byte ValueFromStack = ReadByte( Cycles, SPToAddress(), memory );
-        Cycles--;
+        Byte ValueFromStack = ReadByte( SPToAddress(), memory );
         
         return ValueFromStack;
     }
 
+    /* Push Proccessor Status onto stack. Setting bits 4 & 5 on the stack*/
+    void PushPSToStack( Mem& memory ) {
+        MaterialiseFlags();
+        Byte PSStack  = PS | BreakFlagBit | UnusedFlagBit;
+        PushByteOntoStack( PSStack, memory );
+    }
+
+    /* Pop Processor Status from stack. Clearing bits 4 and 5 (Break and Unused) */
+    void PopPSFromStack( Mem& memory ) {
+        PS = PopByteFromStack( memory );
+        Flag.B = false;
+        Flag.Unused = false;
+        DeferFlags();
+    }
+
     // Process status bits
     static constexpr Byte
+        CarryFlagBit = 0b00000001,
+        ZeroFlagBit = 0b00000010,
+        InterruptDisableFlagBit = 0b00000100,
+        DecimalModeFlagBit = 0b00001000,
         NegativeFlagBit = 0b10000000,
         OverflowFlagBit = 0b01000000,
         BreakFlagBit =  0b000010000,
@@ -386,8 +715,63 @@ struct m6502::CPU {
     *  - LDA, LDX, LDY
     *  @Register The A,X or Y Register */
     void SetZeroAndNegativeFlags( Byte Register ) {
+#if defined( M6502_LAZY_FLAGS )
+        NZResult = Register;
+#else
         Flag.Z = (Register == 0);
         Flag.N = (Register & 0b10000000) > 0;
+#endif
+    }
+
+    /* Sets Z and N when they don't come from the same value - BIT */
+    void SetZeroAndNegativeFlags( bool Zero, bool Negative ) {
+#if defined( M6502_LAZY_FLAGS )
+        NZResult = (Zero ? 0 : 1) | (Negative ? 0x100 : 0);
+#else
+        Flag.Z = Zero;
+        Flag.N = Negative;
+#endif
+    }
+
+    /* @return true if the bit in the processor status is set */
+    bool IsFlagSet( Byte FlagBit ) const {
+#if defined( M6502_LAZY_FLAGS )
+        if ( FlagBit == ZeroFlagBit ) 
+        {
+            return (NZResult & 0xFF) == 0;
+        }
+        if ( FlagBit == NegativeFlagBit ) 
+        {
+            return (NZResult & 0x180) != 0;
+        }
+#endif
+        return (PS & FlagBit) != 0;
+    }
+
+    /* Write the lazy N and Z back into PS (no-op without M6502_LAZY_FLAGS) */
+    void MaterialiseFlags() {
+#if defined( M6502_LAZY_FLAGS )
+        Flag.Z = (NZResult & 0xFF) == 0;
+        Flag.N = (NZResult & 0x180) != 0;
+#endif
+    }
+
+    /* @return PS with the lazy N and Z in it, without writing it back */
+    Byte CurrentPS() const {
+#if defined( M6502_LAZY_FLAGS )
+        return (PS & ~(ZeroFlagBit | NegativeFlagBit)) |
+               ((NZResult & 0xFF) == 0 ? ZeroFlagBit : 0) |
+               ((NZResult & 0x180) != 0 ? NegativeFlagBit : 0);
+#else
+        return PS;
+#endif
+    }
+
+    /* Take N and Z from PS into the lazy state (no-op without M6502_LAZY_FLAGS) */
+    void DeferFlags() {
+#if defined( M6502_LAZY_FLAGS )
+        SetZeroAndNegativeFlags( Flag.Z, Flag.N );
+#endif
     }
 
     /* @return the address that the program was loading into, or 0 if no program*/
@@ -396,45 +780,75 @@ struct m6502::CPU {
     /* Printf the registers, program counter, etc*/
     void PrintStatus() const;
 
-    /* @return the number of cycles that were used */
+    /* @return the number of cycles that were used
+    *  - Throws IllegalOpcode if it meets an opcode that is not implemented
+    *  - Built with M6502_JIT this runs through the JIT (see m6502_jit.h) */
     s32 Execute ( s32 Cycles, Mem& memory );
+
+    /* The interpreter, what Execute runs without M6502_JIT */
+    s32 Interpret( s32 Cycles, Mem& memory );
+
+    /* Take a pending NMI, or IRQ if the I flag is clear: push PC and PS (B
+    *  clear) and jump through $FFFA / $FFFE
+    *  @return the cycles used, 0 if nothing could be taken */
+    s32 ServiceInterrupts( Mem& memory );
+
+    /* Called by Execute at an instruction boundary when PendingEvents is set,
+    *  out of line to keep the hot loop small. Takes interrupts, charging
+    *  their cycles, halts on a trap or stops for RequestStop
+    *  @return false if Execute should stop */
+    bool ServicePendingEvents( s32& Cycles, Mem& memory );
+
+    /* Called by Execute at an instruction boundary when PC is not on
+    *  SafePage, the last page seen without breakpoints. Out of line like
+    *  ServicePendingEvents. Updates SafePage and halts at a breakpoint
+    *  @return true if Execute should stop */
+    bool StopAtBreakpoint( u32& SafePage );
     
+    /* Addressing modes, @return the effective address.
+    *  ExtraCycles is incremented when indexing crosses a page boundary, modes
+    *  that always take the extra cycle (the _5 variants) leave it alone as
+    *  their base cycle count already includes it */
+
+    /* Addresing mode - Immediate (the operand is the next byte) */
+    Word AddressImmediate(s32 &ExtraCycles, const Mem &memory);
+
     /* Addresing mode - Zero Page */
-    Word AddressZeroPage(s32 &Cycles, const Mem &memory);
+    Word AddressZeroPage(s32 &ExtraCycles, const Mem &memory);
     
     /* Addressing mode - Zero Page X*/
-    Word AddressZeroPageX(s32 &Cycles, const Mem &memory);
+    Word AddressZeroPageX(s32 &ExtraCycles, const Mem &memory);
     
     /* Addressing mode - Zero Page Y*/
-    Word AddressZeroPageY(s32 &Cycles, const Mem &memory);
+    Word AddressZeroPageY(s32 &ExtraCycles, const Mem &memory);
 
     /* Addressing mode - Absolute*/
-    Word AddressAbsolute(s32 &Cycles, const Mem &memory);
+    Word AddressAbsolute(s32 &ExtraCycles, const Mem &memory);
 
     /* Addressing mode - Absolute with X offset*/
-    Word AddressAbsoluteX(s32 &Cycles, const Mem &memory);
+    Word AddressAbsoluteX(s32 &ExtraCycles, const Mem &memory);
 
     /* Addressing mode - Absolute with X offset 
     *  - (Always takes a cycle for the X page boundary)
     *  - See "STA Absolute, X" */
-    Word AddressAbsoluteX_5(s32 &Cycles, const Mem &memory);
+    Word AddressAbsoluteX_5(s32 &ExtraCycles, const Mem &memory);
 
     /* Addressing mode - Absolute with Y offset*/
-    Word AddressAbsoluteY(s32 &Cycles, const Mem &memory);
+    Word AddressAbsoluteY(s32 &ExtraCycles, const Mem &memory);
 
     /* Addressing mode - Absolute with Y offset
     *  - (Always takes a cycle for the Y page boundary)
     *  - See "STA Absolute, Y" */
-    Word AddressAbsoluteY_5(s32 &Cycles, const Mem &memory);
+    Word AddressAbsoluteY_5(s32 &ExtraCycles, const Mem &memory);
 
     /* Addressing mode - Indirect X | Indexed Indirect*/
-    Word AddressIndirectX(s32 &Cycles, const Mem &memory);
+    Word AddressIndirectX(s32 &ExtraCycles, const Mem &memory);
     
     /* Addressing mode - Indirect Y | Indirect Indexed*/
-    Word AddressIndirectY(s32 &Cycles, const Mem &memory);
+    Word AddressIndirectY(s32 &ExtraCycles, const Mem &memory);
 
     /* Addressing mode - Indirect Y | Indirect Indexed
     *  - (Always takes a cycle for the Y page boundary)
     *  - See "STA (Indirect, Y)" */
-    Word AddressIndirectY_5(s32 &Cycles, const Mem &memory);
+    Word AddressIndirectY_5(s32 &ExtraCycles, const Mem &memory);
 };
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "m6502.h"
+
+/* Runs many independent CPU + Mem pairs on a pool of threads.
+*  Each worker starts with an even share of the instances and steals half of
+*  what is left from another worker when it runs out. An instance is run by
+*  one thread from start to finish, the only state the threads share is the
+*  per worker range of instances still to run. */
+struct m6502::BatchRunner {
+
+    enum class ExitReason : Byte {
+        Budget,             // Used up the cycle budget
+        Halted,             // The halt check returned true
+        Trapped,            // Jumped to itself with CPU::HaltOnTrap set
+        Breakpoint,         // Stopped at one of CPU::Breaks
+        IllegalOpcode,      // CPU::Execute threw IllegalOpcode
+        Error,              // CPU::Execute threw anything else
+    };
+
+    /* What an instance was left with */
+    struct Result {
+        unsigned long long CyclesUsed = 0;
+        Word PC = 0;
+        Byte A = 0, X = 0, Y = 0, SP = 0, PS = 0;
+        ExitReason Reason = ExitReason::Budget;
+    };
+
+    /* Called between slices of an instance's run, may be called from any
+    *  worker thread at once for different instances
+    *  @return true to stop the instance */
+    using HaltCheck = bool (*)( const CPU& cpu, const Mem& memory, void* Context );
+
+    /* NumThreads 0 uses std::thread::hardware_concurrency */
+    explicit BatchRunner( u32 NumInstances, u32 NumThreads = 0 );
+    ~BatchRunner();
+
+    BatchRunner( const BatchRunner& ) = delete;
+    BatchRunner& operator=( const BatchRunner& ) = delete;
+
+    /* Set these up before Run */
+    CPU& GetCPU( u32 Instance ) {
+        return Instances[Instance]->cpu;
+    }
+    Mem& GetMem( u32 Instance ) {
+        return Instances[Instance]->memory;
+    }
+
+    u32 NumInstances() const {
+        return (u32)Instances.size();
+    }
+    u32 NumThreads() const {
+        return (u32)Workers.size();
+    }
+
+    /* Run every instance until it has used CycleBudget cycles, halts or
+    *  throws. Execute is called SliceCycles at a time (0 for as few calls as
+    *  it takes) and Halt (if any) is checked after each slice
+    *  @return a Result per instance */
+    const std::vector<Result>& Run( unsigned long long CycleBudget, s32 SliceCycles = 1000,
+                                    HaltCheck Halt = nullptr, void* Context = nullptr );
+
+private:
+
+    struct Instance {
+        CPU cpu;
+        Mem memory;
+    };
+
+    /* The instances a worker has still to run, [Begin, End) packed in one
+    *  word so the owner taking from the front and a thief taking the back
+    *  half can't both get the same one */
+    struct alignas(64) Queue {
+        std::atomic<unsigned long long> Range{ 0 };
+    };
+
+    void WorkerLoop( u32 Worker );
+    void RunShare( u32 Worker );
+    bool Steal( u32 Worker );
+    void RunInstance( u32 Index );
+
+    std::vector<std::unique_ptr<Instance>> Instances;
+    std::vector<Result> Results;
+    std::vector<std::thread> Workers;
+    std::unique_ptr<Queue[]> Queues;
+
+    // The current Run, written before the workers are started
+    unsigned long long CycleBudget = 0;
+    s32 SliceCycles = 0;
+    HaltCheck Halt = nullptr;
+    void* HaltContext = nullptr;
+
+    std::mutex Lock;
+    std::condition_variable Started;
+    std::condition_variable Finished;
+    u32 Generation = 0;         // Bumped by every Run
+    u32 NumWorking = 0;
+    bool ShuttingDown = false;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include "m6502.h"
+
+/* Addresses CPU::Interpret stops at before running the instruction there,
+*  for the CPUs whose Breaks point at the set (one set can serve many CPUs).
+*  Two levels so breakpoints can stay armed in long runs: Interpret only
+*  looks at the 256 bit page filter when PC moves to another page, and at
+*  the 64K bit map only while PC is on a page the filter has flagged. Code
+*  on pages without breakpoints runs at full speed.
+*  The JIT interprets the armed pages and runs translated code elsewhere.
+*  LockstepEngine lanes run past them while in lockstep */
+struct m6502::Breakpoints {
+
+    static constexpr u32 BITS = 64;
+
+    void Set( Word Address );
+    void Clear( Word Address );
+    void ClearAll();
+
+    bool IsSet( Word Address ) const {
+        return (Addresses[Address / BITS] >> (Address % BITS)) & 1;
+    }
+
+    /* @return true if the page has a breakpoint on it */
+    bool IsPageArmed( u32 Page ) const {
+        return (Pages[Page / BITS] >> (Page % BITS)) & 1;
+    }
+
+    u32 Count() const {
+        return NumSet;
+    }
+
+private:
+
+    unsigned long long Pages[Mem::NUM_PAGES / BITS] = {};
+    unsigned long long Addresses[Mem::MAX_MEM / BITS] = {};
+    u32 NumSet = 0;
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "m6502.h"
+#include "m6502_symbols.h"
+
+/* Profiles a program by call path: keeps a shadow call stack, a frame for
+*  each JSR, BRK and interrupt, and charges every instruction's cycles to
+*  the path it ran under. Reports the inclusive and exclusive cycles of
+*  each subroutine, and folded stacks ("root;main;mul16 1234" per line)
+*  for flame graph tools.
+*
+*  6502 code doesn't always return the way it called, so frames are
+*  matched on the stack pointer, not counted: a frame ends when an RTS or
+*  RTI leaves SP at or above where it was before the call (a routine that
+*  dropped its own return address returns straight to its caller's
+*  caller), or when TXS moves SP there. An RTS that leaves SP below the
+*  top frame's return (a pushed address used as a jump table) is a jump
+*  inside the current routine.
+*
+*  Like PcProfile it runs the CPU an instruction at a time through the
+*  interpreter, CPU::Execute has no counting in it. The opcode is read
+*  through Mem::Read before it runs, code must not run from a page mapped
+*  to a device handler. */
+struct m6502::CallProfile {
+
+    struct Routine {
+        Word Address;                           // Where it was called
+        std::string Name;                       // Its label, or $XXXX without one
+        unsigned long long Calls;
+        unsigned long long InclusiveCycles;     // Counting what it called, recursion once
+        unsigned long long ExclusiveCycles;     // Its own instructions only
+    };
+
+    CallProfile();
+
+    /* cpu.Interpret one instruction at a time, following the calls and
+    *  returns. Stops early when the CPU halts (CPU::Halted)
+    *  @return the cycles used */
+    s32 Execute( s32 Cycles, CPU& cpu, Mem& memory );
+
+    /* Name routines after the labels in an AS65 listing
+    *  @return false if the listing couldn't be read */
+    bool LoadSymbols( const char* ListingPath ) {
+        return Symbols.Load( ListingPath );
+    }
+
+    /* @return every routine called, the most inclusive cycles first */
+    std::vector<Routine> Routines() const;
+
+    /* Write a line per call path that used cycles of its own: the names
+    *  from the outermost in, separated by ';', then the cycles */
+    void WriteFoldedStacks( FILE* File ) const;
+
+    /* @return the number of frames on the shadow stack */
+    u32 Depth() const {
+        return (u32)Frames.size();
+    }
+
+    /* Zero the counts and empty the shadow stack, the symbols are kept */
+    void Clear();
+
+private:
+
+    static constexpr u32 ROOT = 0;
+
+    /* A routine at the end of one call path */
+    struct Node {
+        Word Address;
+        u32 Parent;
+        unsigned long long Calls = 0;
+        unsigned long long SelfCycles = 0;
+    };
+
+    struct Frame {
+        u32 Node;
+        Byte ReturnSP;          // SP before the call
+    };
+
+    /* Start a frame for Address, called with SP at ReturnSP */
+    void Call( Word Address, Byte ReturnSP );
+
+    /* End the frames SP is back at or above */
+    void Unwind( Byte SP );
+
+    std::string NameOf( u32 NodeIndex ) const;
+
+    std::vector<Node> Nodes;                                // Nodes[ROOT] is outside any call
+    std::unordered_map<unsigned long long, u32> Children;   // Parent << 16 | Address -> node
+    std::vector<Frame> Frames;
+    u32 Current = ROOT;
+    SymbolTable Symbols;
+};
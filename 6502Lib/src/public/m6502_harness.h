@@ -0,0 +1,33 @@
+#pragma once
+#include "m6502.h"
+
+/* Runs a self checking test program, like Klaus Dormann's 6502 functional
+*  test, until it traps: the PC loops on itself (jmp *, a branch to itself).
+*  Trapping at the success address is a pass, anywhere else a fail. */
+struct m6502::TrapHarness {
+
+    enum class Outcome : Byte {
+        Passed,             // Trapped at the success address
+        Failed,             // Trapped anywhere else
+        OutOfCycles,        // Still running after MaxCycles
+        IllegalOpcode,      // CPU::Execute threw IllegalOpcode
+        Breakpoint,         // Stopped at one of CPU::Breaks, TrapAddress is where
+    };
+
+    struct Result {
+        Outcome Status = Outcome::OutOfCycles;
+        Word TrapAddress = 0;               // Where the PC was left
+        unsigned long long Cycles = 0;
+        double Seconds = 0;                 // Wall time in CPU::Execute
+    };
+
+    /* Find the success trap in an AS65 listing: the "jmp *" the success
+    *  macro expands to
+    *  @return its address, or 0 if there is no listing or no success macro */
+    static Word FindSuccessAddress( const char* ListingPath );
+
+    /* Run cpu from its PC until it traps, stops at a breakpoint or has used MaxCycles, with
+    *  CPU::HaltOnTrap set so Execute stops on the trap itself */
+    static Result Run( CPU& cpu, Mem& memory, Word SuccessAddress,
+                       unsigned long long MaxCycles, s32 SliceCycles = 10000 );
+};
@@ -0,0 +1,138 @@
+#pragma once
+#include <climits>
+#include <memory>
+#include <vector>
+#include "m6502.h"
+
+/* x86-64 dynamic recompiler (build with M6502_JIT).
+*  A run of instructions that has been entered HotThreshold times is translated
+*  into native code, A/X/Y/SP/PS live in host registers while the block runs.
+*  A block only runs when the cycles left are enough for every instruction in
+*  it to start, so the cycles used are exactly those of CPU::Interpret.
+*  Everything else is stepped by CPU::Interpret: cold code, BRK/RTI/JMP (ind),
+*  ADC/SBC in decimal mode and cycle budgets too short for a block.
+*  Pages with a breakpoint (CPU::Breaks, Breakpoints::IsPageArmed) are
+*  stepped by the interpreter so it stops there: no block is translated on
+*  them, and blocks translated before a page was armed are neither entered
+*  nor chained to while it is.
+*  Translated code reads and writes Mem::Data directly. Code on a mapped page
+*  (Mem::MapMemory/MapHandler) is not translated and blocks stop before an
+*  instruction known to reach one. Once a Mem with mapped pages is run the
+*  blocks also check the page of every access when they run and leave before
+*  the instruction for the interpreter if it is mapped, plain RAM elsewhere
+*  still runs natively.
+*  Blocks jump straight into the next translated block while the cycles last
+*  instead of going back to Execute.
+*  Stores to translated code leave the block at the next instruction so self
+*  modifying code is seen.
+*  Blocks are kept by the 6502 bytes they were translated from rather than
+*  by Mem: moving to another Mem only drops the blocks whose bytes it doesn't
+*  hold, so one engine serves many Mems loaded with the same image (one per
+*  BatchRunner instance) without translating it again for each. A Mem is
+*  told from another by Mem::Identity, not by its address.
+*  The tables are made on the first Execute that can use them and the code
+*  buffer starts at MIN_CODE_BUFFER_SIZE, doubling each time it fills up to
+*  the size given, so an engine that translates little costs little. */
+struct m6502::Jit {
+
+    /* Longest run of instructions translated into one block */
+    static constexpr u32 MAX_BLOCK_LENGTH = 32;
+
+    /* Executable memory for the translated code. When it is full everything
+    *  is flushed and it grows until it reaches the engine's maximum */
+    static constexpr u32 MIN_CODE_BUFFER_SIZE = 64 * 1024;
+    static constexpr u32 DEFAULT_CODE_BUFFER_SIZE = 4 * 1024 * 1024;
+
+    explicit Jit( u32 HotThreshold = 8, u32 MaxCodeBufferSize = DEFAULT_CODE_BUFFER_SIZE );
+    ~Jit();
+
+    Jit( const Jit& ) = delete;
+    Jit& operator=( const Jit& ) = delete;
+
+    /* Run like CPU::Execute, through translated code where possible
+    *  @return the number of cycles that were used */
+    s32 Execute( s32 Cycles, CPU& cpu, Mem& memory );
+
+    /* Drop every translated block */
+    void Flush();
+
+    /* @return true if there is a translated block starting at Address */
+    bool IsCompiled( Word Address ) const {
+        return !BlockAt.empty() && BlockAt[Address] != nullptr;
+    }
+
+    /* @return the number of blocks currently translated */
+    u32 NumBlocks() const {
+        return NumCompiledBlocks;
+    }
+
+    /* @return the bytes of executable memory the engine holds now */
+    u32 CodeBufferSize() const {
+        return CodeBufferBytes;
+    }
+
+    /* Where the native code chains to for each address, read by the native code */
+    struct Entry {
+        const void* Body = nullptr;     // The block past its prologue
+        s32 Budget = INT_MAX;           // Run only with more cycles than this left
+    };
+
+private:
+
+    /* @return the cycles left, PC is left at the next instruction to run */
+    using NativeCode = s32 (*)( CPU* cpu, Mem* memory, s32 Cycles );
+
+    struct Block {
+        Word Start;
+        s32 Budget;                 // Run only with more cycles than this left
+        NativeCode Code;
+        std::vector<Byte> Bytes;    // The 6502 code it was translated from
+        bool Armed = false;         // On a page with a breakpoint, interpreted
+    };
+
+    /* Translate the block that starts at Address
+    *  @return nullptr if the first instruction can't be translated */
+    Block* Compile( Word Address, Mem& memory );
+
+    /* Make the tables, the first time Execute can use them */
+    void Allocate();
+
+    /* Make room for Size more bytes of code, growing or flushing the buffer
+    *  @return false if there is no executable memory for it */
+    bool ReserveCode( u32 Size );
+
+    /* Drop the block starting at Start */
+    void Drop( Word Start );
+
+    /* Move to another Mem, keeping the blocks it holds the same bytes for */
+    void Rebind( Mem& memory );
+
+    /* Drop the blocks on the pages that Mem saw written to whose bytes changed */
+    void InvalidateWrittenPages( Mem& memory );
+
+    /* Follow the pages Breaks has armed, marking the blocks on them */
+    void FollowBreakpoints( const Breakpoints* Breaks );
+
+    /* Enter and chain to the block only if none of its pages is armed */
+    void Rearm( Block& Compiled );
+
+    /* @return true if memory still holds the code the block was translated from */
+    static bool IsUnchanged( const Block& Compiled, const Mem& memory );
+
+    u32 HotThreshold;
+    u32 MaxCodeBufferSize;
+    Byte* CodeBuffer = nullptr;
+    u32 CodeBufferBytes = 0;
+    u32 CodeBufferUsed = 0;
+    unsigned long long BoundIdentity = 0;   // Mem::Identity of the Mem the blocks were checked against
+
+    std::vector<std::unique_ptr<Block>> BlockAt;        // Indexed by start address
+    std::vector<Entry> Entries;                         // Indexed by start address
+    std::vector<Byte> CodeBytes;                        // Number of blocks holding each byte
+    std::vector<u32> Heat;                              // Times each address was entered cold
+    std::vector<Word> PageBlocks[Mem::NUM_PAGES];       // Block starts touching each page
+    u32 NumCompiledBlocks = 0;
+    bool GuardMappedPages = false;      // Blocks check Mem::MappedPage, set once a Mem with mapped pages is run
+    bool ArmedPage[Mem::NUM_PAGES] = {};    // The pages the blocks were last marked for
+    bool AnyPageArmed = false;
+};
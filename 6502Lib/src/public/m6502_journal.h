@@ -0,0 +1,147 @@
+#pragma once
+#include <vector>
+#include "m6502.h"
+
+/* Records the inputs a run can't reproduce by itself (device reads, the
+*  interrupt lines) and feeds them back to replay the run exactly.
+*
+*  The CPU keeps no running cycle count, so the journal counts the cycles of
+*  the runs made through its Execute. An event is stamped with the
+*  instruction boundary it happened at: a device read or line change from
+*  inside Execute asks the CPU to stop (CPU::RequestStop) at the end of the
+*  instruction, and the journal writes the events down there, the reads
+*  first. Each event is a varint of (stamp - previous stamp) << 2 | Event,
+*  followed by the value for a DeviceRead, so a read in a busy loop costs
+*  2 bytes.
+*
+*  Devices drive the interrupt lines through the journal (SetIrq,
+*  TriggerNmi), recording it puts the change on the CPU at the boundary it
+*  is stamped with. Replaying, device reads return the recorded values in
+*  order and don't call the device, line changes from the devices are
+*  ignored and the recorded ones are put on the CPU at their stamps. A run
+*  that asks for something other than what was recorded next has diverged,
+*  it gets 0 and HasDiverged is set.
+*  Together with Snapshot or SaveState, Tell and Seek let a long run be
+*  replayed from a checkpoint instead of from the start. */
+struct m6502::Journal {
+
+    enum class Event : Byte {
+        DeviceRead = 0,     // A read from an Attach-ed page, with the value read
+        Irq = 1,            // The IRQ line was asserted
+        Nmi = 2,            // The NMI line was asserted
+        IrqRelease = 3,     // The IRQ line was released
+    };
+
+    /* Where a journal is up to, to go back to with Seek */
+    struct Position {
+        size_t Offset = 0;
+        unsigned long long Cycles = 0;
+        unsigned long long LastStamp = 0;
+    };
+
+    /* An empty journal, recording */
+    Journal() = default;
+
+    /* Replay a journal recorded earlier (see GetBytes) */
+    explicit Journal( std::vector<Byte> Recorded );
+
+    Journal( const Journal& ) = delete;
+    Journal& operator=( const Journal& ) = delete;
+
+    bool IsReplaying() const {
+        return Replaying;
+    }
+
+    /* Route the reads of Page, already mapped with Mem::MapHandler, through
+    *  the journal. Writes still go to the device, recording or replaying.
+    *  The journal must outlive the mapping
+    *  @return false if the page has no read handler */
+    bool Attach( Byte Page, Mem& memory );
+
+    /* cpu.Execute, counting the cycles it used. Replaying, it stops at
+    *  each recorded line change to put it on the CPU. Stops early when the
+    *  CPU halts (CPU::Halted)
+    *  @return the cycles used */
+    s32 Execute( s32 Cycles, CPU& cpu, Mem& memory );
+
+    /* For devices, in place of CPU::SetIrq / CPU::TriggerNmi: recording,
+    *  the change is journalled and made, replaying it is ignored */
+    void SetIrq( CPU& cpu, bool Asserted );
+    void TriggerNmi( CPU& cpu );
+
+    /* Replaying, @return true and the stamp of the next event if there is one */
+    bool PeekNext( Event& Kind, unsigned long long& Stamp ) const;
+
+    /* @return the cycles run through Execute */
+    unsigned long long Cycles() const {
+        return CycleCount;
+    }
+
+    bool HasDiverged() const {
+        return Diverged;
+    }
+
+    Position Tell() const;
+
+    /* Carry on from Position. Recording, the events after it are dropped */
+    void Seek( const Position& Where );
+
+    const std::vector<Byte>& GetBytes() const {
+        return Bytes;
+    }
+
+private:
+
+    /* Mem::PageHandler reads and writes for the Attach-ed pages */
+    static Byte ReadDevice( void* Context, Word Address );
+    static void WriteDevice( void* Context, Word Address, Byte Value );
+
+    /* Recording, note Kind happened at the current stamp. Replaying, check
+    *  that Kind is what happened next
+    *  @return the value recorded with it */
+    Byte Note( Event Kind, Byte Value = 0 );
+
+    /* Recording inside Execute, keep Kind for the end of the instruction */
+    void NoteAtBoundary( Event Kind, Byte Value = 0 );
+
+    /* Recording, note the events kept since the last boundary and make
+    *  the line changes */
+    void StampEvents( CPU& cpu );
+
+    /* Replaying, put the line changes due by now on the CPU */
+    void ApplyDueLines( CPU& cpu );
+
+    /* Replaying, @return true and the next line change past the device reads */
+    bool NextLine( Event& Kind, unsigned long long& Stamp );
+
+    /* Put a line change on the CPU */
+    static void Apply( Event Kind, CPU& cpu );
+
+    void WriteVarint( unsigned long long Value );
+    bool ReadVarint( size_t& At, unsigned long long& Value ) const;
+
+    std::vector<Byte> Bytes;
+    size_t Offset = 0;                      // Replaying, the next event
+    unsigned long long CycleCount = 0;
+    unsigned long long LastStamp = 0;
+    bool Replaying = false;
+    bool Diverged = false;
+    Mem::PageHandler Devices[Mem::NUM_PAGES];
+
+    // Recording, the CPU inside Execute and the events of its current instruction
+    struct Unstamped {
+        Event Kind;
+        Byte Value;
+    };
+    CPU* Running = nullptr;
+    std::vector<Unstamped> Pending;
+
+    // Replaying, NextLine's last find: the line change at LineOffset, or
+    // none before the end, valid while Offset is in [LineSearchFrom, LineOffset]
+    static constexpr size_t NO_SEARCH = ~(size_t)0;
+    size_t LineSearchFrom = NO_SEARCH;
+    size_t LineOffset = 0;
+    bool LineFound = false;
+    Event LineKind = Event::DeviceRead;
+    unsigned long long LineStamp = 0;
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include "m6502.h"
+
+/* A file mapped read only into the address space (mmap / MapViewOfFile),
+*  the bytes are paged in by the OS on first touch instead of being read */
+struct m6502::MappedFile {
+
+    explicit MappedFile( const char* Path );
+    ~MappedFile();
+
+    MappedFile( const MappedFile& ) = delete;
+    MappedFile& operator=( const MappedFile& ) = delete;
+
+    /* @return false if the file could not be opened or mapped */
+    bool IsOpen() const {
+        return Bytes != nullptr;
+    }
+
+    const Byte* Bytes = nullptr;
+    u32 Size = 0;
+
+    /* Copy the file into RAM at Address in one go
+    *  @return the number of bytes copied */
+    u32 LoadBin( Word Address, Mem& memory ) const;
+
+    /* Load the file as a PRG (2 byte little endian load address, then the
+    *  program) like CPU::LoadPrg
+    *  @return the load address, or 0 if there is no program */
+    Word LoadPrg( Mem& memory ) const;
+
+    /* Back the pages from Address on with the file itself as ROM, nothing is
+    *  copied. Address must be page aligned and the file must outlive the
+    *  mapping (see Mem::UnmapPage)
+    *  @return the number of pages mapped */
+    u32 MapRom( Word Address, Mem& memory ) const;
+
+private:
+
+#if defined( _WIN32 )
+    void* FileHandle = nullptr;
+    void* MappingHandle = nullptr;
+#endif
+};
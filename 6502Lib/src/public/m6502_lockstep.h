@@ -0,0 +1,105 @@
+#pragma once
+#include <exception>
+#include <memory>
+#include <vector>
+#include "m6502.h"
+
+/* Runs NumLanes CPUs (8, 16 or 32) through the same code together.
+*  While the lanes share a PC each instruction is decoded once and run for
+*  every lane from registers kept as arrays (A[NumLanes], X[NumLanes]...), the
+*  register and flag work is written as plain loops over the lanes for the
+*  compiler to vectorise (build with -mavx2 or -mavx512bw to get those).
+*  Each lane's Mem starts with every page mapped to the shared image and gets
+*  its own copy of a page on the first write to it, so the image is not
+*  duplicated per lane. A lane's Data only holds the pages it has written,
+*  read and write its memory through Mem::Read and Mem::Write rather than
+*  operator[].
+*  A lane whose PC goes a different way from the others (a branch, an RTS
+*  with a different stack...) is split off and runs the rest of its cycles
+*  through CPU::Execute on its own. Instructions without a lane version run
+*  through CPU::Interpret one lane at a time. Either way every lane ends with
+*  exactly the state and cycles CPU::Execute would have given it. */
+template<m6502::u32 NumLanes>
+struct m6502::LockstepEngine {
+
+    static_assert( NumLanes == 8 || NumLanes == 16 || NumLanes == 32, "8, 16 or 32 lanes" );
+
+    /* Image is the MAX_MEM bytes every lane starts with, it must outlive
+    *  the engine and is never written to */
+    explicit LockstepEngine( const Byte* Image );
+
+    LockstepEngine( const LockstepEngine& ) = delete;
+    LockstepEngine& operator=( const LockstepEngine& ) = delete;
+
+    /* Set the registers up before Run, read them after */
+    CPU& GetCPU( u32 Lane ) {
+        return Lanes[Lane].cpu;
+    }
+    Mem& GetMem( u32 Lane ) {
+        return *Lanes[Lane].memory;
+    }
+
+    /* Run every lane for Cycles, like calling CPU::Execute( Cycles ) on each.
+    *  Lanes that don't start at lane 0's PC, or have an interrupt pending,
+    *  run on their own from the start.
+    *  If a lane throws it stops there, the others still run and the first
+    *  exception is rethrown at the end
+    *  @return the number of lanes that stayed in lockstep to the end */
+    u32 Run( s32 Cycles );
+
+    /* @return the cycles the lane used in the last Run */
+    s32 CyclesUsed( u32 Lane ) const {
+        return Lanes[Lane].CyclesUsed;
+    }
+
+    /* @return the number of pages the lane has its own copy of */
+    u32 NumPrivatePages( u32 Lane ) const {
+        return Lanes[Lane].NumPrivatePages;
+    }
+
+private:
+
+    struct Lane {
+        CPU cpu;
+        std::unique_ptr<Mem> memory;
+        s32 CyclesUsed = 0;
+        u32 NumPrivatePages = 0;
+        LockstepEngine* Engine = nullptr;
+        u32 Index = 0;
+    };
+
+    /* Mem::PageHandler write for a page still on the image: copy it and unmap */
+    static void CopyOnWrite( void* Context, Word Address, Byte Value );
+
+    /* Run the instruction at PC for every active lane */
+    void Step();
+
+    /* Run the instruction at PC one active lane at a time through the interpreter */
+    void StepEachLane();
+
+    /* Take the lane out of lockstep with the state in the arrays */
+    void Leave( u32 Lane, Word LanePC, bool Split );
+
+    /* Split off the active lanes not at PC */
+    void SplitFrom( const Word* LanePCs );
+
+    Byte ReadLane( u32 Lane, Word Address ) const;
+    void WriteLane( u32 Lane, Word Address, Byte Value );
+
+    const Byte* Image;
+    Lane Lanes[NumLanes];
+    u32 PrivatePagesOf[Mem::NUM_PAGES] = {};    // Lanes that copied each page
+
+    // Lockstep state, only meaningful for the active lanes
+    Word PC = 0;
+    alignas(64) Byte A[NumLanes];
+    alignas(64) Byte X[NumLanes];
+    alignas(64) Byte Y[NumLanes];
+    alignas(64) Byte SP[NumLanes];
+    alignas(64) Byte PS[NumLanes];
+    alignas(64) Byte Active[NumLanes];          // 0xFF while the lane is in lockstep
+    alignas(64) s32 CyclesLeft[NumLanes];
+    std::vector<u32> SplitLanes;
+    s32 RunCycles = 0;
+    std::exception_ptr Thrown;
+};
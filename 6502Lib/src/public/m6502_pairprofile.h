@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+#include "m6502.h"
+
+/* Counts how often each opcode runs straight after each other one, to pick
+*  the pairs CPU::Interpret runs as superinstructions (m6502_fused_pairs.h).
+*  Runs the CPU an instruction at a time through the interpreter, so it is
+*  only for profiling: CPU::Execute itself has no counting in it.
+*  The opcode is read through Mem::Read before it runs, code must not run
+*  from a page mapped to a device handler. */
+struct m6502::PairProfile {
+
+    struct Pair {
+        Byte First;
+        Byte Second;
+        unsigned long long Count;
+    };
+
+    PairProfile();
+
+    /* cpu.Interpret one instruction at a time, counting the pairs. Pairs
+    *  carry over from one call to the next. Stops early when the CPU halts
+    *  (CPU::Halted)
+    *  @return the cycles used */
+    s32 Execute( s32 Cycles, CPU& cpu, Mem& memory );
+
+    unsigned long long Count( Byte First, Byte Second ) const {
+        return Counts[First << 8 | Second];
+    }
+
+    /* @return the number of instructions run through Execute */
+    unsigned long long NumInstructions() const {
+        return InstructionCount;
+    }
+
+    /* @return the NumPairs most frequent pairs, most frequent first. The
+    *  interpreter fuses one follower per opcode, so each First only comes
+    *  up once, with its most frequent Second */
+    std::vector<Pair> Top( u32 NumPairs ) const;
+
+    /* Write the Top( NumPairs ) pairs as a fused pairs header, to build with
+    *  -DM6502_FUSED_PAIRS=<Path>
+    *  @return false if the file couldn't be written */
+    bool WriteFusedPairs( const char* Path, u32 NumPairs ) const;
+
+    void Clear();
+
+private:
+
+    static constexpr s32 NO_PREVIOUS = -1;
+
+    std::vector<unsigned long long> Counts;     // Indexed by First << 8 | Second
+    unsigned long long InstructionCount = 0;
+    s32 Previous = NO_PREVIOUS;
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "m6502.h"
+#include "m6502_symbols.h"
+
+/* Counts the instructions run and cycles used at each address, to find
+*  where a program spends its cycles. Addresses can be named from an AS65
+*  listing, and summed per label to see which routines cost the most.
+*  Like PairProfile it runs the CPU an instruction at a time through the
+*  interpreter (about 1.3x slower on the functional test), CPU::Execute has
+*  no counting in it. */
+struct m6502::PcProfile {
+
+    struct HotSpot {
+        Word Address;                       // The instruction, or the label's address
+        unsigned long long Instructions;
+        unsigned long long Cycles;
+        std::string Symbol;                 // "label" or "label+offset", empty without symbols
+    };
+
+    PcProfile();
+
+    /* cpu.Interpret one instruction at a time, counting each one at the
+    *  address it was fetched from. Interrupts are counted on their own.
+    *  Stops early when the CPU halts (CPU::Halted)
+    *  @return the cycles used */
+    s32 Execute( s32 Cycles, CPU& cpu, Mem& memory );
+
+    unsigned long long InstructionsAt( Word Address ) const {
+        return Counters[Address].Instructions;
+    }
+    unsigned long long CyclesAt( Word Address ) const {
+        return Counters[Address].Cycles;
+    }
+
+    /* @return the cycles taking interrupts (pushing PC and PS, the jump through the vector) */
+    unsigned long long InterruptCycles() const {
+        return InterruptCycleCount;
+    }
+
+    /* @return every cycle used through Execute */
+    unsigned long long TotalCycles() const {
+        return TotalCycleCount;
+    }
+
+    /* Name addresses after the labels in an AS65 listing
+    *  @return false if the listing couldn't be read */
+    bool LoadSymbols( const char* ListingPath ) {
+        return Symbols.Load( ListingPath );
+    }
+
+    /* @return the name of Address, see SymbolTable::NameFor */
+    std::string SymbolFor( Word Address ) const {
+        return Symbols.NameFor( Address );
+    }
+
+    /* @return the NumSpots addresses that used the most cycles, most first */
+    std::vector<HotSpot> HotSpots( u32 NumSpots ) const;
+
+    /* @return the NumSpots labels whose code used the most cycles, most
+    *  first. Each address counts for the label at or before it */
+    std::vector<HotSpot> HotSymbols( u32 NumSpots ) const;
+
+    /* Write the hot symbols (if there are symbols) and hot spots as text */
+    void WriteReport( FILE* File, u32 NumSpots ) const;
+
+    /* Zero the counts, the symbols are kept */
+    void Clear();
+
+private:
+
+    struct Counter {
+        unsigned long long Instructions = 0;
+        unsigned long long Cycles = 0;
+    };
+
+    static std::vector<HotSpot> MostCycles( std::vector<HotSpot> Spots, u32 NumSpots );
+
+    std::vector<Counter> Counters;          // One per address
+    SymbolTable Symbols;
+    unsigned long long InterruptCycleCount = 0;
+    unsigned long long TotalCycleCount = 0;
+};
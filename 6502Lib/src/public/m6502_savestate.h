@@ -0,0 +1,44 @@
+#pragma once
+#include "m6502.h"
+
+/* Saving and loading a CPU + Mem to a versioned binary format.
+*
+*  Everything is little endian:
+*       0   "M6502SS\x1A"
+*       8   u32 Version
+*      12   u32 number of stored pages
+*      16   u64 cycle counter (whatever the caller keeps, the CPU has none)
+*      24   u16 PC, SP, A, X, Y, PS, interrupt lines (IRQ_HELD, NMI_LATCHED)
+*      32   u16 per page, the stored page it holds or ZERO_PAGE for all zeros
+*     768   the stored pages, PAGE_SIZE bytes each
+*
+*  Pages that are all zero are not stored and a page equal to the stored
+*  page before it (fills, mirrors) reuses it. The stored pages start page
+*  aligned in the file, so loading a mapped file (see MappedFile) is one
+*  memcpy per page.
+*  Only RAM (Mem::Data) is saved, the page table mappings are left alone.
+*  Version 1 had no interrupt lines, the byte was 0 (nothing pending). */
+struct m6502::SaveState {
+
+    static constexpr u32 VERSION = 2;
+    static constexpr u32 HEADER_SIZE = 768;
+    static constexpr Word ZERO_PAGE = 0xFFFF;
+
+    /* Bits of the interrupt lines byte */
+    static constexpr Byte
+        IRQ_HELD = 1 << 0,          // CPU::SetIrq( true )
+        NMI_LATCHED = 1 << 1;       // CPU::TriggerNmi not taken yet
+
+    /* Write the machine to File at its current position
+    *  @return false if the file could not be written */
+    static bool Write( FILE* File, const CPU& cpu, const Mem& memory, unsigned long long Cycles = 0 );
+
+    /* Read a machine written by Write from File's current position. On
+    *  failure cpu and memory are left as they were
+    *  @return false if the file is short, not a save state or a newer version */
+    static bool Read( FILE* File, CPU& cpu, Mem& memory, unsigned long long* Cycles = nullptr );
+
+    /* Load a machine from a save state already in memory (e.g. a MappedFile)
+    *  @return false if the bytes are short, not a save state or a newer version */
+    static bool Read( const Byte* Bytes, unsigned long long Size, CPU& cpu, Mem& memory, unsigned long long* Cycles = nullptr );
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include "m6502.h"
+
+/* Runs a CPU between events that devices schedule at absolute cycles
+*  (timers, raster lines, serial bits...). Instead of the caller picking a
+*  slice for CPU::Execute, Run executes exactly up to the next event, calls
+*  it and carries on, so a device costs nothing until its event is due.
+*  The CPU charges cycles per instruction, so an event is called at the
+*  first instruction boundary at or after its cycle (Now() may be a few
+*  cycles past it).
+*  Events are kept in a min-heap on (cycle, order scheduled), events due on
+*  the same cycle are called in the order they were scheduled. */
+struct m6502::Scheduler {
+
+    /* Called when the event is due, Cycle is when it was scheduled for.
+    *  It may schedule more events (a periodic timer schedules its next tick) */
+    using Callback = void (*)( void* Context, unsigned long long Cycle );
+
+    using EventId = unsigned long long;
+
+    /* @return the cycles run so far */
+    unsigned long long Now() const {
+        return CycleCount;
+    }
+
+    /* Call Event at Cycle, a cycle already past is called before the next instruction
+    *  @return an id to Cancel it with */
+    EventId Schedule( unsigned long long Cycle, Callback Event, void* Context = nullptr );
+
+    /* Call Event Delay cycles from now */
+    EventId ScheduleIn( unsigned long long Delay, Callback Event, void* Context = nullptr ) {
+        return Schedule( CycleCount + Delay, Event, Context );
+    }
+
+    /* @return false if the event was already called or cancelled */
+    bool Cancel( EventId Id );
+
+    /* @return the cycle of the next event, or ~0 if there is none */
+    unsigned long long NextEventCycle() const {
+        return Events.empty() ? ~0ull : Events.front().Cycle;
+    }
+
+    /* Run cpu for Cycles, calling the events that come due on the way.
+    *  Stops early when Execute halts (CPU::Halted says why).
+    *  Throws whatever CPU::Execute throws, the events called so far stay called
+    *  @return the cycles used, Cycles or a few over unless the CPU halted */
+    unsigned long long Run( unsigned long long Cycles, CPU& cpu, Mem& memory );
+
+private:
+
+    struct Event {
+        unsigned long long Cycle;
+        EventId Id;                 // Also the order scheduled
+        Callback Call;
+        void* Context;
+    };
+
+    /* Heap order, the earliest event at the front */
+    static bool Later( const Event& A, const Event& B ) {
+        return A.Cycle != B.Cycle ? A.Cycle > B.Cycle : A.Id > B.Id;
+    }
+
+    /* Call every event due by now */
+    void CallDueEvents();
+
+    std::vector<Event> Events;
+    unsigned long long CycleCount = 0;
+    EventId NextId = 0;
+};
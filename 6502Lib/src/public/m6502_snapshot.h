@@ -0,0 +1,58 @@
+#pragma once
+#include <memory>
+#include "m6502.h"
+
+/* A saved CPU and RAM whose pages are shared with the snapshots it was forked
+*  from. Taking the first snapshot copies every page, forking a child from a
+*  Mem that holds a snapshot copies only the pages written since (Mem's dirty
+*  pages) and shares the rest with the parent, so a snapshot costs the pages
+*  it changed. Snapshots are never written to: copying one only bumps the
+*  page reference counts and they can be shared between threads.
+*  Only RAM (Mem::Data) and the registers are put back, the page table
+*  mappings and the rest of the CPU are left alone. */
+struct m6502::Snapshot {
+
+    struct SavedPage {
+        Byte Bytes[Mem::PAGE_SIZE];
+    };
+
+    Snapshot() = default;
+
+    /* Save the whole machine. memory's dirty pages are cleared, it now holds
+    *  this snapshot */
+    Snapshot( const CPU& cpu, Mem& memory );
+
+    /* Save the machine as a child of this snapshot. memory must hold this
+    *  snapshot (taken, forked or restored from it) plus the writes since,
+    *  only its dirty pages are copied. They are cleared, memory now holds the
+    *  child */
+    Snapshot Fork( const CPU& cpu, Mem& memory ) const;
+
+    /* Put the machine back, copying every page. memory's dirty pages are
+    *  cleared, it now holds this snapshot */
+    void Restore( CPU& cpu, Mem& memory ) const;
+
+    /* Put the machine back when memory holds Current plus the writes since,
+    *  only the dirty pages and the pages this snapshot doesn't share with
+    *  Current are copied */
+    void Restore( CPU& cpu, Mem& memory, const Snapshot& Current ) const;
+
+    /* @return the number of pages this snapshot shares with Other */
+    u32 NumSharedPages( const Snapshot& Other ) const;
+
+    /* Read 1 byte of the saved RAM */
+    Byte operator[] ( Word Address ) const {
+        return Pages[Address / Mem::PAGE_SIZE]->Bytes[Address % Mem::PAGE_SIZE];
+    }
+
+    CPU cpu;
+    std::shared_ptr<const SavedPage> Pages[Mem::NUM_PAGES];
+
+private:
+
+    /* Copy Page of memory into a page of our own */
+    void SavePage( u32 Page, const Mem& memory );
+
+    /* Copy our Page back into memory */
+    void RestorePage( u32 Page, Mem& memory ) const;
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include <map>
+#include <string>
+#include "m6502.h"
+
+/* The labels of an AS65 listing, to name addresses in the profiles */
+struct m6502::SymbolTable {
+
+    using Label = std::pair<const Word, std::string>;
+
+    /* Add the labels in the listing, an address with more than one label
+    *  keeps the first
+    *  @return false if the listing couldn't be read */
+    bool Load( const char* ListingPath );
+
+    bool IsEmpty() const {
+        return Labels.empty();
+    }
+
+    /* @return the label at or before Address, nullptr if there is none */
+    const Label* Closest( Word Address ) const;
+
+    /* @return the label at or before Address and how far past it Address
+    *  is ("loop+3"), or an empty string if there is none */
+    std::string NameFor( Word Address ) const;
+
+private:
+
+    std::map<Word, std::string> Labels;
+};
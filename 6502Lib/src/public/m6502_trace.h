@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include "m6502.h"
+
+/* One instruction as it was about to run */
+struct m6502::TraceRecord {
+    unsigned long long Cycle;       // Cycles run through the ring before it
+    Word PC;
+    Byte Opcode;
+    Byte A, X, Y, SP, PS;
+};
+
+/* The last instructions CPU::Interpret ran, for post mortems.
+*  Built with M6502_TRACE, the interpreter pushes a record for every
+*  instruction into the ring cpu.Trace points at: four stores, it never
+*  waits and once the ring is full the oldest records are overwritten.
+*  Blocks run by the JIT are not traced.
+*
+*  One other thread can Drain the ring while the CPU runs, without locks:
+*  a record is two words, the writer announces a slot (Writing) before it
+*  overwrites it and publishes it (Head) after, so the reader can tell which
+*  of the records it copied may have been overwritten under it and drops
+*  them, counting them in Lost.
+*
+*  When Interpret halts on a trap or an exception leaves it, the last
+*  records are dumped to the dump file (stderr to start with). */
+struct m6502::TraceRing {
+
+    /* Capacity is rounded up to a power of 2 */
+    explicit TraceRing( u32 Capacity = 4096 );
+
+    TraceRing( const TraceRing& ) = delete;
+    TraceRing& operator=( const TraceRing& ) = delete;
+
+    u32 Capacity() const {
+        return Mask + 1;
+    }
+
+    /* The CPU's thread: add a record, overwriting the oldest if full */
+    void Push( Word PC, Byte Opcode, Byte A, Byte X, Byte Y, Byte SP, Byte PS, unsigned long long Cycle ) {
+        const unsigned long long At = Head.load( std::memory_order_relaxed );
+        Writing.store( At + 1, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_release );
+        std::atomic<unsigned long long>* Slot = &Slots[(At & Mask) * 2];
+        Slot[0].store( (unsigned long long)PC | (unsigned long long)Opcode << 16 |
+                       (unsigned long long)A << 24 | (unsigned long long)X << 32 |
+                       (unsigned long long)Y << 40 | (unsigned long long)SP << 48 |
+                       (unsigned long long)PS << 56, std::memory_order_relaxed );
+        Slot[1].store( Cycle, std::memory_order_relaxed );
+        Head.store( At + 1, std::memory_order_release );
+    }
+
+    /* The CPU's thread: the cycles run so far, Interpret stamps the records from it */
+    unsigned long long Cycles() const {
+        return CycleCount;
+    }
+    void AddCycles( s32 CyclesUsed ) {
+        CycleCount += CyclesUsed;
+    }
+
+    /* Any one other thread: copy the records pushed since the last Drain,
+    *  oldest first
+    *  @return the number of records copied */
+    u32 Drain( TraceRecord* Out, u32 MaxRecords );
+
+    /* @return the records Drain missed, overwritten before it got to them */
+    unsigned long long Lost() const {
+        return LostCount;
+    }
+
+    /* The CPU's thread, or with the CPU stopped: copy the last records pushed, oldest first
+    *  @return the number of records copied */
+    u32 Latest( TraceRecord* Out, u32 MaxRecords ) const;
+
+    /* Write the last NumRecords records as text */
+    void Dump( FILE* File, u32 NumRecords ) const;
+
+    /* Where Interpret dumps the last NumRecords records on a trap or
+    *  exception, nullptr for nowhere */
+    void SetDumpFile( FILE* File, u32 NumRecords = 32 ) {
+        DumpFile = File;
+        DumpCount = NumRecords;
+    }
+
+    /* Called by Interpret, dump to the dump file if there is one */
+    void DumpAfter( const char* Why ) const;
+
+private:
+
+    static TraceRecord Unpack( unsigned long long Packed, unsigned long long Cycle );
+
+    std::unique_ptr<std::atomic<unsigned long long>[]> Slots;   // Two words per record
+    u32 Mask;
+
+    // Written by the CPU's thread
+    alignas(64) std::atomic<unsigned long long> Head{ 0 };     // Records pushed
+    std::atomic<unsigned long long> Writing{ 0 };               // Head once the record being written is done
+    unsigned long long CycleCount = 0;
+    FILE* DumpFile = stderr;
+    u32 DumpCount = 32;
+
+    // Written by the draining thread
+    alignas(64) unsigned long long Tail = 0;                    // Next record to Drain
+    unsigned long long LostCount = 0;
+};
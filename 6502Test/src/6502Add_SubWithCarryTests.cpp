@@ -1611,4 +1611,47 @@ TEST_F( M6502Add_SubWithCarryTests, SBCIndirectYCanSubtractTwoNegativeNumbers )
 	Test.ExpectV = false;
 	Test.ExpectZ = false;
 	TestSBCIndirectY( Test );
-}
\ No newline at end of file
+}
+
+TEST_F( M6502Add_SubWithCarryTests, ADCInDecimalModeAddsBCDNumbers )
+{
+	// given:
+	using namespace m6502;
+	cpu.Reset( 0xFF00, mem );
+	cpu.Flag.D = true;
+	cpu.Flag.C = true;
+	cpu.A = 0x58;
+	mem[0xFF00] = CPU::INS_ADC_IM;
+	mem[0xFF01] = 0x46;
+	constexpr s32 EXPECTED_CYCLES = 2;
+
+	// when:
+	const s32 ActualCycles = cpu.Execute( EXPECTED_CYCLES, mem );
+
+	// then:
+	EXPECT_EQ( ActualCycles, EXPECTED_CYCLES );
+	EXPECT_EQ( cpu.A, 0x05 );	// 58 + 46 + 1 = 105
+	EXPECT_TRUE( cpu.Flag.C );
+	EXPECT_TRUE( cpu.Flag.D );
+}
+
+TEST_F( M6502Add_SubWithCarryTests, SBCInDecimalModeSubtractsBCDNumbers )
+{
+	// given:
+	using namespace m6502;
+	cpu.Reset( 0xFF00, mem );
+	cpu.Flag.D = true;
+	cpu.Flag.C = true;
+	cpu.A = 0x12;
+	mem[0xFF00] = CPU::INS_SBC_IM;
+	mem[0xFF01] = 0x21;
+	constexpr s32 EXPECTED_CYCLES = 2;
+
+	// when:
+	const s32 ActualCycles = cpu.Execute( EXPECTED_CYCLES, mem );
+
+	// then:
+	EXPECT_EQ( ActualCycles, EXPECTED_CYCLES );
+	EXPECT_EQ( cpu.A, 0x91 );	// 12 - 21 = -9, borrow
+	EXPECT_FALSE( cpu.Flag.C );
+}
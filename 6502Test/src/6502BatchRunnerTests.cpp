@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include "m6502.h"
+#include "m6502_batch.h"
+
+using namespace m6502;
+
+class M6502BatchRunnerTests : public testing::Test {
+protected:
+
+    /* ldx #Count ; loop: dex ; bne loop ; stx $40 ; jmp * */
+    static void LoadCountdown( BatchRunner& Runner, u32 Instance, Byte Count ) {
+        CPU& cpu = Runner.GetCPU( Instance );
+        Mem& mem = Runner.GetMem( Instance );
+        cpu.Reset( 0x1000 );
+        mem[0x1000] = CPU::INS_LDX_IM;
+        mem[0x1001] = Count;
+        mem[0x1002] = CPU::INS_DEX;
+        mem[0x1003] = CPU::INS_BNE;
+        mem[0x1004] = 0xFD;
+        mem[0x1005] = CPU::INS_STX_ZP;
+        mem[0x1006] = 0x40;
+        mem[0x1007] = CPU::INS_JMP_ABS;
+        mem[0x1008] = 0x07;
+        mem[0x1009] = 0x10;
+    }
+
+    static bool IsAtTheEnd( const CPU& cpu, const Mem&, void* ) {
+        return cpu.PC == 0x1007;
+    }
+};
+
+TEST_F( M6502BatchRunnerTests, EveryInstanceRunsToItsHaltOnItsOwnData )
+{
+    // Given:
+    constexpr u32 NUM_INSTANCES = 100;
+    BatchRunner Runner( NUM_INSTANCES, 4 );
+    for ( u32 i = 0; i < NUM_INSTANCES; i++ )
+    {
+        LoadCountdown( Runner, i, (Byte)(i + 1) );
+    }
+
+    // When:
+    const std::vector<BatchRunner::Result>& Results = Runner.Run( 100000, 50, IsAtTheEnd );
+
+    // Then:
+    ASSERT_EQ( Results.size(), NUM_INSTANCES );
+    for ( u32 i = 0; i < NUM_INSTANCES; i++ )
+    {
+        EXPECT_EQ( Results[i].Reason, BatchRunner::ExitReason::Halted );
+        EXPECT_EQ( Results[i].PC, 0x1007 );
+        EXPECT_EQ( Results[i].X, 0 );
+        // ldx, the loop (dex + taken bne) but the last bne falls through, stx
+        EXPECT_GE( Results[i].CyclesUsed, 2 + (i + 1) * 5 - 1 + 3 );
+    }
+}
+
+TEST_F( M6502BatchRunnerTests, InstancesStopAtTheBudgetOrAnIllegalOpcode )
+{
+    // Given:
+    BatchRunner Runner( 2, 2 );
+    LoadCountdown( Runner, 0, 0 );          // 256 times round the loop
+    LoadCountdown( Runner, 1, 1 );
+    Runner.GetMem( 1 )[0x1007] = 0x02;      // not a legal opcode
+
+    // When:
+    const std::vector<BatchRunner::Result>& Results = Runner.Run( 100 );
+
+    // Then:
+    EXPECT_EQ( Results[0].Reason, BatchRunner::ExitReason::Budget );
+    EXPECT_GE( Results[0].CyclesUsed, 100u );
+    EXPECT_EQ( Results[1].Reason, BatchRunner::ExitReason::IllegalOpcode );
+    EXPECT_EQ( Results[1].PC, 0x1007 );
+}
+
+TEST_F( M6502BatchRunnerTests, ABudgetPastFourBillionCyclesIsNotCutShort )
+{
+    // Given:
+    BatchRunner Runner( 1, 1 );
+    LoadCountdown( Runner, 0, 0 );          // 256 times round the loop
+
+    // When:
+    const std::vector<BatchRunner::Result>& Results = Runner.Run( (1ull << 32) + 100, 50, IsAtTheEnd );
+
+    // Then:
+    EXPECT_EQ( Results[0].Reason, BatchRunner::ExitReason::Halted );
+    EXPECT_GT( Results[0].CyclesUsed, 100u );
+}
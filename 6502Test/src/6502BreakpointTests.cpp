@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "m6502.h"
+#include "m6502_breakpoints.h"
+#include "m6502_harness.h"
+#include "6502TestCommon.h"
+
+using namespace m6502;
+
+class M6502BreakpointTests : public testing::Test {
+protected:
+
+    Mem mem;
+    CPU cpu;
+    Breakpoints Breaks;
+
+    virtual void SetUp(){
+        cpu.Reset( mem );
+        cpu.Breaks = &Breaks;
+    }
+
+    virtual void TearDown(){
+    }
+};
+
+TEST_F( M6502BreakpointTests, InterpretStopsBeforeTheInstructionAtABreakpoint )
+{
+    // Given:
+    cpu.PC = cpu.LoadPrg( CountdownPrg, sizeof(CountdownPrg), mem );
+    cpu.A = 0x42;
+    Breaks.Set( 0x1005 );
+    constexpr s32 EXPECTED_CYCLES = COUNTDOWN_CYCLES - 2;     // Not the lda
+
+    // When:
+    const s32 CyclesUsed = cpu.Interpret( 100, mem );
+
+    // Then:
+    EXPECT_EQ( CyclesUsed, EXPECTED_CYCLES );
+    EXPECT_EQ( cpu.Halted, CPU::HaltReason::Breakpoint );
+    EXPECT_EQ( cpu.PC, 0x1005 );
+    EXPECT_EQ( cpu.X, 0x00 );
+    EXPECT_EQ( cpu.A, 0x42 );
+}
+
+TEST_F( M6502BreakpointTests, InterpretingAgainRunsTheInstructionAtTheBreakpoint )
+{
+    // Given:
+    cpu.PC = cpu.LoadPrg( CountdownPrg, sizeof(CountdownPrg), mem );
+    Breaks.Set( 0x1002 );
+
+    // When:
+    const s32 ToBreakpoint = cpu.Interpret( 100, mem );
+    const Byte FirstX = cpu.X;
+    const s32 AroundTheLoop = cpu.Interpret( 100, mem );
+
+    // Then:
+    EXPECT_EQ( ToBreakpoint, 2 );
+    EXPECT_EQ( FirstX, 0x03 );
+    EXPECT_EQ( AroundTheLoop, 2 + 3 );
+    EXPECT_EQ( cpu.Halted, CPU::HaltReason::Breakpoint );
+    EXPECT_EQ( cpu.PC, 0x1002 );
+    EXPECT_EQ( cpu.X, 0x02 );
+}
+
+TEST_F( M6502BreakpointTests, ClearingTheLastBreakpointOnAPageDisarmsIt )
+{
+    // Given:
+    cpu.PC = cpu.LoadPrg( CountdownPrg, sizeof(CountdownPrg), mem );
+    Breaks.Set( 0x1002 );
+    Breaks.Set( 0x10FF );
+    Breaks.Set( 0x2000 );
+
+    // When:
+    Breaks.Clear( 0x1002 );
+    const bool ArmedWithOneLeft = Breaks.IsPageArmed( 0x10 );
+    Breaks.Clear( 0x10FF );
+    const s32 CyclesUsed = cpu.Interpret( 20, mem );
+
+    // Then:
+    EXPECT_TRUE( ArmedWithOneLeft );
+    EXPECT_FALSE( Breaks.IsPageArmed( 0x10 ) );
+    EXPECT_TRUE( Breaks.IsPageArmed( 0x20 ) );
+    EXPECT_EQ( Breaks.Count(), 1u );
+    EXPECT_GE( CyclesUsed, 20 );
+    EXPECT_EQ( cpu.Halted, CPU::HaltReason::None );
+}
+
+TEST_F( M6502BreakpointTests, TheTrapHarnessStopsAtABreakpoint )
+{
+    // Given:
+    cpu.PC = cpu.LoadPrg( CountdownPrg, sizeof(CountdownPrg), mem );
+    Breaks.Set( 0x1005 );
+
+    // When:
+    const TrapHarness::Result Run = TrapHarness::Run( cpu, mem, 0x1007, 1000 );
+
+    // Then:
+    EXPECT_EQ( Run.Status, TrapHarness::Outcome::Breakpoint );
+    EXPECT_EQ( Run.TrapAddress, 0x1005 );
+    EXPECT_EQ( Run.Cycles, 2u + (2 + 3) * 2 + 2 + 2 );
+}
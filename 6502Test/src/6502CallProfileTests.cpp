@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "m6502.h"
+#include "m6502_callprofile.h"
+#include "m6502_breakpoints.h"
+
+using namespace m6502;
+
+class M6502CallProfileTests : public testing::Test {
+protected:
+
+    Mem mem;
+    CPU cpu;
+    CallProfile Profile;
+
+    virtual void SetUp(){
+        cpu.Reset( 0x1000, mem );
+    }
+
+    virtual void TearDown(){
+    }
+
+    /* jsr $2000 ; lda #0 at $1000, $2000: jsr $3000 ; rts, $3000: nop ; rts */
+    void LoadNestedCalls() {
+        mem[0x1000] = CPU::INS_JSR;
+        mem[0x1001] = 0x00;
+        mem[0x1002] = 0x20;
+        mem[0x1003] = CPU::INS_LDA_IM;
+        mem[0x1004] = 0x00;
+        mem[0x2000] = CPU::INS_JSR;
+        mem[0x2001] = 0x00;
+        mem[0x2002] = 0x30;
+        mem[0x2003] = CPU::INS_RTS;
+        mem[0x3000] = CPU::INS_NOP;
+        mem[0x3001] = CPU::INS_RTS;
+    }
+    static constexpr s32 NESTED_CALLS_CYCLES = 6 + 6 + 2 + 6 + 6 + 2;
+};
+
+TEST_F( M6502CallProfileTests, CallersAreChargedInclusiveCyclesAndCalleesExclusive )
+{
+    // Given:
+    LoadNestedCalls();
+
+    // When:
+    const s32 ActualCycles = Profile.Execute( NESTED_CALLS_CYCLES, cpu, mem );
+    const std::vector<CallProfile::Routine> Routines = Profile.Routines();
+
+    // Then:
+    EXPECT_EQ( ActualCycles, NESTED_CALLS_CYCLES );
+    EXPECT_EQ( Profile.Depth(), 0u );
+    ASSERT_EQ( Routines.size(), 2u );
+    EXPECT_EQ( Routines[0].Address, 0x2000 );
+    EXPECT_EQ( Routines[0].Name, "$2000" );
+    EXPECT_EQ( Routines[0].Calls, 1u );
+    EXPECT_EQ( Routines[0].ExclusiveCycles, 6u + 6 );
+    EXPECT_EQ( Routines[0].InclusiveCycles, 6u + 6 + 2 + 6 );
+    EXPECT_EQ( Routines[1].Address, 0x3000 );
+    EXPECT_EQ( Routines[1].ExclusiveCycles, 2u + 6 );
+    EXPECT_EQ( Routines[1].InclusiveCycles, 2u + 6 );
+}
+
+TEST_F( M6502CallProfileTests, FoldedStacksHaveALinePerCallPath )
+{
+    // Given:
+    LoadNestedCalls();
+    Profile.Execute( NESTED_CALLS_CYCLES, cpu, mem );
+    FILE* File = tmpfile();
+    ASSERT_NE( File, nullptr );
+
+    // When:
+    Profile.WriteFoldedStacks( File );
+
+    // Then:
+    char Folded[256] = {};
+    rewind( File );
+    fread( Folded, 1, sizeof(Folded) - 1, File );
+    fclose( File );
+    EXPECT_STREQ( Folded, "root 8\nroot;$2000 12\nroot;$2000;$3000 8\n" );
+}
+
+TEST_F( M6502CallProfileTests, FramesFollowTheStackPointerThroughStackTricks )
+{
+    // Given:
+    // $3000 jumps to $3010 by pushing $300F and returning, then drops the
+    // return address to $2000 and returns straight to $1003
+    mem[0x1000] = CPU::INS_JSR;
+    mem[0x1001] = 0x00;
+    mem[0x1002] = 0x20;
+    mem[0x1003] = CPU::INS_NOP;
+    mem[0x2000] = CPU::INS_JSR;
+    mem[0x2001] = 0x00;
+    mem[0x2002] = 0x30;
+    mem[0x3000] = CPU::INS_LDA_IM;
+    mem[0x3001] = 0x30;
+    mem[0x3002] = CPU::INS_PHA;
+    mem[0x3003] = CPU::INS_LDA_IM;
+    mem[0x3004] = 0x0F;
+    mem[0x3005] = CPU::INS_PHA;
+    mem[0x3006] = CPU::INS_RTS;
+    mem[0x3010] = CPU::INS_PLA;
+    mem[0x3011] = CPU::INS_PLA;
+    mem[0x3012] = CPU::INS_RTS;
+    constexpr s32 EXPECTED_CYCLES = 6 + 6 + (2 + 3 + 2 + 3 + 6) + (4 + 4 + 6) + 2;
+
+    // When:
+    const s32 ActualCycles = Profile.Execute( EXPECTED_CYCLES, cpu, mem );
+    const std::vector<CallProfile::Routine> Routines = Profile.Routines();
+
+    // Then:
+    EXPECT_EQ( ActualCycles, EXPECTED_CYCLES );
+    EXPECT_EQ( cpu.PC, 0x1004 );
+    EXPECT_EQ( Profile.Depth(), 0u );
+    ASSERT_EQ( Routines.size(), 2u );
+    EXPECT_EQ( Routines[0].Address, 0x2000 );
+    EXPECT_EQ( Routines[0].InclusiveCycles, 6u + 2 + 3 + 2 + 3 + 6 + 4 + 4 + 6 );
+    EXPECT_EQ( Routines[1].Address, 0x3000 );
+    EXPECT_EQ( Routines[1].Calls, 1u );
+    EXPECT_EQ( Routines[1].ExclusiveCycles, 2u + 3 + 2 + 3 + 6 + 4 + 4 + 6 );
+}
+
+TEST_F( M6502CallProfileTests, ABreakpointOnAJsrDoesNotCallTwice )
+{
+    // Given:
+    LoadNestedCalls();
+    Breakpoints Breaks;
+    Breaks.Set( 0x1000 );
+    cpu.Breaks = &Breaks;
+
+    // When:
+    const s32 ToBreakpoint = Profile.Execute( NESTED_CALLS_CYCLES, cpu, mem );
+    const u32 DepthAtBreakpoint = Profile.Depth();
+    const s32 ActualCycles = Profile.Execute( NESTED_CALLS_CYCLES, cpu, mem );
+    const std::vector<CallProfile::Routine> Routines = Profile.Routines();
+
+    // Then:
+    EXPECT_EQ( ToBreakpoint, 0 );
+    EXPECT_EQ( DepthAtBreakpoint, 0u );
+    EXPECT_EQ( ActualCycles, NESTED_CALLS_CYCLES );
+    EXPECT_EQ( Profile.Depth(), 0u );
+    ASSERT_EQ( Routines.size(), 2u );
+    EXPECT_EQ( Routines[0].Address, 0x2000 );
+    EXPECT_EQ( Routines[0].Calls, 1u );
+    EXPECT_EQ( Routines[0].InclusiveCycles, 6u + 6 + 2 + 6 );
+    EXPECT_EQ( Routines[1].Calls, 1u );
+}
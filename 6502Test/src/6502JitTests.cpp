@@ -0,0 +1,407 @@
+#include <gtest/gtest.h>
+#include "m6502.h"
+
+#if defined( M6502_JIT )
+#include "m6502_breakpoints.h"
+#include "m6502_jit.h"
+#include "6502TestCommon.h"
+
+using namespace m6502;
+
+/* An I/O page for the JIT to stay off */
+struct CountingDevice {
+    u32 NumReads = 0;
+    u32 NumWrites = 0;
+    Byte LastWritten = 0;
+    Word LastAddress = 0;
+
+    Mem::PageHandler Handler() {
+        Mem::PageHandler Handler;
+        Handler.Context = this;
+        Handler.Read = []( void* Context, Word ) -> Byte {
+            return (Byte)static_cast<CountingDevice*>( Context )->NumReads++;
+        };
+        Handler.Write = []( void* Context, Word Address, Byte Value ) {
+            CountingDevice* Device = static_cast<CountingDevice*>( Context );
+            Device->NumWrites++;
+            Device->LastWritten = Value;
+            Device->LastAddress = Address;
+        };
+        return Handler;
+    }
+};
+
+class M6502JitTests : public testing::Test {
+protected:
+
+    Mem mem;
+    CPU cpu;
+    Jit jit{ 0 };   // Translate everything the first time it is entered
+
+    virtual void SetUp(){
+        cpu.Reset( mem );
+    }
+
+    virtual void TearDown(){
+    }
+};
+
+TEST_F( M6502JitTests, RunsAProgramExactlyLikeTheInterpreter )
+{
+    // Given:
+    Mem InterpretedMem;
+    CPU Interpreted;
+    Interpreted.Reset( InterpretedMem );
+    Interpreted.PC = Interpreted.LoadPrg( LoopPrg, sizeof(LoopPrg), InterpretedMem );
+    cpu.PC = cpu.LoadPrg( LoopPrg, sizeof(LoopPrg), mem );
+
+    // When:
+    const s32 InterpretedCycles = Interpreted.Interpret( 101, InterpretedMem );
+    const s32 JitCycles = jit.Execute( 101, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( JitCycles, InterpretedCycles );
+    EXPECT_EQ( cpu.PC, Interpreted.PC );
+    EXPECT_EQ( cpu.PC, 0x100C );
+    EXPECT_EQ( cpu.A, Interpreted.A );
+    EXPECT_EQ( cpu.X, Interpreted.X );
+    EXPECT_EQ( cpu.Y, Interpreted.Y );
+    EXPECT_EQ( cpu.SP, Interpreted.SP );
+    EXPECT_EQ( cpu.PS, Interpreted.PS );
+    for ( Word Address = 0x40; Address <= 0x45; Address++ )
+    {
+        EXPECT_EQ( mem[Address], InterpretedMem[Address] );
+    }
+}
+
+TEST_F( M6502JitTests, EveryCycleBudgetStopsWhereTheInterpreterDoes )
+{
+    for ( s32 Cycles = 1; Cycles < 60; Cycles++ )
+    {
+        // Given:
+        cpu.Reset( mem );
+        cpu.PC = cpu.LoadPrg( LoopPrg, sizeof(LoopPrg), mem );
+        Mem InterpretedMem;
+        CPU Interpreted = cpu;
+        Interpreted.LoadPrg( LoopPrg, sizeof(LoopPrg), InterpretedMem );
+
+        // When:
+        const s32 InterpretedCycles = Interpreted.Interpret( Cycles, InterpretedMem );
+        const s32 JitCycles = jit.Execute( Cycles, cpu, mem );
+
+        // Then:
+        EXPECT_EQ( JitCycles, InterpretedCycles );
+        EXPECT_EQ( cpu.PC, Interpreted.PC );
+        EXPECT_EQ( cpu.A, Interpreted.A );
+        EXPECT_EQ( cpu.X, Interpreted.X );
+        EXPECT_EQ( cpu.PS, Interpreted.PS );
+    }
+}
+
+TEST_F( M6502JitTests, HotBlocksAreTranslated )
+{
+    // Given:
+    cpu.PC = cpu.LoadPrg( LoopPrg, sizeof(LoopPrg), mem );
+
+    // When:
+    jit.Execute( 1000, cpu, mem );
+
+    // Then:
+    EXPECT_TRUE( jit.IsCompiled( 0x1000 ) );
+    EXPECT_TRUE( jit.IsCompiled( 0x1004 ) );
+    EXPECT_TRUE( jit.IsCompiled( 0x100C ) );
+    EXPECT_FALSE( jit.IsCompiled( 0x1005 ) );
+}
+
+TEST_F( M6502JitTests, SelfModifyingCodeInTheRunningBlockIsSeen )
+{
+    // Given:
+    // lda #INS_LDY_IM ; sta $1005 ; ldx #$42 (becomes ldy #$42) ; jmp *
+    cpu.Reset( 0x1000, mem );
+    mem[0x1000] = CPU::INS_LDA_IM;
+    mem[0x1001] = CPU::INS_LDY_IM;
+    mem[0x1002] = CPU::INS_STA_ABS;
+    mem[0x1003] = 0x05;
+    mem[0x1004] = 0x10;
+    mem[0x1005] = CPU::INS_LDX_IM;
+    mem[0x1006] = 0x42;
+    mem[0x1007] = CPU::INS_JMP_ABS;
+    mem[0x1008] = 0x07;
+    mem[0x1009] = 0x10;
+    constexpr s32 EXPECTED_CYCLES = 2 + 4 + 2 + 3;
+
+    // When:
+    const s32 ActualCycles = jit.Execute( EXPECTED_CYCLES, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( ActualCycles, EXPECTED_CYCLES );
+    EXPECT_EQ( cpu.Y, 0x42 );
+    EXPECT_EQ( cpu.X, 0x00 );
+    EXPECT_EQ( cpu.PC, 0x1007 );
+}
+
+TEST_F( M6502JitTests, WritingCodeFromOutsideDropsTheBlock )
+{
+    // Given:
+    cpu.Reset( 0x1000, mem );
+    mem[0x1000] = CPU::INS_LDX_IM;
+    mem[0x1001] = 0x42;
+    mem[0x1002] = CPU::INS_JMP_ABS;
+    mem[0x1003] = 0x00;
+    mem[0x1004] = 0x10;
+    jit.Execute( 10, cpu, mem );
+    EXPECT_EQ( cpu.X, 0x42 );
+    ASSERT_TRUE( jit.IsCompiled( 0x1000 ) );
+
+    // When:
+    mem[0x1000] = CPU::INS_LDY_IM;
+    cpu.PC = 0x1000;
+    jit.Execute( 2, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( cpu.Y, 0x42 );
+}
+
+TEST_F( M6502JitTests, AnotherMemWithTheSameCodeKeepsTheBlocks )
+{
+    // Given:
+    cpu.PC = cpu.LoadPrg( LoopPrg, sizeof(LoopPrg), mem );
+    jit.Execute( 1000, cpu, mem );
+    const u32 NumBlocks = jit.NumBlocks();
+    Mem OtherMem;
+    CPU Other;
+    Other.Reset( OtherMem );
+    Other.PC = Other.LoadPrg( LoopPrg, sizeof(LoopPrg), OtherMem );
+
+    // When:
+    const s32 ActualCycles = jit.Execute( 101, Other, OtherMem );
+
+    // Then:
+    EXPECT_EQ( ActualCycles, 101 );
+    EXPECT_EQ( jit.NumBlocks(), NumBlocks );
+    EXPECT_TRUE( jit.IsCompiled( 0x1000 ) );
+    EXPECT_EQ( Other.PC, 0x100C );
+    EXPECT_EQ( Other.A, 0x0F );
+    EXPECT_EQ( OtherMem[0x45], 0x03 );
+}
+
+TEST_F( M6502JitTests, AnotherMemWithOtherCodeDropsTheBlocks )
+{
+    // Given:
+    cpu.PC = cpu.LoadPrg( LoopPrg, sizeof(LoopPrg), mem );
+    jit.Execute( 1000, cpu, mem );
+    ASSERT_TRUE( jit.IsCompiled( 0x1000 ) );
+    Mem OtherMem;
+    CPU Other;
+    Other.Reset( 0x1000, OtherMem );
+    OtherMem.Initialise();
+    OtherMem[0x1000] = CPU::INS_LDY_IM;
+    OtherMem[0x1001] = 0x42;
+    OtherMem[0x1002] = CPU::INS_JMP_ABS;
+    OtherMem[0x1003] = 0x02;
+    OtherMem[0x1004] = 0x10;
+
+    // When:
+    jit.Execute( 2 + 3, Other, OtherMem );
+
+    // Then:
+    EXPECT_EQ( Other.Y, 0x42 );
+    EXPECT_EQ( Other.X, 0x00 );
+    EXPECT_EQ( Other.PC, 0x1002 );
+}
+
+TEST_F( M6502JitTests, AMemAssignedOtherCodeAtTheSameAddressRunsIt )
+{
+    // Given:
+    cpu.PC = cpu.LoadPrg( LoopPrg, sizeof(LoopPrg), mem );
+    jit.Execute( 1000, cpu, mem );
+    ASSERT_TRUE( jit.IsCompiled( 0x1000 ) );
+    Mem OtherMem;
+    OtherMem.Initialise();
+    OtherMem[0x1000] = CPU::INS_LDY_IM;
+    OtherMem[0x1001] = 0x42;
+    OtherMem[0x1002] = CPU::INS_JMP_ABS;
+    OtherMem[0x1003] = 0x02;
+    OtherMem[0x1004] = 0x10;
+
+    // When:
+    mem = OtherMem;
+    cpu.PC = 0x1000;
+    jit.Execute( 2 + 3, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( cpu.Y, 0x42 );
+    EXPECT_EQ( cpu.PC, 0x1002 );
+}
+
+TEST_F( M6502JitTests, TheCodeBufferIsOnlyMadeWhenABlockIsTranslated )
+{
+    // Given:
+    const u32 SizeBefore = jit.CodeBufferSize();
+
+    // When:
+    cpu.PC = cpu.LoadPrg( LoopPrg, sizeof(LoopPrg), mem );
+    jit.Execute( 1000, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( SizeBefore, 0u );
+    EXPECT_EQ( jit.CodeBufferSize(), Jit::MIN_CODE_BUFFER_SIZE );
+}
+
+TEST_F( M6502JitTests, AnEngineWithNoCodeBufferStillRuns )
+{
+    // Given:
+    Jit NoCode{ 0, 0 };
+    cpu.PC = cpu.LoadPrg( LoopPrg, sizeof(LoopPrg), mem );
+
+    // When:
+    const s32 ActualCycles = NoCode.Execute( 101, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( ActualCycles, 101 );
+    EXPECT_EQ( NoCode.NumBlocks(), 0u );
+    EXPECT_EQ( NoCode.CodeBufferSize(), 0u );
+    EXPECT_EQ( cpu.A, 0x0F );
+    EXPECT_EQ( mem[0x45], 0x03 );
+}
+
+TEST_F( M6502JitTests, PlainRamIsTranslatedWithAnotherPageMapped )
+{
+    // Given:
+    CountingDevice Device;
+    mem.MapHandler( 0xD0, Device.Handler() );
+    cpu.PC = cpu.LoadPrg( LoopPrg, sizeof(LoopPrg), mem );
+    Mem InterpretedMem;
+    CPU Interpreted = cpu;
+    Interpreted.LoadPrg( LoopPrg, sizeof(LoopPrg), InterpretedMem );
+
+    // When:
+    const s32 InterpretedCycles = Interpreted.Interpret( 101, InterpretedMem );
+    const s32 JitCycles = jit.Execute( 101, cpu, mem );
+
+    // Then:
+    EXPECT_TRUE( jit.IsCompiled( 0x1004 ) );
+    EXPECT_EQ( JitCycles, InterpretedCycles );
+    EXPECT_EQ( cpu.PC, Interpreted.PC );
+    EXPECT_EQ( cpu.A, Interpreted.A );
+    EXPECT_EQ( mem[0x45], InterpretedMem[0x45] );
+}
+
+TEST_F( M6502JitTests, AccessesToAMappedPageGoThroughTheBus )
+{
+    // Given:
+    // ldx #$05 ; loop: lda $D000 ; sta $D000,x ; dex ; bne loop ; jmp *
+    CountingDevice Device;
+    mem.MapHandler( 0xD0, Device.Handler() );
+    cpu.Reset( 0x1000, mem );
+    const Byte Program[] = {
+        0xA2, 0x05, 0xAD, 0x00, 0xD0, 0x9D, 0x00, 0xD0, 0xCA, 0xD0, 0xF7, 0x4C, 0x0B, 0x10 };
+    mem.Load( Program, sizeof(Program), 0x1000 );
+    constexpr s32 EXPECTED_CYCLES = 2 + (4 + 5 + 2 + 3) * 5 - 1 + 3;
+
+    // When:
+    const s32 ActualCycles = jit.Execute( EXPECTED_CYCLES, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( ActualCycles, EXPECTED_CYCLES );
+    EXPECT_TRUE( jit.IsCompiled( 0x1008 ) );
+    EXPECT_EQ( Device.NumReads, 5u );
+    EXPECT_EQ( Device.NumWrites, 5u );
+    EXPECT_EQ( Device.LastWritten, 4 );
+    EXPECT_EQ( Device.LastAddress, 0xD001 );
+    EXPECT_EQ( cpu.A, 4 );
+    EXPECT_EQ( cpu.PC, 0x100B );
+}
+
+TEST_F( M6502JitTests, APageMappedAfterTranslatingGoesThroughTheBus )
+{
+    // Given:
+    // ldx #$03 ; loop: sta $D000,x ; dex ; bne loop ; jmp *
+    cpu.Reset( 0x1000, mem );
+    const Byte Program[] = { 0xA2, 0x03, 0x9D, 0x00, 0xD0, 0xCA, 0xD0, 0xFA, 0x4C, 0x08, 0x10 };
+    mem.Load( Program, sizeof(Program), 0x1000 );
+    jit.Execute( 100, cpu, mem );
+    ASSERT_TRUE( jit.IsCompiled( 0x1002 ) );
+
+    // When:
+    CountingDevice Device;
+    mem.MapHandler( 0xD0, Device.Handler() );
+    cpu.PC = 0x1000;
+    jit.Execute( 100, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( Device.NumWrites, 3u );
+    EXPECT_EQ( Device.LastAddress, 0xD001 );
+}
+
+TEST_F( M6502JitTests, MappingThePageOfTranslatedCodeRunsTheMappedCode )
+{
+    // Given:
+    cpu.Reset( 0x1000, mem );
+    mem[0x1000] = CPU::INS_LDX_IM;
+    mem[0x1001] = 0x42;
+    mem[0x1002] = CPU::INS_JMP_ABS;
+    mem[0x1003] = 0x00;
+    mem[0x1004] = 0x10;
+    jit.Execute( 10, cpu, mem );
+    ASSERT_TRUE( jit.IsCompiled( 0x1000 ) );
+    Byte Rom[Mem::PAGE_SIZE] = { CPU::INS_LDY_IM, 0x42, CPU::INS_JMP_ABS, 0x00, 0x10 };
+
+    // When:
+    mem.MapMemory( 0x10, Rom, true );
+    cpu.PC = 0x1000;
+    jit.Execute( 100, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( cpu.Y, 0x42 );
+    EXPECT_FALSE( jit.IsCompiled( 0x1000 ) );
+}
+
+TEST_F( M6502JitTests, PagesWithoutBreakpointsAreStillTranslated )
+{
+    // Given:
+    Breakpoints Breaks;
+    Breaks.Set( 0x2000 );
+    cpu.Breaks = &Breaks;
+    cpu.PC = cpu.LoadPrg( LoopPrg, sizeof(LoopPrg), mem );
+
+    // When:
+    jit.Execute( 1000, cpu, mem );
+
+    // Then:
+    EXPECT_TRUE( jit.IsCompiled( 0x1004 ) );
+    EXPECT_EQ( cpu.Halted, CPU::HaltReason::None );
+    EXPECT_EQ( cpu.A, 0x0F );
+    EXPECT_EQ( mem[0x45], 0x03 );
+}
+
+TEST_F( M6502JitTests, TranslatedCodeStopsAtABreakpointSetLater )
+{
+    // Given:
+    // $1000: ldx #$42 ; jmp $1100
+    // $1100: inx ; jmp $1000
+    cpu.Reset( 0x1000, mem );
+    const Byte Low[] = { CPU::INS_LDX_IM, 0x42, CPU::INS_JMP_ABS, 0x00, 0x11 };
+    const Byte High[] = { CPU::INS_INX, CPU::INS_JMP_ABS, 0x00, 0x10 };
+    mem.Load( Low, sizeof(Low), 0x1000 );
+    mem.Load( High, sizeof(High), 0x1100 );
+    jit.Execute( 100, cpu, mem );
+    ASSERT_TRUE( jit.IsCompiled( 0x1000 ) );
+    ASSERT_TRUE( jit.IsCompiled( 0x1100 ) );
+    Breakpoints Breaks;
+    Breaks.Set( 0x1100 );
+    cpu.Breaks = &Breaks;
+
+    // When:
+    jit.Execute( 1000, cpu, mem );
+    const Word FirstStop = cpu.PC;
+    jit.Execute( 1000, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( FirstStop, 0x1100 );
+    EXPECT_EQ( cpu.Halted, CPU::HaltReason::Breakpoint );
+    EXPECT_EQ( cpu.PC, 0x1100 );
+    EXPECT_EQ( cpu.X, 0x42 );
+    EXPECT_TRUE( jit.IsCompiled( 0x1000 ) );
+}
+#endif
@@ -0,0 +1,259 @@
+#include <gtest/gtest.h>
+#include "m6502.h"
+#include "m6502_journal.h"
+#include "m6502_breakpoints.h"
+
+using namespace m6502;
+
+class M6502JournalTests : public testing::Test {
+protected:
+
+    Mem mem;
+    CPU cpu;
+    u32 Seed = 1;
+
+    /* A device at $D0xx that reads as a different number every time */
+    static Byte ReadNoise( void* Context, Word ) {
+        u32& State = *static_cast<u32*>( Context );
+        State = State * 1103515245 + 12345;
+        return (Byte)(State >> 16);
+    }
+
+    static Byte ReadBroken( void*, Word ) {
+        return 0xEE;
+    }
+
+    /*
+    * = $1000
+    loop
+        lda $D000
+        clc
+        adc $40
+        sta $40
+        jmp loop
+    */
+    void Setup( Mem& memory, CPU& Cpu, Byte (*Read)( void*, Word ) ) {
+        Cpu.Reset( 0x1000, memory );
+        const Byte Loop[] = { 0xAD, 0x00, 0xD0, 0x18, 0x65, 0x40, 0x85, 0x40, 0x4C, 0x00, 0x10 };
+        memory.Load( Loop, sizeof(Loop), 0x1000 );
+        Mem::PageHandler Device;
+        Device.Read = Read;
+        Device.Context = &Seed;
+        memory.MapHandler( 0xD0, Device );
+    }
+
+    /* A device at $D0xx whose reads of $D000 raise IRQ every 7th time and
+    *  NMI every 11th, reading $D001 acknowledges the IRQ */
+    struct Interrupting {
+        Journal* Journalled;
+        CPU* Cpu;
+        u32 State = 1;
+        u32 NumReads = 0;
+    };
+
+    static Byte ReadInterrupting( void* Context, Word Address ) {
+        Interrupting& Device = *static_cast<Interrupting*>( Context );
+        if ( Address == 0xD001 )
+        {
+            Device.Journalled->SetIrq( *Device.Cpu, false );
+            return 0;
+        }
+        Device.State = Device.State * 1103515245 + 12345;
+        if ( ++Device.NumReads % 7 == 0 )
+        {
+            Device.Journalled->SetIrq( *Device.Cpu, true );
+        }
+        if ( Device.NumReads % 11 == 0 )
+        {
+            Device.Journalled->TriggerNmi( *Device.Cpu );
+        }
+        return (Byte)(Device.State >> 16);
+    }
+
+    /*
+    * = $1000
+        cli
+    loop
+        lda $D000
+        clc
+        adc $40
+        sta $40
+        jmp loop
+    * = $1100
+    irq
+        lda $D001
+        inc $41
+        rti
+    * = $1110
+    nmi
+        inc $42
+        rti
+    */
+    void SetupInterrupts( Mem& memory, CPU& Cpu, Mem::PageHandler Device ) {
+        Cpu.Reset( 0x1000, memory );
+        const Byte Loop[] = { 0x58, 0xAD, 0x00, 0xD0, 0x18, 0x65, 0x40, 0x85, 0x40, 0x4C, 0x01, 0x10 };
+        const Byte Irq[] = { 0xAD, 0x01, 0xD0, 0xE6, 0x41, 0x40 };
+        const Byte Nmi[] = { 0xE6, 0x42, 0x40 };
+        const Byte Vectors[] = { 0x10, 0x11, 0x00, 0x00, 0x00, 0x11 };
+        memory.Load( Loop, sizeof(Loop), 0x1000 );
+        memory.Load( Irq, sizeof(Irq), 0x1100 );
+        memory.Load( Nmi, sizeof(Nmi), 0x1110 );
+        memory.Load( Vectors, sizeof(Vectors), 0xFFFA );
+        memory.MapHandler( 0xD0, Device );
+    }
+
+    virtual void SetUp(){
+        Setup( mem, cpu, ReadNoise );
+    }
+
+    virtual void TearDown(){
+    }
+};
+
+TEST_F( M6502JournalTests, AReplayMatchesTheRecordingWithoutTheDevice )
+{
+    // Given:
+    Journal Recording;
+    ASSERT_TRUE( Recording.Attach( 0xD0, mem ) );
+    for ( u32 Slice = 0; Slice < 10; Slice++ )
+    {
+        Recording.Execute( 150, cpu, mem );
+    }
+    Mem ReplayMem;
+    CPU ReplayCPU;
+    Setup( ReplayMem, ReplayCPU, ReadBroken );
+    Journal Replay( Recording.GetBytes() );
+    ASSERT_TRUE( Replay.Attach( 0xD0, ReplayMem ) );
+
+    // When:
+    for ( u32 Slice = 0; Slice < 10; Slice++ )
+    {
+        Replay.Execute( 150, ReplayCPU, ReplayMem );
+    }
+
+    // Then:
+    EXPECT_FALSE( Replay.HasDiverged() );
+    EXPECT_EQ( Replay.Cycles(), Recording.Cycles() );
+    EXPECT_EQ( Recording.GetBytes().size(), 2u * 100 );        // 100 reads, 15 cycles apart
+    EXPECT_EQ( ReplayCPU.PC, cpu.PC );
+    EXPECT_EQ( ReplayCPU.A, cpu.A );
+    EXPECT_EQ( ReplayCPU.PS, cpu.PS );
+    EXPECT_EQ( ReplayMem.Read( 0x40 ), mem.Read( 0x40 ) );
+}
+
+TEST_F( M6502JournalTests, ReplayingFromACheckpointMatches )
+{
+    // Given:
+    Journal Recording;
+    Recording.Attach( 0xD0, mem );
+    Recording.Execute( 600, cpu, mem );
+    const Journal::Position Checkpoint = Recording.Tell();
+    const Mem CheckpointMem = mem;
+    const CPU CheckpointCPU = cpu;
+    Recording.Execute( 600, cpu, mem );
+
+    Mem ReplayMem = CheckpointMem;
+    CPU ReplayCPU = CheckpointCPU;
+    Journal Replay( Recording.GetBytes() );
+    Mem::PageHandler Broken;
+    Broken.Read = ReadBroken;
+    ReplayMem.MapHandler( 0xD0, Broken );
+    Replay.Attach( 0xD0, ReplayMem );
+
+    // When:
+    Replay.Seek( Checkpoint );
+    Replay.Execute( 600, ReplayCPU, ReplayMem );
+
+    // Then:
+    EXPECT_FALSE( Replay.HasDiverged() );
+    EXPECT_EQ( Replay.Cycles(), Recording.Cycles() );
+    EXPECT_EQ( ReplayCPU.A, cpu.A );
+    EXPECT_EQ( ReplayMem.Read( 0x40 ), mem.Read( 0x40 ) );
+}
+
+TEST_F( M6502JournalTests, ReadingPastTheRecordingDiverges )
+{
+    // Given:
+    Journal Recording;
+    Recording.Attach( 0xD0, mem );
+    Recording.Execute( 150, cpu, mem );
+    Mem ReplayMem;
+    CPU ReplayCPU;
+    Setup( ReplayMem, ReplayCPU, ReadBroken );
+    Journal Replay( Recording.GetBytes() );
+    Replay.Attach( 0xD0, ReplayMem );
+
+    // When:
+    Replay.Execute( 300, ReplayCPU, ReplayMem );
+
+    // Then:
+    EXPECT_TRUE( Replay.HasDiverged() );
+}
+
+TEST_F( M6502JournalTests, InterruptsFromADeviceReplayAtTheSameCycles )
+{
+    // Given:
+    Mem RecordMem;
+    CPU RecordCPU;
+    Journal Recording;
+    Interrupting Device{ &Recording, &RecordCPU };
+    Mem::PageHandler Handler;
+    Handler.Read = ReadInterrupting;
+    Handler.Context = &Device;
+    SetupInterrupts( RecordMem, RecordCPU, Handler );
+    ASSERT_TRUE( Recording.Attach( 0xD0, RecordMem ) );
+    for ( u32 Slice = 0; Slice < 20; Slice++ )
+    {
+        Recording.Execute( 150, RecordCPU, RecordMem );
+    }
+    Mem ReplayMem;
+    CPU ReplayCPU;
+    Mem::PageHandler Broken;
+    Broken.Read = ReadBroken;
+    SetupInterrupts( ReplayMem, ReplayCPU, Broken );
+    Journal Replay( Recording.GetBytes() );
+    ASSERT_TRUE( Replay.Attach( 0xD0, ReplayMem ) );
+
+    // When:
+    for ( u32 Slice = 0; Slice < 20; Slice++ )
+    {
+        Replay.Execute( 150, ReplayCPU, ReplayMem );
+    }
+
+    // Then:
+    EXPECT_FALSE( Replay.HasDiverged() );
+    EXPECT_GT( RecordMem.Read( 0x41 ), 0 );
+    EXPECT_GT( RecordMem.Read( 0x42 ), 0 );
+    EXPECT_EQ( Replay.Cycles(), Recording.Cycles() );
+    EXPECT_EQ( ReplayCPU.PC, RecordCPU.PC );
+    EXPECT_EQ( ReplayCPU.A, RecordCPU.A );
+    EXPECT_EQ( ReplayCPU.SP, RecordCPU.SP );
+    EXPECT_EQ( ReplayCPU.PS, RecordCPU.PS );
+    EXPECT_EQ( ReplayCPU.PendingEvents, RecordCPU.PendingEvents );
+    for ( Word Address = 0x40; Address <= 0x42; Address++ )
+    {
+        EXPECT_EQ( ReplayMem.Read( Address ), RecordMem.Read( Address ) );
+    }
+}
+
+TEST_F( M6502JournalTests, ExecuteStopsAtABreakpoint )
+{
+    // Given:
+    Journal Recording;
+    Recording.Attach( 0xD0, mem );
+    Breakpoints Breaks;
+    Breaks.Set( 0x1003 );
+    cpu.Breaks = &Breaks;
+
+    // When:
+    const s32 ToBreakpoint = Recording.Execute( 150, cpu, mem );
+    const s32 AroundTheLoop = Recording.Execute( 150, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( ToBreakpoint, 4 );
+    EXPECT_EQ( AroundTheLoop, 15 );
+    EXPECT_EQ( Recording.Cycles(), 4u + 15 );
+    EXPECT_EQ( Recording.GetBytes().size(), 2u * 2 );
+    EXPECT_EQ( cpu.Halted, CPU::HaltReason::Breakpoint );
+    EXPECT_EQ( cpu.PC, 0x1003 );
+}
@@ -121,4 +121,63 @@ TEST_F( M6502JumpsAndCallsTests, JumpIndirectCanJumpToANewLocationInTheProgram )
     EXPECT_EQ( ActualCycles, EXPECTED_CYCLES );
     EXPECT_EQ( cpu.PS, CPUCopy.PS );
     EXPECT_EQ( cpu.PC, 0x9000 );
-}
\ No newline at end of file
+}
+
+TEST_F( M6502JumpsAndCallsTests, AJumpToItselfHaltsExecuteWhenHaltOnTrapIsSet )
+{
+    // Given:
+    cpu.Reset( 0xFF00, mem );
+    cpu.HaltOnTrap = true;
+    mem[0xFF00] = CPU::INS_LDA_IM;
+    mem[0xFF01] = 0x42;
+    mem[0xFF02] = CPU::INS_JMP_ABS;
+    mem[0xFF03] = 0x02;
+    mem[0xFF04] = 0xFF;
+    constexpr s32 EXPECTED_CYCLES = 2 + 3;
+
+    // When:
+    const s32 ActualCycles = cpu.Execute( 1000, mem );
+
+    // Then:
+    EXPECT_EQ( ActualCycles, EXPECTED_CYCLES );
+    EXPECT_EQ( cpu.Halted, CPU::HaltReason::Trap );
+    EXPECT_EQ( cpu.PC, 0xFF02 );
+    EXPECT_EQ( cpu.A, 0x42 );
+}
+
+TEST_F( M6502JumpsAndCallsTests, ABranchToItselfHaltsExecuteWhenHaltOnTrapIsSet )
+{
+    // Given:
+    cpu.Reset( 0xFF00, mem );
+    cpu.HaltOnTrap = true;
+    cpu.Flag.Z = false;
+    mem[0xFF00] = CPU::INS_BNE;
+    mem[0xFF01] = 0xFE;
+    constexpr s32 EXPECTED_CYCLES = 3;
+
+    // When:
+    const s32 ActualCycles = cpu.Execute( 1000, mem );
+
+    // Then:
+    EXPECT_EQ( ActualCycles, EXPECTED_CYCLES );
+    EXPECT_EQ( cpu.Halted, CPU::HaltReason::Trap );
+    EXPECT_EQ( cpu.PC, 0xFF00 );
+}
+
+TEST_F( M6502JumpsAndCallsTests, AJumpToItselfKeepsRunningWithoutHaltOnTrap )
+{
+    // Given:
+    cpu.Reset( 0xFF00, mem );
+    mem[0xFF00] = CPU::INS_JMP_ABS;
+    mem[0xFF01] = 0x00;
+    mem[0xFF02] = 0xFF;
+    constexpr s32 EXPECTED_CYCLES = 3 * 10;
+
+    // When:
+    const s32 ActualCycles = cpu.Execute( EXPECTED_CYCLES, mem );
+
+    // Then:
+    EXPECT_EQ( ActualCycles, EXPECTED_CYCLES );
+    EXPECT_EQ( cpu.Halted, CPU::HaltReason::None );
+    EXPECT_EQ( cpu.PC, 0xFF00 );
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include "m6502.h"
+#include "m6502_harness.h"
+#include "m6502_loader.h"
+#include "6502TestCommon.h"
 
 using namespace m6502;
 
@@ -74,26 +77,106 @@ TEST_F( M6502LoadPrgTests, TestLoadProgramAndExecuteIt )
 }
 
 
-TEST_F( M6502LoadPrgTests, LoadThe6502TestPrg )
+TEST_F( M6502LoadPrgTests, TheFunctionalTestPrgRunsToTheSuccessTrap )
 {
-#if 0   // Test program that doesnt finish!   
-        // Given:
-        
-        // When: 
-        FILE* fp;
-        fopen_s( &fp,
-        "6502FunctionalTestAsm\\6502_functional_test.bin", 
-        "rb");
-
-        fread( &mem[0x000A], 1, 65526, fp );
-        fclose( fp );
-
-        cpu.PC = 0x400;
-
-        // Then:
-        while ( true )
-        {
-            cpu.Execute( 1, mem );
-        }
-#endif        
-}
\ No newline at end of file
+    // Given:
+    MappedFile TestBin( M6502_FUNCTIONAL_TEST_DIR "6502_functional_test.bin" );
+    ASSERT_TRUE( TestBin.IsOpen() );
+    TestBin.LoadBin( 0x000A, mem );
+    const Word SuccessAddress = TrapHarness::FindSuccessAddress( M6502_FUNCTIONAL_TEST_DIR "6502_functional_test.lst" );
+    ASSERT_EQ( SuccessAddress, 0x3469 );
+    cpu.PC = 0x400;
+
+    // When:
+    const TrapHarness::Result Run = TrapHarness::Run( cpu, mem, SuccessAddress, 200000000ull );
+
+    // Then:
+    EXPECT_EQ( Run.Status, TrapHarness::Outcome::Passed );
+    EXPECT_EQ( Run.TrapAddress, SuccessAddress );
+}
+
+TEST_F( M6502LoadPrgTests, TheTrapHarnessRestoresHaltOnTrapWhenADeviceThrows )
+{
+    // Given:
+    // lda $D000 (the device throws)
+    Mem::PageHandler Handler;
+    Handler.Read = []( void*, Word ) -> Byte {
+        throw 42;
+    };
+    mem.MapHandler( 0xD0, Handler );
+    cpu.Reset( 0xFF00 );
+    mem[0xFF00] = CPU::INS_LDA_ABS;
+    mem[0xFF01] = 0x00;
+    mem[0xFF02] = 0xD0;
+    cpu.HaltOnTrap = false;
+
+    // When:
+    EXPECT_THROW( TrapHarness::Run( cpu, mem, 0xFF00, 1000 ), int );
+
+    // Then:
+    EXPECT_FALSE( cpu.HaltOnTrap );
+}
+
+/* Writes TestPrg to a file for the MappedFile tests */
+static void WriteTestPrgFile( const TempFile& File )
+{
+    FILE* fp = fopen( File.c_str(), "wb" );
+    ASSERT_NE( fp, nullptr );
+    fwrite( TestPrg, 1, NumBytesInPrg, fp );
+    fclose( fp );
+}
+
+TEST_F( M6502LoadPrgTests, TestLoadProgramFromAMappedFile )
+{
+    // Given:
+    const TempFile Path( ".prg" );
+    WriteTestPrgFile( Path );
+
+    // When:
+    Word StartAddress = 0;
+    {
+        MappedFile Prg( Path.c_str() );
+        ASSERT_TRUE( Prg.IsOpen() );
+        EXPECT_EQ( Prg.Size, NumBytesInPrg );
+        StartAddress = Prg.LoadPrg( mem );
+    }
+
+    // Then:
+    EXPECT_EQ( StartAddress, 0x1000 );
+    EXPECT_EQ( mem[0x0FFF], 0x0 );
+    EXPECT_EQ( mem[0x1000], 0xA9 );
+    EXPECT_EQ( mem[0x100B], 0x10 );
+    EXPECT_EQ( mem[0x100C], 0x0 );
+}
+
+TEST_F( M6502LoadPrgTests, TestMapAFileAsRom )
+{
+    // Given:
+    const TempFile Path( ".prg" );
+    WriteTestPrgFile( Path );
+    MappedFile Rom( Path.c_str() );
+    ASSERT_TRUE( Rom.IsOpen() );
+
+    // When:
+    const u32 NumPages = Rom.MapRom( 0xE000, mem );
+    mem.Write( 0xE002, 0x42 );
+
+    // Then:
+    EXPECT_EQ( NumPages, 1u );
+    EXPECT_EQ( mem.Read( 0xE000 ), 0x00 );
+    EXPECT_EQ( mem.Read( 0xE001 ), 0x10 );
+    EXPECT_EQ( mem.Read( 0xE002 ), 0xA9 );
+    EXPECT_EQ( mem.Read( 0xE0FF ), 0x00 );
+    mem.UnmapPage( 0xE0 );
+}
+
+TEST_F( M6502LoadPrgTests, TestAMissingFileIsNotOpen )
+{
+    // Given:
+    MappedFile Missing( "there/is/no/such.prg" );
+
+    // Then:
+    EXPECT_FALSE( Missing.IsOpen() );
+    EXPECT_EQ( Missing.LoadPrg( mem ), 0 );
+    EXPECT_EQ( Missing.MapRom( 0xE000, mem ), 0u );
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "m6502.h"
+#include "m6502_lockstep.h"
+
+using namespace m6502;
+
+class M6502LockstepTests : public testing::Test {
+protected:
+
+    static constexpr u32 NUM_LANES = 8;
+
+    Byte Image[Mem::MAX_MEM] = {};
+
+    /*
+    * = $1000
+        lda #0
+        sta $40
+    loop
+        inx
+        txa
+        clc
+        adc $40
+        sta $40
+        jsr sub
+        cpx #$80
+        bne loop
+    done
+        jmp done
+    * = $1020
+    sub
+        inc $41
+        lda $20F0,x
+        rts
+    */
+    virtual void SetUp(){
+        const Byte Main[] = {
+            0xA9, 0x00, 0x85, 0x40, 0xE8, 0x8A, 0x18, 0x65, 0x40, 0x85, 0x40,
+            0x20, 0x20, 0x10, 0xE0, 0x80, 0xD0, 0xF2, 0x4C, 0x12, 0x10 };
+        const Byte Sub[] = { 0xE6, 0x41, 0xBD, 0xF0, 0x20, 0x60 };
+        memcpy( Image + 0x1000, Main, sizeof(Main) );
+        memcpy( Image + 0x1020, Sub, sizeof(Sub) );
+        for ( u32 i = 0; i < 0x200; i++ )
+        {
+            Image[0x2000 + i] = (Byte)(i * 7);
+        }
+    }
+
+    virtual void TearDown(){
+    }
+};
+
+TEST_F( M6502LockstepTests, EveryLaneEndsLikeExecuteOnItsOwn )
+{
+    // Given:
+    LockstepEngine<NUM_LANES> Engine( Image );
+    for ( u32 Lane = 0; Lane < NUM_LANES; Lane++ )
+    {
+        Engine.GetCPU( Lane ).PC = 0x1000;
+        Engine.GetCPU( Lane ).X = (Byte)(Lane * 4);
+    }
+    constexpr s32 CYCLES = 6000;
+
+    // When:
+    const u32 NumInLockstep = Engine.Run( CYCLES );
+
+    // Then:
+    EXPECT_LT( NumInLockstep, NUM_LANES );  // they leave the loop at different times
+    for ( u32 Lane = 0; Lane < NUM_LANES; Lane++ )
+    {
+        Mem ExpectedMem;
+        CPU Expected;
+        Expected.Reset( 0x1000, ExpectedMem );
+        Expected.PS = 0;
+        Expected.X = (Byte)(Lane * 4);
+        ExpectedMem.Load( Image, Mem::MAX_MEM, 0 );
+        const s32 ExpectedCycles = Expected.Execute( CYCLES, ExpectedMem );
+
+        const CPU& Actual = Engine.GetCPU( Lane );
+        const Mem& ActualMem = Engine.GetMem( Lane );
+        EXPECT_EQ( Engine.CyclesUsed( Lane ), ExpectedCycles );
+        EXPECT_EQ( Actual.PC, Expected.PC );
+        EXPECT_EQ( Actual.PC, 0x1012 );
+        EXPECT_EQ( Actual.A, Expected.A );
+        EXPECT_EQ( Actual.X, Expected.X );
+        EXPECT_EQ( Actual.SP, Expected.SP );
+        EXPECT_EQ( Actual.PS, Expected.PS );
+        EXPECT_EQ( ActualMem.Read( 0x40 ), ExpectedMem.Read( 0x40 ) );
+        EXPECT_EQ( ActualMem.Read( 0x41 ), ExpectedMem.Read( 0x41 ) );
+    }
+}
+
+TEST_F( M6502LockstepTests, LanesOnlyCopyThePagesTheyWrite )
+{
+    // Given:
+    LockstepEngine<NUM_LANES> Engine( Image );
+    for ( u32 Lane = 0; Lane < NUM_LANES; Lane++ )
+    {
+        Engine.GetCPU( Lane ).PC = 0x1000;
+    }
+
+    // When:
+    Engine.Run( 100 );
+
+    // Then:
+    for ( u32 Lane = 0; Lane < NUM_LANES; Lane++ )
+    {
+        EXPECT_EQ( Engine.NumPrivatePages( Lane ), 2u );   // zero page and the stack
+        EXPECT_EQ( Engine.CyclesUsed( Lane ), Engine.CyclesUsed( 0 ) );
+    }
+    EXPECT_EQ( Image[0x40], 0 );
+    EXPECT_EQ( Image[0x41], 0 );
+}
+
+TEST_F( M6502LockstepTests, GetMemReadsTheImageAndTheCopiedPages )
+{
+    // Given:
+    Image[0x00F0] = 0x5A;   // on the zero page the lanes copy when they write $40
+    LockstepEngine<NUM_LANES> Engine( Image );
+    for ( u32 Lane = 0; Lane < NUM_LANES; Lane++ )
+    {
+        Engine.GetCPU( Lane ).PC = 0x1000;
+    }
+
+    // When:
+    Engine.Run( 100 );
+
+    // Then:
+    for ( u32 Lane = 0; Lane < NUM_LANES; Lane++ )
+    {
+        const Mem& LaneMem = Engine.GetMem( Lane );
+        EXPECT_EQ( LaneMem.Read( 0x2005 ), Image[0x2005] );
+        EXPECT_EQ( LaneMem.Read( 0x1000 ), 0xA9 );
+        EXPECT_EQ( LaneMem.Read( 0x00F0 ), 0x5A );
+    }
+}
@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+#include "m6502.h"
+
+using namespace m6502;
+
+class M6502MemTests : public testing::Test {
+protected:
+    
+    Mem mem;
+    CPU cpu;
+
+    virtual void SetUp(){
+        cpu.Reset( mem );
+        mem.ClearDirtyPages();
+    }
+
+    virtual void TearDown(){
+    }
+};
+
+TEST_F( M6502MemTests, WritesMarkTheirPageDirty )
+{
+    // Given:
+    Byte Pages[Mem::NUM_PAGES];
+
+    // When:
+    mem[0x0042] = 1;
+    mem[0x80FF] = 2;
+    mem[0x8000] = 3;
+
+    // Then:
+    ASSERT_EQ( mem.GetDirtyPages( Pages ), 2u );
+    EXPECT_EQ( Pages[0], 0x00 );
+    EXPECT_EQ( Pages[1], 0x80 );
+}
+
+TEST_F( M6502MemTests, ExecutingMarksTheStoredAndStackPagesDirty )
+{
+    // Given:
+    // lda #$42 ; sta $9010 ; pha ; jmp *
+    Byte Pages[Mem::NUM_PAGES];
+    cpu.Reset( 0x1000 );
+    mem[0x1000] = CPU::INS_LDA_IM;
+    mem[0x1001] = 0x42;
+    mem[0x1002] = CPU::INS_STA_ABS;
+    mem[0x1003] = 0x10;
+    mem[0x1004] = 0x90;
+    mem[0x1005] = CPU::INS_PHA;
+    mem[0x1006] = CPU::INS_JMP_ABS;
+    mem[0x1007] = 0x06;
+    mem[0x1008] = 0x10;
+    mem.ClearDirtyPages();
+
+    // When:
+    cpu.Execute( 100, mem );
+
+    // Then:
+    ASSERT_EQ( mem.GetDirtyPages( Pages ), 2u );
+    EXPECT_EQ( Pages[0], 0x01 );
+    EXPECT_EQ( Pages[1], 0x90 );
+}
+
+TEST_F( M6502MemTests, ZeroDirtyPagesClearsOnlyWhatWasWritten )
+{
+    // Given:
+    Byte Pages[Mem::NUM_PAGES];
+    mem[0x1234] = 0x99;
+    mem[0xFFFF] = 0x77;
+
+    // When:
+    mem.ZeroDirtyPages();
+
+    // Then:
+    EXPECT_EQ( mem[0x1234], 0 );
+    EXPECT_EQ( mem[0xFFFF], 0 );
+    EXPECT_EQ( mem.GetDirtyPages( Pages ), 0u );
+}
+
+TEST_F( M6502MemTests, ReadsLeaveTheirPageClean )
+{
+    // Given:
+    Byte Pages[Mem::NUM_PAGES];
+    mem[0x2000] = 0x11;
+    mem.ClearDirtyPages();
+
+    // When:
+    const Byte Value = mem[0x2000];
+    mem[0x3000] = mem[0x2000];
+
+    // Then:
+    EXPECT_EQ( Value, 0x11 );
+    EXPECT_EQ( mem[0x3000], 0x11 );
+    ASSERT_EQ( mem.GetDirtyPages( Pages ), 1u );
+    EXPECT_EQ( Pages[0], 0x30 );
+}
+
+TEST_F( M6502MemTests, ReadOnlyPagesDropWrites )
+{
+    // Given:
+    // lda #$42 ; sta $C010 ; lda $C010
+    Byte Rom[Mem::PAGE_SIZE] = {};
+    Rom[0x10] = 0x99;
+    mem.MapMemory( 0xC0, Rom, true );
+    cpu.Reset( 0x1000 );
+    mem[0x1000] = CPU::INS_LDA_IM;
+    mem[0x1001] = 0x42;
+    mem[0x1002] = CPU::INS_STA_ABS;
+    mem[0x1003] = 0x10;
+    mem[0x1004] = 0xC0;
+    mem[0x1005] = CPU::INS_LDA_ABS;
+    mem[0x1006] = 0x10;
+    mem[0x1007] = 0xC0;
+
+    // When:
+    const s32 ActualCycles = cpu.Execute( 2 + 4 + 4, mem );
+
+    // Then:
+    EXPECT_EQ( ActualCycles, 2 + 4 + 4 );
+    EXPECT_EQ( cpu.A, 0x99 );
+    EXPECT_EQ( Rom[0x10], 0x99 );
+    EXPECT_FALSE( mem.IsPlainMemory() );
+}
+
+struct TestDevice {
+    Byte LastWritten = 0;
+    Word LastAddress = 0;
+    u32 NumReads = 0;
+};
+
+TEST_F( M6502MemTests, HandlerPagesCallTheDevice )
+{
+    // Given:
+    // lda #$42 ; sta $D012 ; ldx $D000
+    TestDevice Device;
+    Mem::PageHandler Handler;
+    Handler.Context = &Device;
+    Handler.Read = []( void* Context, Word Address ) -> Byte {
+        static_cast<TestDevice*>( Context )->NumReads++;
+        return (Byte)Address + 1;
+    };
+    Handler.Write = []( void* Context, Word Address, Byte Value ) {
+        static_cast<TestDevice*>( Context )->LastWritten = Value;
+        static_cast<TestDevice*>( Context )->LastAddress = Address;
+    };
+    mem.MapHandler( 0xD0, Handler );
+    cpu.Reset( 0x1000 );
+    mem[0x1000] = CPU::INS_LDA_IM;
+    mem[0x1001] = 0x42;
+    mem[0x1002] = CPU::INS_STA_ABS;
+    mem[0x1003] = 0x12;
+    mem[0x1004] = 0xD0;
+    mem[0x1005] = CPU::INS_LDX_ABS;
+    mem[0x1006] = 0x00;
+    mem[0x1007] = 0xD0;
+
+    // When:
+    cpu.Execute( 2 + 4 + 4, mem );
+
+    // Then:
+    EXPECT_EQ( Device.LastWritten, 0x42 );
+    EXPECT_EQ( Device.LastAddress, 0xD012 );
+    EXPECT_EQ( Device.NumReads, 1u );
+    EXPECT_EQ( cpu.X, 0x01 );
+}
+
+TEST_F( M6502MemTests, UnmappingEveryPageGoesBackToPlainMemory )
+{
+    // Given:
+    Byte Bank[Mem::PAGE_SIZE] = {};
+    Bank[0x34] = 0x56;
+    mem.MapMemory( 0x12, Bank );
+    EXPECT_EQ( mem.Read( 0x1234 ), 0x56 );
+
+    // When:
+    mem.UnmapPage( 0x12 );
+
+    // Then:
+    EXPECT_TRUE( mem.IsPlainMemory() );
+    EXPECT_EQ( mem.Read( 0x1234 ), 0x00 );
+}
+
+TEST_F( M6502MemTests, ACopyReadsItsOwnRam )
+{
+    // Given:
+    mem[0x2000] = 0x11;
+    Mem* Copy = new Mem( mem );
+
+    // When:
+    mem[0x2000] = 0x22;
+
+    // Then:
+    EXPECT_EQ( Copy->Read( 0x2000 ), 0x11 );
+    delete Copy;
+}
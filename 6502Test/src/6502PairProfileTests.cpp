@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "m6502.h"
+#include "m6502_pairprofile.h"
+#include "m6502_breakpoints.h"
+#include "6502TestCommon.h"
+
+using namespace m6502;
+
+class M6502PairProfileTests : public testing::Test {
+protected:
+
+    Mem mem;
+    CPU cpu;
+    PairProfile Profile;
+
+    virtual void SetUp(){
+        cpu.Reset( mem );
+    }
+
+    virtual void TearDown(){
+    }
+};
+
+TEST_F( M6502PairProfileTests, CountsEachOpcodeThatFollowsAnother )
+{
+    // Given:
+    cpu.PC = cpu.LoadPrg( CountdownPrg, sizeof(CountdownPrg), mem );
+
+    // When:
+    const s32 ActualCycles = Profile.Execute( COUNTDOWN_CYCLES, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( ActualCycles, COUNTDOWN_CYCLES );
+    EXPECT_EQ( cpu.A, 0x00 );
+    EXPECT_EQ( Profile.NumInstructions(), 8u );
+    EXPECT_EQ( Profile.Count( CPU::INS_LDX_IM, CPU::INS_DEX ), 1u );
+    EXPECT_EQ( Profile.Count( CPU::INS_DEX, CPU::INS_BNE ), 3u );
+    EXPECT_EQ( Profile.Count( CPU::INS_BNE, CPU::INS_DEX ), 2u );
+    EXPECT_EQ( Profile.Count( CPU::INS_BNE, CPU::INS_LDA_IM ), 1u );
+}
+
+TEST_F( M6502PairProfileTests, TopHasTheMostFrequentFollowerOfEachOpcode )
+{
+    // Given:
+    cpu.PC = cpu.LoadPrg( CountdownPrg, sizeof(CountdownPrg), mem );
+    Profile.Execute( COUNTDOWN_CYCLES, cpu, mem );
+
+    // When:
+    const std::vector<PairProfile::Pair> Top = Profile.Top( 2 );
+
+    // Then:
+    ASSERT_EQ( Top.size(), 2u );
+    EXPECT_EQ( Top[0].First, CPU::INS_DEX );
+    EXPECT_EQ( Top[0].Second, CPU::INS_BNE );
+    EXPECT_EQ( Top[0].Count, 3u );
+    EXPECT_EQ( Top[1].First, CPU::INS_BNE );
+    EXPECT_EQ( Top[1].Second, CPU::INS_DEX );
+}
+
+TEST_F( M6502PairProfileTests, AFusedPairStillStopsOnTheCycleBudgetBetweenThem )
+{
+    // Given:
+    // cmp $40 ; bne * + 2, fused by the default pairs
+    cpu.Reset( 0xFF00, mem );
+    cpu.A = 0x01;
+    mem[0xFF00] = CPU::INS_CMP_ZP;
+    mem[0xFF01] = 0x40;
+    mem[0xFF02] = CPU::INS_BNE;
+    mem[0xFF03] = 0x00;
+    constexpr s32 EXPECTED_CYCLES = 3;
+
+    // When:
+    const s32 ActualCycles = cpu.Execute( EXPECTED_CYCLES, mem );
+
+    // Then:
+    EXPECT_EQ( ActualCycles, EXPECTED_CYCLES );
+    EXPECT_EQ( cpu.PC, 0xFF02 );
+    EXPECT_FALSE( cpu.Flag.Z );
+    EXPECT_TRUE( cpu.Flag.C );
+}
+
+TEST_F( M6502PairProfileTests, ABreakpointStopsThePairBeforeItIsCounted )
+{
+    // Given:
+    cpu.PC = cpu.LoadPrg( CountdownPrg, sizeof(CountdownPrg), mem );
+    Breakpoints Breaks;
+    Breaks.Set( 0x1005 );
+    cpu.Breaks = &Breaks;
+    constexpr s32 EXPECTED_CYCLES = COUNTDOWN_CYCLES - 2;     // Not the lda
+
+    // When:
+    const s32 ToBreakpoint = Profile.Execute( 100, cpu, mem );
+    const u32 CountedAtBreakpoint = (u32)Profile.NumInstructions();
+    Profile.Execute( 2, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( ToBreakpoint, EXPECTED_CYCLES );
+    EXPECT_EQ( CountedAtBreakpoint, 7u );
+    EXPECT_EQ( Profile.NumInstructions(), 8u );
+    EXPECT_EQ( Profile.Count( CPU::INS_BNE, CPU::INS_LDA_IM ), 1u );
+    EXPECT_EQ( cpu.A, 0x00 );
+}
+
+TEST_F( M6502PairProfileTests, AnInterruptedOpcodeIsNotCounted )
+{
+    // Given:
+    // ldx #$03 at $1000 is interrupted by an NMI to nop ; nop at $2000
+    cpu.PC = cpu.LoadPrg( CountdownPrg, sizeof(CountdownPrg), mem );
+    mem[0xFFFA] = 0x00;
+    mem[0xFFFB] = 0x20;
+    mem[0x2000] = CPU::INS_NOP;
+    mem[0x2001] = CPU::INS_NOP;
+    cpu.TriggerNmi();
+    constexpr s32 EXPECTED_CYCLES = 7 + 2 + 2;
+
+    // When:
+    const s32 ActualCycles = Profile.Execute( EXPECTED_CYCLES, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( ActualCycles, EXPECTED_CYCLES );
+    EXPECT_EQ( cpu.PC, 0x2002 );
+    EXPECT_EQ( Profile.NumInstructions(), 2u );
+    EXPECT_EQ( Profile.Count( CPU::INS_NOP, CPU::INS_NOP ), 1u );
+    EXPECT_EQ( Profile.Count( CPU::INS_LDX_IM, CPU::INS_NOP ), 0u );
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "m6502.h"
+#include "m6502_pcprofile.h"
+#include "m6502_breakpoints.h"
+#include "6502TestCommon.h"
+
+using namespace m6502;
+
+class M6502PcProfileTests : public testing::Test {
+protected:
+
+    Mem mem;
+    CPU cpu;
+    PcProfile Profile;
+
+    virtual void SetUp(){
+        cpu.Reset( mem );
+    }
+
+    virtual void TearDown(){
+    }
+};
+
+/* CountdownPrg as AS65 lists it */
+static void WriteCountdownListing( const TempFile& File )
+{
+    FILE* fp = fopen( File.c_str(), "w" );
+    ASSERT_NE( fp, nullptr );
+    fprintf( fp, "                        * = $1000\n" );
+    fprintf( fp, "1000 : a203             start   ldx #$03\n" );
+    fprintf( fp, "1002 : ca               loop    dex\n" );
+    fprintf( fp, "1003 : d0fd                     bne loop\n" );
+    fprintf( fp, "1005 : a900                     lda #$00    ;done\n" );
+    fclose( fp );
+}
+
+TEST_F( M6502PcProfileTests, CountsTheInstructionsAndCyclesAtEachAddress )
+{
+    // Given:
+    cpu.PC = cpu.LoadPrg( CountdownPrg, sizeof(CountdownPrg), mem );
+
+    // When:
+    const s32 ActualCycles = Profile.Execute( COUNTDOWN_CYCLES, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( ActualCycles, COUNTDOWN_CYCLES );
+    EXPECT_EQ( Profile.TotalCycles(), (unsigned long long)COUNTDOWN_CYCLES );
+    EXPECT_EQ( Profile.InstructionsAt( 0x1000 ), 1u );
+    EXPECT_EQ( Profile.InstructionsAt( 0x1002 ), 3u );
+    EXPECT_EQ( Profile.CyclesAt( 0x1002 ), 2u * 3 );
+    EXPECT_EQ( Profile.InstructionsAt( 0x1003 ), 3u );
+    EXPECT_EQ( Profile.CyclesAt( 0x1003 ), 3u + 3 + 2 );
+    EXPECT_EQ( Profile.InstructionsAt( 0x1001 ), 0u );
+}
+
+TEST_F( M6502PcProfileTests, HotSymbolsSumTheCodeUnderEachLabel )
+{
+    // Given:
+    const TempFile Listing( ".lst" );
+    WriteCountdownListing( Listing );
+    ASSERT_TRUE( Profile.LoadSymbols( Listing.c_str() ) );
+    cpu.PC = cpu.LoadPrg( CountdownPrg, sizeof(CountdownPrg), mem );
+    Profile.Execute( COUNTDOWN_CYCLES, cpu, mem );
+
+    // When:
+    const std::vector<PcProfile::HotSpot> Symbols = Profile.HotSymbols( 10 );
+    const std::vector<PcProfile::HotSpot> Spots = Profile.HotSpots( 1 );
+
+    // Then:
+    ASSERT_EQ( Symbols.size(), 2u );
+    EXPECT_EQ( Symbols[0].Symbol, "loop" );
+    EXPECT_EQ( Symbols[0].Address, 0x1002 );
+    EXPECT_EQ( Symbols[0].Cycles, 6u + 8 + 2 );
+    EXPECT_EQ( Symbols[0].Instructions, 7u );
+    EXPECT_EQ( Symbols[1].Symbol, "start" );
+    EXPECT_EQ( Symbols[1].Cycles, 2u );
+    ASSERT_EQ( Spots.size(), 1u );
+    EXPECT_EQ( Spots[0].Address, 0x1003 );
+    EXPECT_EQ( Spots[0].Symbol, "loop+1" );
+}
+
+TEST_F( M6502PcProfileTests, InterruptsAreCountedOnTheirOwn )
+{
+    // Given:
+    cpu.Reset( 0xFF00, mem );
+    cpu.Flag.I = false;
+    mem[0xFF00] = CPU::INS_NOP;
+    mem[0xFFFE] = 0x00;
+    mem[0xFFFF] = 0x80;
+    mem[0x8000] = CPU::INS_NOP;
+    cpu.SetIrq( true );
+    constexpr s32 EXPECTED_CYCLES = 7 + 2;
+
+    // When:
+    const s32 ActualCycles = Profile.Execute( EXPECTED_CYCLES, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( ActualCycles, EXPECTED_CYCLES );
+    EXPECT_EQ( Profile.InterruptCycles(), 7u );
+    EXPECT_EQ( Profile.InstructionsAt( 0x8000 ), 1u );
+    EXPECT_EQ( Profile.InstructionsAt( 0xFF00 ), 0u );
+    EXPECT_EQ( Profile.TotalCycles(), (unsigned long long)EXPECTED_CYCLES );
+}
+
+TEST_F( M6502PcProfileTests, ABreakpointStopsTheProfileWithoutCountingTheInstruction )
+{
+    // Given:
+    cpu.PC = cpu.LoadPrg( CountdownPrg, sizeof(CountdownPrg), mem );
+    Breakpoints Breaks;
+    Breaks.Set( 0x1003 );
+    cpu.Breaks = &Breaks;
+
+    // When:
+    const s32 ToBreakpoint = Profile.Execute( COUNTDOWN_CYCLES, cpu, mem );
+    const u32 CountedAtBreakpoint = (u32)Profile.InstructionsAt( 0x1003 );
+    const s32 AroundTheLoop = Profile.Execute( COUNTDOWN_CYCLES, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( ToBreakpoint, 2 + 2 );
+    EXPECT_EQ( CountedAtBreakpoint, 0u );
+    EXPECT_EQ( AroundTheLoop, 3 + 2 );
+    EXPECT_EQ( cpu.Halted, CPU::HaltReason::Breakpoint );
+    EXPECT_EQ( cpu.PC, 0x1003 );
+    EXPECT_EQ( Profile.InstructionsAt( 0x1002 ), 2u );
+    EXPECT_EQ( Profile.InstructionsAt( 0x1003 ), 1u );
+    EXPECT_EQ( Profile.TotalCycles(), (unsigned long long)(2 + 2 + 3 + 2) );
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "m6502.h"
+#include "m6502_savestate.h"
+
+using namespace m6502;
+
+class M6502SaveStateTests : public testing::Test {
+protected:
+
+    Mem mem;
+    CPU cpu;
+    FILE* File = nullptr;
+
+    virtual void SetUp(){
+        cpu.Reset( 0x1234, mem );
+        cpu.A = 0x11;
+        cpu.X = 0x22;
+        cpu.Y = 0x33;
+        cpu.SP = 0xF0;
+        cpu.PS = CPU::CarryFlagBit | CPU::NegativeFlagBit;
+        mem[0x0042] = 0x99;
+        memset( mem.Data + 0x8000, 0xEA, 0x1000 );     // 16 equal pages
+        mem[0xFFFC] = 0x34;
+        File = tmpfile();
+        ASSERT_NE( File, nullptr );
+    }
+
+    virtual void TearDown(){
+        if ( File )
+        {
+            fclose( File );
+        }
+    }
+
+    std::vector<Byte> ReadFile() {
+        std::vector<Byte> Bytes( (size_t)ftell( File ) );
+        rewind( File );
+        EXPECT_EQ( fread( Bytes.data(), 1, Bytes.size(), File ), Bytes.size() );
+        return Bytes;
+    }
+};
+
+TEST_F( M6502SaveStateTests, AStateReadsBackAsItWasWritten )
+{
+    // Given:
+    Mem Loaded;
+    CPU LoadedCPU;
+    LoadedCPU.Reset( Loaded );
+    Loaded[0x5000] = 0x77;
+    unsigned long long Cycles = 0;
+
+    // When:
+    ASSERT_TRUE( SaveState::Write( File, cpu, mem, 0x123456789ull ) );
+    const long Size = ftell( File );
+    rewind( File );
+    const bool Read = SaveState::Read( File, LoadedCPU, Loaded, &Cycles );
+
+    // Then:
+    EXPECT_TRUE( Read );
+    EXPECT_EQ( Size, (long)SaveState::HEADER_SIZE + 3 * (long)Mem::PAGE_SIZE );
+    EXPECT_EQ( Cycles, 0x123456789ull );
+    EXPECT_EQ( LoadedCPU.PC, 0x1234 );
+    EXPECT_EQ( LoadedCPU.A, 0x11 );
+    EXPECT_EQ( LoadedCPU.X, 0x22 );
+    EXPECT_EQ( LoadedCPU.Y, 0x33 );
+    EXPECT_EQ( LoadedCPU.SP, 0xF0 );
+    EXPECT_EQ( LoadedCPU.PS, CPU::CarryFlagBit | CPU::NegativeFlagBit );
+    EXPECT_EQ( memcmp( Loaded.Data, mem.Data, Mem::MAX_MEM ), 0 );
+}
+
+TEST_F( M6502SaveStateTests, TheInterruptLinesAreSavedWithTheState )
+{
+    // Given:
+    cpu.SetIrq( true );
+    cpu.TriggerNmi();
+    ASSERT_TRUE( SaveState::Write( File, cpu, mem ) );
+    std::vector<Byte> Bytes = ReadFile();
+    Mem Loaded;
+    CPU LoadedCPU;
+    LoadedCPU.Reset( Loaded );
+
+    // When:
+    const bool Read = SaveState::Read( Bytes.data(), Bytes.size(), LoadedCPU, Loaded );
+    const u32 LoadedEvents = LoadedCPU.PendingEvents;
+    Bytes[31] = 0;      // As saved with nothing pending (and by version 1)
+    const bool ReadQuiet = SaveState::Read( Bytes.data(), Bytes.size(), LoadedCPU, Loaded );
+
+    // Then:
+    EXPECT_TRUE( Read );
+    EXPECT_TRUE( ReadQuiet );
+    EXPECT_EQ( LoadedEvents, CPU::PendingIrq | CPU::PendingNmi );
+    EXPECT_EQ( LoadedCPU.PendingEvents, 0u );
+}
+
+TEST_F( M6502SaveStateTests, AStateInMemoryLoadsLikeTheFile )
+{
+    // Given:
+    ASSERT_TRUE( SaveState::Write( File, cpu, mem ) );
+    const std::vector<Byte> Bytes = ReadFile();
+    Mem Loaded;
+    CPU LoadedCPU;
+    LoadedCPU.Reset( Loaded );
+
+    // When:
+    const bool Read = SaveState::Read( Bytes.data(), Bytes.size(), LoadedCPU, Loaded );
+
+    // Then:
+    EXPECT_TRUE( Read );
+    EXPECT_EQ( LoadedCPU.PC, 0x1234 );
+    EXPECT_EQ( LoadedCPU.SP, 0xF0 );
+    EXPECT_EQ( memcmp( Loaded.Data, mem.Data, Mem::MAX_MEM ), 0 );
+}
+
+TEST_F( M6502SaveStateTests, ShortOrForeignBytesAreNotLoaded )
+{
+    // Given:
+    ASSERT_TRUE( SaveState::Write( File, cpu, mem ) );
+    std::vector<Byte> Bytes = ReadFile();
+    CPU LoadedCPU;
+    Mem Loaded;
+    LoadedCPU.Reset( Loaded );
+
+    // When:
+    const bool ReadShort = SaveState::Read( Bytes.data(), Bytes.size() - 1, LoadedCPU, Loaded );
+    Bytes[0] = 'X';
+    const bool ReadForeign = SaveState::Read( Bytes.data(), Bytes.size(), LoadedCPU, Loaded );
+
+    // Then:
+    EXPECT_FALSE( ReadShort );
+    EXPECT_FALSE( ReadForeign );
+    EXPECT_EQ( LoadedCPU.PC, 0xFFFC );
+}
+
+TEST_F( M6502SaveStateTests, AFileMayStoreThePagesInAnyOrder )
+{
+    // Given:
+    // Swap the first two stored pages and the page table entries using them
+    ASSERT_TRUE( SaveState::Write( File, cpu, mem ) );
+    std::vector<Byte> Bytes = ReadFile();
+    for ( u32 Page = 0; Page < Mem::NUM_PAGES; Page++ )
+    {
+        Byte* Index = &Bytes[32 + Page * 2];
+        if ( Index[1] == 0 && Index[0] < 2 )
+        {
+            Index[0] ^= 1;
+        }
+    }
+    std::swap_ranges( Bytes.begin() + SaveState::HEADER_SIZE,
+                      Bytes.begin() + SaveState::HEADER_SIZE + Mem::PAGE_SIZE,
+                      Bytes.begin() + SaveState::HEADER_SIZE + Mem::PAGE_SIZE );
+    rewind( File );
+    ASSERT_EQ( fwrite( Bytes.data(), 1, Bytes.size(), File ), Bytes.size() );
+    rewind( File );
+    Mem Loaded;
+    CPU LoadedCPU;
+    LoadedCPU.Reset( Loaded );
+
+    // When:
+    const bool Read = SaveState::Read( File, LoadedCPU, Loaded );
+
+    // Then:
+    EXPECT_TRUE( Read );
+    EXPECT_EQ( LoadedCPU.PC, 0x1234 );
+    EXPECT_EQ( memcmp( Loaded.Data, mem.Data, Mem::MAX_MEM ), 0 );
+}
+
+TEST_F( M6502SaveStateTests, AShortFileLeavesTheMachineAlone )
+{
+    // Given:
+    ASSERT_TRUE( SaveState::Write( File, cpu, mem ) );
+    std::vector<Byte> Bytes = ReadFile();
+    FILE* Short = tmpfile();
+    ASSERT_NE( Short, nullptr );
+    ASSERT_EQ( fwrite( Bytes.data(), 1, Bytes.size() - 1, Short ), Bytes.size() - 1 );
+    rewind( Short );
+    Mem Loaded;
+    CPU LoadedCPU;
+    LoadedCPU.Reset( Loaded );
+    Loaded[0x0042] = 0x55;
+
+    // When:
+    const bool Read = SaveState::Read( Short, LoadedCPU, Loaded );
+    fclose( Short );
+
+    // Then:
+    EXPECT_FALSE( Read );
+    EXPECT_EQ( LoadedCPU.PC, 0xFFFC );
+    EXPECT_EQ( LoadedCPU.SP, 0xFF );
+    EXPECT_EQ( Loaded[0x0042], 0x55 );
+}
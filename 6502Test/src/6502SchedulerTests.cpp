@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "m6502.h"
+#include "m6502_scheduler.h"
+#include "m6502_breakpoints.h"
+
+using namespace m6502;
+
+class M6502SchedulerTests : public testing::Test {
+protected:
+
+    Mem mem;
+    CPU cpu;
+    Scheduler scheduler;
+
+    struct Call {
+        unsigned long long Cycle;
+        unsigned long long Now;
+        int Tag;
+    };
+    std::vector<Call> Calls;
+
+    struct Tagged {
+        M6502SchedulerTests* Test;
+        int Tag;
+    };
+
+    static void Record( void* Context, unsigned long long Cycle ) {
+        Tagged& Event = *static_cast<Tagged*>( Context );
+        Event.Test->Calls.push_back( { Cycle, Event.Test->scheduler.Now(), Event.Tag } );
+    }
+
+    /* nop ... nop ; jmp $1000 */
+    virtual void SetUp(){
+        cpu.Reset( 0x1000, mem );
+        for ( Word Address = 0x1000; Address < 0x1080; Address++ )
+        {
+            mem[Address] = CPU::INS_NOP;
+        }
+        mem[0x1080] = CPU::INS_JMP_ABS;
+        mem[0x1081] = 0x00;
+        mem[0x1082] = 0x10;
+    }
+
+    virtual void TearDown(){
+    }
+};
+
+TEST_F( M6502SchedulerTests, EventsAreCalledInOrderAtTheirCycle )
+{
+    // Given:
+    Tagged Late{ this, 3 }, First{ this, 1 }, Second{ this, 2 };
+    scheduler.Schedule( 101, Record, &Late );
+    scheduler.Schedule( 51, Record, &First );
+    scheduler.Schedule( 51, Record, &Second );
+
+    // When:
+    const unsigned long long CyclesUsed = scheduler.Run( 1000, cpu, mem );
+
+    // Then:
+    EXPECT_GE( CyclesUsed, 1000u );
+    ASSERT_EQ( Calls.size(), 3u );
+    EXPECT_EQ( Calls[0].Tag, 1 );
+    EXPECT_EQ( Calls[1].Tag, 2 );
+    EXPECT_EQ( Calls[2].Tag, 3 );
+    for ( const Call& Called : Calls )
+    {
+        EXPECT_GE( Called.Now, Called.Cycle );
+        EXPECT_LT( Called.Now, Called.Cycle + 2 );     // The next NOP boundary
+    }
+}
+
+TEST_F( M6502SchedulerTests, ACancelledEventIsNotCalled )
+{
+    // Given:
+    Tagged Cancelled{ this, 1 }, Kept{ this, 2 };
+    const Scheduler::EventId Id = scheduler.ScheduleIn( 10, Record, &Cancelled );
+    scheduler.ScheduleIn( 20, Record, &Kept );
+
+    // When:
+    const bool WasCancelled = scheduler.Cancel( Id );
+    scheduler.Run( 100, cpu, mem );
+
+    // Then:
+    EXPECT_TRUE( WasCancelled );
+    EXPECT_FALSE( scheduler.Cancel( Id ) );
+    ASSERT_EQ( Calls.size(), 1u );
+    EXPECT_EQ( Calls[0].Tag, 2 );
+}
+
+/* Pulses NMI every Period cycles */
+struct NmiTimer {
+    Scheduler* Owner;
+    CPU* Cpu;
+    unsigned long long Period;
+
+    static void Tick( void* Context, unsigned long long Cycle ) {
+        NmiTimer& Self = *static_cast<NmiTimer*>( Context );
+        Self.Cpu->TriggerNmi();
+        Self.Owner->Schedule( Cycle + Self.Period, Tick, Context );
+    }
+};
+
+TEST_F( M6502SchedulerTests, APeriodicTimerCanDriveInterrupts )
+{
+    // Given:
+    // The NMI handler at $8000 is inc $40 ; rti
+    mem[0xFFFA] = 0x00;
+    mem[0xFFFB] = 0x80;
+    mem[0x8000] = CPU::INS_INC_ZP;
+    mem[0x8001] = 0x40;
+    mem[0x8002] = CPU::INS_RTI;
+    NmiTimer Timer{ &scheduler, &cpu, 200 };
+    scheduler.Schedule( 200, NmiTimer::Tick, &Timer );
+
+    // When:
+    scheduler.Run( 1100, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( mem.Read( 0x40 ), 5 );
+    EXPECT_EQ( scheduler.NextEventCycle(), 1200u );
+}
+
+TEST_F( M6502SchedulerTests, RunStopsWhenTheCPUHalts )
+{
+    // Given:
+    mem[0x1081] = 0x80;     // jmp * at the end of the NOPs
+    cpu.HaltOnTrap = true;
+    Tagged Later{ this, 1 };
+    scheduler.Schedule( 1000, Record, &Later );
+    constexpr unsigned long long EXPECTED_CYCLES = 0x80 * 2 + 3;
+
+    // When:
+    const unsigned long long CyclesUsed = scheduler.Run( 5000, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( CyclesUsed, EXPECTED_CYCLES );
+    EXPECT_EQ( scheduler.Now(), EXPECTED_CYCLES );
+    EXPECT_EQ( cpu.Halted, CPU::HaltReason::Trap );
+    EXPECT_EQ( cpu.PC, 0x1080 );
+    EXPECT_TRUE( Calls.empty() );
+}
+
+TEST_F( M6502SchedulerTests, RunStopsAtABreakpointAndRunsOnFromIt )
+{
+    // Given:
+    Breakpoints Breaks;
+    Breaks.Set( 0x1040 );
+    cpu.Breaks = &Breaks;
+
+    // When:
+    const unsigned long long ToBreakpoint = scheduler.Run( 1000, cpu, mem );
+    const unsigned long long AroundTheLoop = scheduler.Run( 1000, cpu, mem );
+
+    // Then:
+    EXPECT_EQ( ToBreakpoint, 0x40u * 2 );
+    EXPECT_EQ( AroundTheLoop, 0x80u * 2 + 3 );
+    EXPECT_EQ( cpu.Halted, CPU::HaltReason::Breakpoint );
+    EXPECT_EQ( cpu.PC, 0x1040 );
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "m6502.h"
+#include "m6502_breakpoints.h"
+#include "m6502_snapshot.h"
+
+using namespace m6502;
+
+class M6502SnapshotTests : public testing::Test {
+protected:
+
+    Mem mem;
+    CPU cpu;
+
+    /* lda #Value ; sta Address ; pha ; jmp * */
+    void WriteProgram( Byte Value, Word Address ) {
+        mem[0x1000] = CPU::INS_LDA_IM;
+        mem[0x1001] = Value;
+        mem[0x1002] = CPU::INS_STA_ABS;
+        mem[0x1003] = Address & 0xFF;
+        mem[0x1004] = Address >> 8;
+        mem[0x1005] = CPU::INS_PHA;
+        mem[0x1006] = CPU::INS_JMP_ABS;
+        mem[0x1007] = 0x06;
+        mem[0x1008] = 0x10;
+    }
+
+    virtual void SetUp(){
+        cpu.Reset( 0x1000, mem );
+        WriteProgram( 0x42, 0x9000 );
+    }
+
+    virtual void TearDown(){
+    }
+};
+
+TEST_F( M6502SnapshotTests, AForkSharesThePagesItDidNotWrite )
+{
+    // Given:
+    const Snapshot Root( cpu, mem );
+    cpu.Execute( 2 + 4 + 3, mem );
+
+    // When:
+    const Snapshot Child = Root.Fork( cpu, mem );
+
+    // Then:
+    EXPECT_EQ( Child.NumSharedPages( Root ), Mem::NUM_PAGES - 2 );     // The stack and $90xx
+    EXPECT_EQ( Child[0x9000], 0x42 );
+    EXPECT_EQ( Root[0x9000], 0x00 );
+    EXPECT_EQ( Child[0x01FF], 0x42 );
+    EXPECT_EQ( Child.cpu.PC, 0x1006 );
+    EXPECT_EQ( Child.cpu.SP, 0xFE );
+}
+
+TEST_F( M6502SnapshotTests, RestoringPutsTheMachineBack )
+{
+    // Given:
+    const Snapshot Root( cpu, mem );
+    const Mem Expected = mem;
+    cpu.Execute( 2 + 4 + 3, mem );
+
+    // When:
+    Root.Restore( cpu, mem );
+
+    // Then:
+    EXPECT_EQ( cpu.PC, 0x1000 );
+    EXPECT_EQ( cpu.A, 0x00 );
+    EXPECT_EQ( cpu.SP, 0xFF );
+    EXPECT_EQ( memcmp( mem.Data, Expected.Data, Mem::MAX_MEM ), 0 );
+}
+
+TEST_F( M6502SnapshotTests, RestoringPutsTheInterruptLinesBack )
+{
+    // Given:
+    cpu.SetIrq( true );
+    const Snapshot Held( cpu, mem );
+    cpu.SetIrq( false );
+    cpu.TriggerNmi();
+
+    // When:
+    Held.Restore( cpu, mem );
+
+    // Then:
+    EXPECT_EQ( cpu.PendingEvents, CPU::PendingIrq );
+}
+
+TEST_F( M6502SnapshotTests, RestoringFromASiblingCopiesOnlyWhatDiffers )
+{
+    // Given:
+    const Snapshot Root( cpu, mem );
+    cpu.Execute( 2 + 4 + 3, mem );
+    const Snapshot First = Root.Fork( cpu, mem );
+    const Mem FirstMem = mem;
+    Root.Restore( cpu, mem, First );
+    WriteProgram( 0x17, 0x9100 );
+    cpu.Execute( 2 + 4 + 3, mem );
+    const Snapshot Second = Root.Fork( cpu, mem );
+    mem[0x2000] = 0x99;    // Dirty, not in any snapshot
+
+    // When:
+    First.Restore( cpu, mem, Second );
+
+    // Then:
+    EXPECT_EQ( memcmp( mem.Data, FirstMem.Data, Mem::MAX_MEM ), 0 );
+    EXPECT_EQ( cpu.A, 0x42 );
+    Byte Pages[Mem::NUM_PAGES];
+    EXPECT_EQ( mem.GetDirtyPages( Pages ), 0u );
+}
+
+TEST_F( M6502SnapshotTests, RestoringLeavesWhatIsAttachedToTheCPUAlone )
+{
+    // Given:
+    const Snapshot Root( cpu, mem );
+    Breakpoints Breaks;
+    cpu.Breaks = &Breaks;
+    cpu.HaltOnTrap = true;
+    cpu.Execute( 2 + 4 + 3, mem );
+
+    // When:
+    Root.Restore( cpu, mem );
+
+    // Then:
+    EXPECT_EQ( cpu.PC, 0x1000 );
+    EXPECT_EQ( cpu.Breaks, &Breaks );
+    EXPECT_TRUE( cpu.HaltOnTrap );
+}
@@ -166,4 +166,122 @@ TEST_F( M6502SystemFunctionsTests, RTICanReturnFromAnInterruptLeavingTheCPUInThe
 	EXPECT_EQ( CPUCopy.SP, cpu.SP );
 	EXPECT_EQ( 0xFF02, cpu.PC );
 	EXPECT_EQ( CPUCopy.PS, cpu.PS );
-} 
\ No newline at end of file
+} 
+
+TEST_F( M6502SystemFunctionsTests, AnUnhandledOpcodeThrowsIllegalOpcodeWithTheAddress )
+{
+	// given:
+	using namespace m6502;
+	cpu.Reset( 0xFF00, mem );
+	mem[0xFF00] = CPU::INS_NOP;
+	mem[0xFF01] = 0x02;	// not a legal opcode
+
+	// when:
+	try
+	{
+		cpu.Execute( 4, mem );
+		FAIL();
+	}
+	// then:
+	catch ( const IllegalOpcode& Illegal )
+	{
+		EXPECT_EQ( Illegal.Opcode, 0x02 );
+		EXPECT_EQ( Illegal.Address, 0xFF01 );
+		EXPECT_EQ( cpu.PC, 0xFF01 );
+	}
+}
+
+TEST_F( M6502SystemFunctionsTests, ResetWithoutMemoryOnlyResetsTheRegisters )
+{
+	// given:
+	using namespace m6502;
+	cpu.A = cpu.X = cpu.Y = 0x42;
+	cpu.SP = 0x80;
+	cpu.Flag.C = cpu.Flag.N = true;
+	mem[0x1234] = 0x99;
+
+	// when:
+	cpu.Reset( 0xFF00 );
+
+	// then:
+	EXPECT_EQ( cpu.PC, 0xFF00 );
+	EXPECT_EQ( cpu.SP, 0xFF );
+	EXPECT_EQ( cpu.A, 0 );
+	EXPECT_EQ( cpu.X, 0 );
+	EXPECT_EQ( cpu.Y, 0 );
+	EXPECT_FALSE( cpu.Flag.C );
+	EXPECT_FALSE( cpu.Flag.N );
+	EXPECT_EQ( mem[0x1234], 0x99 );
+}
+
+TEST_F( M6502SystemFunctionsTests, AnIRQIsTakenAtTheNextInstructionWhenInterruptsAreEnabled )
+{
+	// given:
+	using namespace m6502;
+	cpu.Reset( 0xFF00, mem );
+	mem[0xFF00] = CPU::INS_NOP;
+	mem[0xFFFE] = 0x00;
+	mem[0xFFFF] = 0x80;
+	cpu.Flag.C = true;
+	cpu.SetIrq( true );
+	constexpr s32 EXPECTED_CYCLES = 7;
+	CPU CPUCopy = cpu;
+
+	// when:
+	const s32 ActualCycles = cpu.Execute( EXPECTED_CYCLES, mem );
+
+	// then:
+	EXPECT_EQ( ActualCycles, EXPECTED_CYCLES );
+	EXPECT_EQ( cpu.PC, 0x8000 );
+	EXPECT_EQ( cpu.SP, CPUCopy.SP - 3 );
+	EXPECT_EQ( mem[0x01FF], 0xFF );
+	EXPECT_EQ( mem[0x01FE], 0x00 );
+	EXPECT_EQ( mem[0x01FD], CPU::CarryFlagBit | CPU::UnusedFlagBit );	// B is clear
+	EXPECT_TRUE( cpu.Flag.I );
+	EXPECT_FALSE( cpu.Flag.B );
+}
+
+TEST_F( M6502SystemFunctionsTests, AnIRQIsNotTakenWhileTheInterruptFlagIsSet )
+{
+	// given:
+	using namespace m6502;
+	cpu.Reset( 0xFF00, mem );
+	mem[0xFF00] = CPU::INS_NOP;
+	mem[0xFFFE] = 0x00;
+	mem[0xFFFF] = 0x80;
+	cpu.Flag.I = true;
+	cpu.SetIrq( true );
+	constexpr s32 EXPECTED_CYCLES = 2;
+
+	// when:
+	const s32 ActualCycles = cpu.Execute( EXPECTED_CYCLES, mem );
+
+	// then:
+	EXPECT_EQ( ActualCycles, EXPECTED_CYCLES );
+	EXPECT_EQ( cpu.PC, 0xFF01 );
+	EXPECT_EQ( cpu.SP, 0xFF );
+}
+
+TEST_F( M6502SystemFunctionsTests, AnNMIIsTakenOnceWhateverTheInterruptFlag )
+{
+	// given:
+	using namespace m6502;
+	cpu.Reset( 0xFF00, mem );
+	mem[0xFF00] = CPU::INS_NOP;
+	mem[0xFFFA] = 0x00;
+	mem[0xFFFB] = 0x80;
+	mem[0x8000] = CPU::INS_RTI;
+	cpu.Flag.I = true;
+	cpu.TriggerNmi();
+	constexpr s32 EXPECTED_CYCLES = 7 + 6 + 2;
+
+	// when:
+	const s32 ActualCycles = cpu.Execute( EXPECTED_CYCLES, mem );
+
+	// then:
+	EXPECT_EQ( ActualCycles, EXPECTED_CYCLES );
+	EXPECT_EQ( cpu.PC, 0xFF01 );
+	EXPECT_EQ( cpu.SP, 0xFF );
+	EXPECT_TRUE( cpu.Flag.I );
+	EXPECT_EQ( cpu.PendingEvents, 0u );
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdio>
+#include <string>
+#include <gtest/gtest.h>
+#include "m6502.h"
+
+/* Programs and helpers shared by the test suites */
+
+/*
+* = $1000
+    ldx #$05
+    lda #$00
+loop
+    clc
+    adc #$03
+    sta $40,x
+    dex
+    bne loop
+done
+    jmp done
+*/
+static const m6502::Byte LoopPrg[] = {
+        0x00, 0x10, 0xA2, 0x05, 0xA9, 0x00, 0x18, 0x69, 0x03,
+        0x95, 0x40, 0xCA, 0xD0, 0xF8, 0x4C, 0x0C, 0x10 };
+
+/*
+* = $1000
+    ldx #$03
+loop
+    dex
+    bne loop
+    lda #$00
+*/
+static const m6502::Byte CountdownPrg[] = {
+        0x00, 0x10, 0xA2, 0x03, 0xCA, 0xD0, 0xFD, 0xA9, 0x00 };
+
+/* Through the lda: ldx, dex + bne taken twice, dex + bne not taken, lda */
+static constexpr m6502::s32 COUNTDOWN_CYCLES = 2 + (2 + 3) * 2 + 2 + 2 + 2;
+
+/* A file in the test temporary directory named after the running test, so
+*  parallel runs don't share it. It is removed however the test leaves */
+struct TempFile {
+
+    explicit TempFile( const char* Extension ) {
+        const testing::TestInfo* Test = testing::UnitTest::GetInstance()->current_test_info();
+        Path = testing::TempDir() + Test->test_suite_name() + "." + Test->name() + Extension;
+    }
+
+    ~TempFile() {
+        remove( Path.c_str() );
+    }
+
+    TempFile( const TempFile& ) = delete;
+    TempFile& operator=( const TempFile& ) = delete;
+
+    const char* c_str() const {
+        return Path.c_str();
+    }
+
+    std::string Path;
+};
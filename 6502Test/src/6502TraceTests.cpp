@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include "m6502.h"
+
+#if defined( M6502_TRACE )
+#include "m6502_trace.h"
+#include "6502TestCommon.h"
+
+using namespace m6502;
+
+class M6502TraceTests : public testing::Test {
+protected:
+
+    Mem mem;
+    CPU cpu;
+    TraceRing Trace{ 8 };
+
+    virtual void SetUp(){
+        cpu.Reset( mem );
+        cpu.Trace = &Trace;
+        Trace.SetDumpFile( nullptr );
+    }
+
+    virtual void TearDown(){
+    }
+};
+
+TEST_F( M6502TraceTests, TheRingHoldsTheLastInstructionsRun )
+{
+    // Given:
+    cpu.PC = cpu.LoadPrg( CountdownPrg, sizeof(CountdownPrg), mem );
+
+    // When:
+    const s32 CyclesUsed = cpu.Interpret( COUNTDOWN_CYCLES, mem );
+
+    // Then:
+    EXPECT_EQ( CyclesUsed, COUNTDOWN_CYCLES );
+    EXPECT_EQ( Trace.Cycles(), (unsigned long long)COUNTDOWN_CYCLES );
+    TraceRecord Records[8];
+    ASSERT_EQ( Trace.Latest( Records, 8 ), 8u );
+    const Word PCs[8] = { 0x1000, 0x1002, 0x1003, 0x1002, 0x1003, 0x1002, 0x1003, 0x1005 };
+    for ( u32 i = 0; i < 8; i++ )
+    {
+        EXPECT_EQ( Records[i].PC, PCs[i] );
+        EXPECT_EQ( Records[i].Opcode, mem[PCs[i]] );
+    }
+    EXPECT_EQ( Records[0].Cycle, 0u );
+    EXPECT_EQ( Records[0].X, 0x00 );
+    EXPECT_EQ( Records[1].Cycle, 2u );
+    EXPECT_EQ( Records[1].X, 0x03 );
+    EXPECT_EQ( Records[7].Cycle, (unsigned long long)COUNTDOWN_CYCLES - 2 );
+    EXPECT_EQ( Records[7].X, 0x00 );
+    EXPECT_TRUE( Records[7].PS & CPU::ZeroFlagBit );
+    EXPECT_EQ( Records[7].SP, cpu.SP );
+}
+
+TEST_F( M6502TraceTests, AnotherThreadCanDrainTheRingWhileTheCPURuns )
+{
+    // Given:
+    // loop: inx ; jmp loop
+    cpu.Reset( 0x1000, mem );
+    mem[0x1000] = CPU::INS_INX;
+    mem[0x1001] = CPU::INS_JMP_ABS;
+    mem[0x1002] = 0x00;
+    mem[0x1003] = 0x10;
+    constexpr s32 NUM_LOOPS = 100000;
+    std::atomic<bool> Running{ true };
+    std::vector<TraceRecord> Drained;
+
+    // When:
+    std::thread Consumer( [&] {
+        TraceRecord Records[8];
+        bool Last = false;
+        while ( !Last )
+        {
+            Last = !Running.load();
+            for ( u32 Count; (Count = Trace.Drain( Records, 8 )) != 0; )
+            {
+                Drained.insert( Drained.end(), Records, Records + Count );
+            }
+            std::this_thread::yield();
+        }
+    } );
+    cpu.Interpret( NUM_LOOPS * (2 + 3), mem );
+    Running = false;
+    Consumer.join();
+
+    // Then:
+    EXPECT_EQ( Drained.size() + Trace.Lost(), 2u * NUM_LOOPS );
+    for ( size_t i = 0; i < Drained.size(); i++ )
+    {
+        const TraceRecord& Record = Drained[i];
+        const bool IsInx = Record.Cycle % 5 == 0;
+        EXPECT_EQ( Record.PC, IsInx ? 0x1000 : 0x1001 );
+        EXPECT_EQ( Record.Opcode, IsInx ? CPU::INS_INX : CPU::INS_JMP_ABS );
+        EXPECT_EQ( Record.X, (Byte)(Record.Cycle / 5 + (IsInx ? 0 : 1)) );
+        if ( i > 0 )
+        {
+            EXPECT_GT( Record.Cycle, Drained[i - 1].Cycle );
+        }
+    }
+    ASSERT_FALSE( Drained.empty() );
+    EXPECT_EQ( Drained.back().Cycle, NUM_LOOPS * 5ull - 3 );
+}
+
+TEST_F( M6502TraceTests, AnIllegalOpcodeDumpsTheLastInstructions )
+{
+    // Given:
+    cpu.Reset( 0x1000, mem );
+    mem[0x1000] = CPU::INS_LDA_IM;
+    mem[0x1001] = 0x42;
+    mem[0x1002] = 0x02;     // Not an instruction
+    FILE* Dump = tmpfile();
+    ASSERT_NE( Dump, nullptr );
+    Trace.SetDumpFile( Dump, 4 );
+
+    // When:
+    EXPECT_THROW( cpu.Interpret( 10, mem ), IllegalOpcode );
+
+    // Then:
+    char Text[512] = {};
+    rewind( Dump );
+    fread( Text, 1, sizeof(Text) - 1, Dump );
+    fclose( Dump );
+    EXPECT_NE( strstr( Text, "exception" ), nullptr );
+    EXPECT_NE( strstr( Text, "1000  A9  00" ), nullptr );
+    EXPECT_NE( strstr( Text, "1002  02  42" ), nullptr );
+}
+#endif